@@ -0,0 +1,77 @@
+#include "BenchmarkUtils.h"
+
+#include "enfield/Transform/Driver.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace efd;
+
+/// \brief Returns the number of gates of the largest program \p allocator
+/// runs on \p arch (0 skips the pair).
+///
+/// The exact and tree-search allocators are exponential on the number of
+/// qubits. These limits were found empirically: past them, a single iteration
+/// takes more than ~10s on the generated programs.
+static uint32_t GetMaxGates(const std::string& allocator, const std::string& arch) {
+    bool isSmall = arch == "qx2";
+    bool isMedium = arch == "qx3" || arch == "tokyo";
+
+    if (isSmall || allocator == "Q_grdy" || allocator == "Q_sabre") return 1024;
+
+    if (allocator == "Q_ibm") return arch == "qx3" ? 1024 : 256;
+    if (allocator == "Q_chw") return isMedium ? 1024 : (arch == "36-grid" ? 64 : 0);
+    if (allocator == "Q_jku") return isMedium ? 64 : 0;
+    if (allocator == "Q_ibmt") return arch == "qx3" ? 1024 : 0;
+    if (allocator == "Q_dynprog" || allocator == "Q_layered_bmt") return 0;
+
+    // Remaining BMT variants and the portfolio (which races them).
+    return arch == "qx3" ? 64 : 0;
+}
+
+static void BM_Allocate(benchmark::State& state, EnumAllocator allocator, std::string archName) {
+    auto arch = bench::LoadArch(archName);
+    auto program = bench::GenerateProgram(arch->size(), state.range(0));
+
+    CompilationSettings settings {
+        arch, allocator, {{"U", 1}, {"CX", 10}}, false, false, false
+    };
+    settings.allocatorOptions.seed = 42;
+
+    uint32_t swaps = 0;
+    uint64_t peakHeap = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto qmod = QModule::ParseString(program);
+        bench::HeapTracker::Reset();
+        state.ResumeTiming();
+
+        auto compiled = Compile(std::move(qmod), settings);
+
+        state.PauseTiming();
+        peakHeap = std::max(peakHeap, bench::HeapTracker::GetPeak());
+        swaps = bench::CountSwaps(compiled.get());
+        compiled.reset();
+        state.ResumeTiming();
+    }
+
+    state.counters["Swaps"] = swaps;
+    state.counters["PeakHeapKB"] = peakHeap / 1024.0;
+}
+
+void RegisterAllocatorBenchmarks() {
+    for (auto allocator : EnumAllocator::List()) {
+        if (!HasAllocator(allocator)) continue;
+
+        for (auto& arch : bench::GetArchNames()) {
+            uint32_t maxGates = GetMaxGates(allocator.getStringValue(), arch);
+            if (maxGates == 0) continue;
+
+            auto name = "Allocate/" + allocator.getStringValue() + "/" + arch;
+            auto bm = benchmark::RegisterBenchmark(name.c_str(), BM_Allocate, allocator, arch)
+                ->Unit(benchmark::kMillisecond);
+
+            for (uint32_t gates = 64; gates <= maxGates; gates *= 4) bm->Arg(gates);
+        }
+    }
+}
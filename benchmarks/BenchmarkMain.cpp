@@ -0,0 +1,24 @@
+#include "enfield/Transform/Driver.h"
+
+#include <benchmark/benchmark.h>
+
+void RegisterAllocatorBenchmarks();
+void RegisterFrontendBenchmarks();
+void RegisterSupportBenchmarks();
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    // The allocators log their progress. We don't want that in the results.
+    const char* efdArgv[] = { "EfdBenchmarks", "-inf", "/dev/null", "-war", "/dev/null" };
+    efd::Init(5, const_cast<char**>(efdArgv));
+
+    RegisterFrontendBenchmarks();
+    RegisterSupportBenchmarks();
+    RegisterAllocatorBenchmarks();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
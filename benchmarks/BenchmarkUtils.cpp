@@ -0,0 +1,117 @@
+#include "BenchmarkUtils.h"
+
+#include "enfield/Transform/Utils.h"
+#include "enfield/Support/JsonParser.h"
+#include "enfield/Support/RTTI.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+
+#include <malloc.h>
+
+using namespace efd;
+
+static std::atomic<uint64_t> HeapInUse(0);
+static std::atomic<uint64_t> HeapPeak(0);
+static std::atomic<uint64_t> HeapBase(0);
+
+static void* TrackedAlloc(std::size_t size) {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+
+    uint64_t inUse = HeapInUse += malloc_usable_size(ptr);
+    uint64_t peak = HeapPeak.load();
+    while (inUse > peak && !HeapPeak.compare_exchange_weak(peak, inUse));
+
+    return ptr;
+}
+
+static void TrackedFree(void* ptr) {
+    if (ptr == nullptr) return;
+    HeapInUse -= malloc_usable_size(ptr);
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size) { return TrackedAlloc(size); }
+void* operator new[](std::size_t size) { return TrackedAlloc(size); }
+void operator delete(void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr); }
+
+void bench::HeapTracker::Reset() {
+    HeapBase = HeapInUse.load();
+    HeapPeak = HeapBase.load();
+}
+
+uint64_t bench::HeapTracker::GetPeak() {
+    uint64_t peak = HeapPeak.load(), base = HeapBase.load();
+    return (peak > base) ? peak - base : 0;
+}
+
+const std::vector<std::string>& bench::GetArchNames() {
+    static const std::vector<std::string> Names {
+        "qx2", "qx3", "tokyo", "36-grid", "36-ring", "36-tree"
+    };
+
+    return Names;
+}
+
+ArchGraph::sRef bench::LoadArch(const std::string& name) {
+    static std::mutex Mutex;
+    static std::map<std::string, ArchGraph::sRef> Archs;
+
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    auto it = Archs.find(name);
+    if (it != Archs.end()) return it->second;
+
+    ArchGraph::sRef arch = JsonParser<ArchGraph>::ParseFile(EFD_ARCHFILES_DIR + name + ".json");
+    Archs[name] = arch;
+    return arch;
+}
+
+std::string bench::GenerateProgram(uint32_t qubits, uint32_t gates, uint32_t seed) {
+    static const char* SingleQubitGates[] = { "h", "t", "tdg", "s", "x", "u1(0.5)" };
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> qubitDist(0, qubits - 1);
+    std::uniform_int_distribution<uint32_t> gateDist(0, 5);
+
+    std::ostringstream out;
+    out << "OPENQASM 2.0;" << std::endl
+        << "include \"qelib1.inc\";" << std::endl
+        << "qreg q[" << qubits << "];" << std::endl;
+
+    for (uint32_t i = 0; i < gates; ++i) {
+        uint32_t a = qubitDist(rng);
+
+        if (i % 2 == 0 && qubits > 1) {
+            uint32_t b = qubitDist(rng);
+            while (b == a) b = qubitDist(rng);
+            out << "cx q[" << a << "], q[" << b << "];" << std::endl;
+        } else {
+            out << SingleQubitGates[gateDist(rng)] << " q[" << a << "];" << std::endl;
+        }
+    }
+
+    return out.str();
+}
+
+uint32_t bench::CountSwaps(QModule::Ref qmod) {
+    uint32_t swaps = 0;
+
+    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
+        auto qop = GetStatementPair(it->get()).second;
+
+        if (qop != nullptr && IsIntrinsicGateCall(qop) &&
+            GetIntrinsicKind(qop) == NDQOpGen::K_INTRINSIC_SWAP) {
+            ++swaps;
+        }
+    }
+
+    return swaps;
+}
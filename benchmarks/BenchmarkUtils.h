@@ -0,0 +1,46 @@
+#ifndef __EFD_BENCHMARK_UTILS_H__
+#define __EFD_BENCHMARK_UTILS_H__
+
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Transform/QModule.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace efd {
+namespace bench {
+    /// \brief Names of the architecture files (inside archfiles/) used by
+    /// the benchmarks.
+    const std::vector<std::string>& GetArchNames();
+
+    /// \brief Loads the architecture file \p name (without the extension),
+    /// parsing it only once.
+    ArchGraph::sRef LoadArch(const std::string& name);
+
+    /// \brief Generates a random QASM program with \p gates gates over
+    /// \p qubits qubits.
+    ///
+    /// Half of the gates are CNOTs, and the others are single-qubit gates
+    /// from the standard library. The same \p seed always generates the same
+    /// program.
+    std::string GenerateProgram(uint32_t qubits, uint32_t gates, uint32_t seed = 42);
+
+    /// \brief Returns the number of swaps inserted in \p qmod.
+    uint32_t CountSwaps(QModule::Ref qmod);
+
+    /// \brief Tracks the bytes allocated with `new` by the benchmark binary.
+    class HeapTracker {
+        public:
+            HeapTracker() = delete;
+
+            /// \brief Starts a new measurement, from the bytes currently in use.
+            static void Reset();
+            /// \brief Returns the peak of bytes in use since \em Reset, minus
+            /// the bytes in use when it was called.
+            static uint64_t GetPeak();
+    };
+}
+}
+
+#endif
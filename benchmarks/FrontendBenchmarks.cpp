@@ -0,0 +1,33 @@
+#include "BenchmarkUtils.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace efd;
+
+static void BM_Parse(benchmark::State& state) {
+    auto program = bench::GenerateProgram(16, state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(QModule::ParseString(program));
+    }
+
+    state.SetBytesProcessed(state.iterations() * program.size());
+}
+
+static void BM_Print(benchmark::State& state) {
+    auto program = bench::GenerateProgram(16, state.range(0));
+    auto qmod = QModule::ParseString(program);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(qmod->toString());
+    }
+
+    state.SetBytesProcessed(state.iterations() * program.size());
+}
+
+void RegisterFrontendBenchmarks() {
+    benchmark::RegisterBenchmark("Parse", BM_Parse)
+        ->RangeMultiplier(4)->Range(256, 16384);
+    benchmark::RegisterBenchmark("Print", BM_Print)
+        ->RangeMultiplier(4)->Range(256, 16384);
+}
@@ -0,0 +1,101 @@
+#include "BenchmarkUtils.h"
+
+#include "enfield/Support/ApproxTSFinder.h"
+#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Support/SimplifiedApproxTSFinder.h"
+#include "enfield/Support/WeightedGraph.h"
+#include "enfield/Support/WeightedSIFinder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace efd;
+
+/// \brief Returns \p n random permutations of the \p size physical qubits.
+static std::vector<InverseMap> GeneratePermutations(uint32_t size, uint32_t n) {
+    std::mt19937 rng(42);
+    std::vector<InverseMap> permutations(n, InverseMap(size));
+
+    for (auto& permutation : permutations) {
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), rng);
+    }
+
+    return permutations;
+}
+
+static void BM_BFSCachedDistance(benchmark::State& state, std::string archName) {
+    auto arch = bench::LoadArch(archName);
+    uint32_t size = arch->size();
+
+    for (auto _ : state) {
+        auto distance = BFSCachedDistance::Create();
+        distance->init(arch.get());
+
+        for (uint32_t u = 0; u < size; ++u) {
+            for (uint32_t v = 0; v < size; ++v) {
+                benchmark::DoNotOptimize(distance->get(u, v));
+            }
+        }
+    }
+}
+
+template <typename FinderT>
+static void BM_TokenSwap(benchmark::State& state, std::string archName) {
+    auto arch = bench::LoadArch(archName);
+    auto permutations = GeneratePermutations(arch->size(), 16);
+
+    InverseMap identity(arch->size());
+    std::iota(identity.begin(), identity.end(), 0);
+
+    auto finder = FinderT::Create();
+    finder->setGraph(arch.get());
+
+    uint64_t swaps = 0;
+    uint32_t i = 0;
+
+    for (auto _ : state) {
+        auto& permutation = permutations[i++ % permutations.size()];
+        swaps += finder->find(identity, permutation).size();
+    }
+
+    state.counters["Swaps"] = benchmark::Counter(swaps, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_WeightedSIFinder(benchmark::State& state, std::string archName) {
+    auto arch = bench::LoadArch(archName);
+    uint32_t size = arch->size();
+
+    // Random interaction graph with two edges per qubit, weighted by the
+    // number of gates between them.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> qubitDist(0, size - 1);
+    std::uniform_int_distribution<uint32_t> weightDist(1, 16);
+
+    auto weighted = WeightedGraph<uint32_t>::Create(size, Graph::Directed);
+    for (uint32_t i = 0; i < 2 * size; ++i) {
+        uint32_t u = qubitDist(rng), v = qubitDist(rng);
+        if (u != v && !weighted->hasEdge(u, v)) weighted->putEdge(u, v, weightDist(rng));
+    }
+
+    for (auto _ : state) {
+        auto finder = WeightedSIFinder<uint32_t>::Create();
+        benchmark::DoNotOptimize(finder->find(arch.get(), weighted.get()));
+    }
+}
+
+void RegisterSupportBenchmarks() {
+    for (auto& arch : bench::GetArchNames()) {
+        benchmark::RegisterBenchmark(("BFSCachedDistance/" + arch).c_str(),
+                                     BM_BFSCachedDistance, arch);
+        benchmark::RegisterBenchmark(("ApproxTSFinder/" + arch).c_str(),
+                                     BM_TokenSwap<ApproxTSFinder>, arch);
+        benchmark::RegisterBenchmark(("SimplifiedApproxTSFinder/" + arch).c_str(),
+                                     BM_TokenSwap<SimplifiedApproxTSFinder>, arch);
+        benchmark::RegisterBenchmark(("WeightedSIFinder/" + arch).c_str(),
+                                     BM_WeightedSIFinder, arch);
+    }
+}
@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace efd {
     struct ASTWrapper {
@@ -22,6 +23,15 @@ namespace efd {
     Node::uRef ParseFile(std::string filename, std::string path = "./", bool forceStdLib = true);
     /// \brief Parse the string \p program.
     Node::uRef ParseString(std::string program, bool forceStdLib = true);
+    /// \brief Returns the AST of the standard library file \p filename (e.g.:
+    /// `qelib1.inc`), or nullptr if there is no such file.
+    ///
+    /// Each file is parsed only once per process, and its AST is shared by
+    /// every caller. So, it must not be modified.
+    Node::Ref GetStdLibAST(const std::string& filename);
+    /// \brief Returns the names of the standard library files, which are
+    /// included in every program parsed with \p forceStdLib.
+    std::vector<std::string> GetStdLibFilenames();
 };
 
 #endif
@@ -99,6 +99,14 @@ namespace efd {
         public:
             virtual ~Node();
 
+            /// \brief Allocates the node from the \em PoolAllocator.
+            ///
+            /// ASTs are made of lots of small nodes, cloned and thrown away all
+            /// the time by the passes.
+            static void* operator new(std::size_t size);
+            /// \brief Gives the node's memory back to the \em PoolAllocator.
+            static void operator delete(void* ptr, std::size_t size);
+
             /// \brief Gets the i-th child.
             Ref getChild(uint32_t i) const;
             /// \brief Sets the i-th child.
@@ -178,6 +186,8 @@ namespace efd {
 
                 /// \brief Returns a copy to the setted value.
                 T getVal() const;
+                /// \brief Returns a reference to the setted value.
+                const T& getValRef() const;
 
                 std::string getOperation() const override;
                 std::string toString(bool pretty = false) const override;
@@ -500,6 +510,7 @@ namespace efd {
         public:
             typedef NDGateSign* Ref;
             typedef std::unique_ptr<NDGateSign> uRef;
+            typedef std::shared_ptr<NDGateSign> sRef;
 
         protected:
             enum ChildType {
@@ -1024,6 +1035,11 @@ T efd::NDValue<T>::getVal() const {
     return mVal;
 }
 
+template <typename T>
+const T& efd::NDValue<T>::getValRef() const {
+    return mVal;
+}
+
 template <typename T>
 std::string efd::NDValue<T>::getOperation() const {
     return std::to_string(mVal);
@@ -0,0 +1,70 @@
+#ifndef __EFD_QASM_EMITTER_H__
+#define __EFD_QASM_EMITTER_H__
+
+#include "enfield/Analysis/NodeVisitor.h"
+
+#include <ostream>
+
+namespace efd {
+    /// \brief Writes the QASM representation of the nodes it visits directly
+    /// into a \em std::ostream.
+    ///
+    /// Produces exactly the same text as \em Node::toString, but without
+    /// building intermediate strings for each node. The output is kept in a
+    /// fixed-size buffer, which is flushed to the stream whenever it gets full,
+    /// when \em flush is called, or on destruction.
+    class QASMEmitter : public NodeVisitor {
+        public:
+            typedef QASMEmitter* Ref;
+            typedef std::unique_ptr<QASMEmitter> uRef;
+
+            /// \brief Size of the buffer, before it is flushed.
+            static const uint32_t BufferSize = 1 << 16;
+
+        private:
+            std::ostream& mOut;
+            bool mPretty;
+            std::string mBuffer;
+
+            void write(const std::string& str);
+            void write(const char* str);
+            void write(char c);
+            void endl();
+
+            void emitQOp(NDQOp::Ref ref);
+            void emitGateSign(NDGateSign::Ref ref);
+
+        public:
+            QASMEmitter(std::ostream& out, bool pretty = false);
+            ~QASMEmitter();
+
+            /// \brief Writes \p ref to the buffer.
+            void emit(Node::Ref ref);
+            /// \brief Writes everything in the buffer to the stream.
+            void flush();
+
+            void visit(NDQasmVersion::Ref ref) override;
+            void visit(NDInclude::Ref ref) override;
+            void visit(NDRegDecl::Ref ref) override;
+            void visit(NDGateDecl::Ref ref) override;
+            void visit(NDOpaque::Ref ref) override;
+            void visit(NDQOpMeasure::Ref ref) override;
+            void visit(NDQOpReset::Ref ref) override;
+            void visit(NDQOpU::Ref ref) override;
+            void visit(NDQOpCX::Ref ref) override;
+            void visit(NDQOpBarrier::Ref ref) override;
+            void visit(NDQOpGen::Ref ref) override;
+            void visit(NDBinOp::Ref ref) override;
+            void visit(NDUnaryOp::Ref ref) override;
+            void visit(NDIdRef::Ref ref) override;
+            void visit(NDList::Ref ref) override;
+            void visit(NDStmtList::Ref ref) override;
+            void visit(NDGOpList::Ref ref) override;
+            void visit(NDIfStmt::Ref ref) override;
+            void visit(NDValue<std::string>::Ref ref) override;
+            void visit(NDValue<IntVal>::Ref ref) override;
+            void visit(NDValue<RealVal>::Ref ref) override;
+    };
+}
+
+#endif
@@ -5,28 +5,36 @@
 
 namespace efd {
     /// \brief Calculates the distance by applying BFS.
+    ///
+    /// The distances between every pair of vertices are computed once per
+    /// graph, and shared by every \em BFSCachedDistance of a graph with the
+    /// same edges (e.g.: the allocators of a batch of compilations).
     class BFSCachedDistance : public DistanceGetter<uint32_t> {
         public:
             typedef BFSCachedDistance* Ref;
             typedef std::shared_ptr<BFSCachedDistance> sRef;
             typedef std::unique_ptr<BFSCachedDistance> uRef;
 
-        private:
             typedef std::vector<uint32_t> VecUInt32;
             typedef std::vector<VecUInt32> MatrixUInt32;
-
-            void cacheDistanceFrom(uint32_t u);
+            typedef std::shared_ptr<const MatrixUInt32> MatrixRef;
 
         protected:
             void initImpl() override;
             uint32_t getImpl(uint32_t u, uint32_t v) override;
 
         private:
-            MatrixUInt32 mDistance;
+            MatrixRef mDistance;
 
         public:
             BFSCachedDistance();
 
+            /// \brief Returns the distances between every pair of vertices
+            /// of \p g.
+            ///
+            /// They are cached, and \p g must not change while they are used.
+            static MatrixRef GetDistanceMatrix(Graph::Ref g);
+
             /// \brief Instantiate one object of this type.
             static uRef Create();
     };
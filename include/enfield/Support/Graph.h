@@ -31,6 +31,8 @@ namespace efd {
 
             std::vector<std::set<uint32_t>> mSuccessors;
             std::vector<std::set<uint32_t>> mPredecessors;
+            // Row-major adjacency matrix: (i, j) is at (i * mN + j).
+            std::vector<bool> mAdjacency;
 
             Graph(Kind k, uint32_t n, Type ty = Undirected);
 
@@ -49,6 +51,9 @@ namespace efd {
             uint32_t size() const;
     
             /// \brief Return the set of succesors of some vertex \p i.
+            ///
+            /// Removing edges through this set is not seen by \em hasEdge. Use
+            /// \em clearEdges instead.
             std::set<uint32_t>& succ(uint32_t i);
             /// \brief Return the set of predecessors of some vertex \p i.
             std::set<uint32_t>& pred(uint32_t i); 
@@ -58,8 +63,15 @@ namespace efd {
             /// \brief Inserts an edge (i, j) in the successor's list and
             /// an edge (j, i) in the predecessor's list.
             void putEdge(uint32_t i, uint32_t j);
+            /// \brief Clears the successors and the predecessors of \p i.
+            ///
+            /// Only the sets of \p i are cleared, i.e. \p i is still in the
+            /// sets of its (former) neighbours.
+            void clearEdges(uint32_t i);
             /// \brief Returns true whether it has an edge (i, j).
-            bool hasEdge(uint32_t i, uint32_t j); 
+            ///
+            /// Constant time: it is looked up in an adjacency matrix.
+            bool hasEdge(uint32_t i, uint32_t j) const;
 
             /// \brief Returns true if this is a weighted graph.
             bool isWeighted() const;
@@ -0,0 +1,45 @@
+#ifndef __EFD_MAPPED_FILE_H__
+#define __EFD_MAPPED_FILE_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace efd {
+    /// \brief Read-only view of the whole contents of a file, mapped into memory.
+    ///
+    /// The contents are not NUL-terminated. They are valid while this object
+    /// is alive.
+    class MappedFile {
+        public:
+            typedef MappedFile* Ref;
+            typedef std::unique_ptr<MappedFile> uRef;
+
+        private:
+            const char* mData;
+            uint64_t mSize;
+
+            MappedFile(const char* data, uint64_t size);
+
+        public:
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /// \brief Pointer to the first byte of the file.
+            const char* begin() const;
+            /// \brief Pointer past the last byte of the file.
+            const char* end() const;
+            /// \brief Size of the file, in bytes.
+            uint64_t size() const;
+
+            /// \brief Maps the file at \p path.
+            ///
+            /// Returns nullptr if the file could not be opened (\em errno tells
+            /// the reason).
+            static uRef Open(const std::string& path);
+    };
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __EFD_POOL_ALLOCATOR_H__
+#define __EFD_POOL_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace efd {
+    /// \brief Size-segregated pool for small, short-lived objects.
+    ///
+    /// Objects are carved out of large slabs, grouped by size classes of
+    /// \em Granularity bytes. Freed objects go to a thread-local free list of
+    /// their size class, and are reused by the next allocation of that size.
+    /// Hence, allocating or freeing an object is a couple of pointer moves,
+    /// instead of a round trip through the system allocator.
+    ///
+    /// Slabs are never given back to the system. Instead, when a thread exits,
+    /// its free lists (and the unused tail of its slab) are handed to global
+    /// free lists, from which the other threads refill theirs. So, memory is
+    /// not lost with short-lived threads (e.g.: thread pool workers).
+    class PoolAllocator {
+        public:
+            /// \brief Size (in bytes) of each size class step.
+            static const std::size_t Granularity = 16;
+            /// \brief Biggest object size served by the pools. Bigger objects
+            /// are forwarded to the system allocator.
+            static const std::size_t MaxObjectSize = 256;
+            /// \brief Size (in bytes) of each slab requested to the system.
+            static const std::size_t SlabSize = 64 * 1024;
+
+            PoolAllocator() = delete;
+
+            /// \brief Allocates \p size bytes.
+            static void* Allocate(std::size_t size);
+            /// \brief Frees \p ptr, allocated with \p size bytes.
+            static void Deallocate(void* ptr, std::size_t size);
+
+            /// \brief Returns the total number of bytes requested for slabs.
+            static uint64_t GetReservedBytes();
+    };
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef __EFD_SLICE_H__
+#define __EFD_SLICE_H__
+
+#include <cstdint>
+
+namespace efd {
+    /// \brief Read-only view of a contiguous part of an array.
+    ///
+    /// It does not own the elements. So, it is only valid while the
+    /// array it was taken from is not modified.
+    template <typename T>
+    class Slice {
+        private:
+            const T* mBegin;
+            const T* mEnd;
+
+        public:
+            Slice(const T* begin, const T* end) : mBegin(begin), mEnd(end) {}
+
+            const T* begin() const { return mBegin; }
+            const T* end() const { return mEnd; }
+            uint32_t size() const { return mEnd - mBegin; }
+            bool empty() const { return mBegin == mEnd; }
+            const T& operator[](uint32_t i) const { return mBegin[i]; }
+    };
+}
+
+#endif
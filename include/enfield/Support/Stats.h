@@ -1,28 +1,57 @@
 #ifndef __EFD_STATS_H__
 #define __EFD_STATS_H__
 
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace efd {
     class StatsPool;
+    class StatScope;
+    struct StatRecord;
 
     /// \brief Base class for stats.
+    ///
+    /// The value of a stat lives either in the \em StatScope bound to the
+    /// current thread, or (if there is none) in the stat itself. Every
+    /// value is kept as an atomic double, so that stats may be bumped from
+    /// several threads at the same time.
     class StatBase {
+        friend class StatScope;
+        friend void RestoreStats(const std::vector<StatRecord>& records);
+
         private:
             std::shared_ptr<StatsPool> mPool;
+            uint32_t mId;
+            mutable std::atomic<double> mGlobal;
 
         protected:
             std::string mName;
             std::string mDescription;
 
+            /// \brief Returns the slot that holds the value for the current thread.
+            std::atomic<double>& getSlot() const;
+
+            /// \brief Atomically replaces the value \em v by \p f(v).
+            template <typename F>
+            void update(F f) {
+                auto& slot = getSlot();
+                double old = slot.load();
+                while (!slot.compare_exchange_weak(old, f(old)));
+            }
+
         public:
             StatBase(std::string name, std::string description);
+            virtual ~StatBase() = default;
 
             /// \brief Gets the name of the stat.
             std::string getName() const;
             /// \brief Gets the description of the stat.
             std::string getDescription() const;
+            /// \brief Gets the index of this stat in the pool.
+            uint32_t getId() const;
 
             virtual bool isZero() const = 0;
 
@@ -31,17 +60,16 @@ namespace efd {
             /// \brief Returns a string with the contents of the stat.
             /// e.g.: 35::CNOTNum::Number of CNOT nodes.
             virtual std::string toString() const = 0;
+            /// \brief Returns a string with the value of the stat only.
+            virtual std::string valueToString() const = 0;
     };
 
     /// \brief Stats of a given type.
-    /// 
+    ///
     /// This should be used for collecting statistical results like elapsed time
     /// of some function, or uses of something else.
     template <typename T>
         class Stat : public StatBase {
-            private:
-                T mVal;
-
             public:
                 Stat(std::string name, std::string description);
 
@@ -56,56 +84,127 @@ namespace efd {
 
                 bool isZero() const override;
                 std::string toString() const override;
+                std::string valueToString() const override;
         };
 
+    /// \brief Separate set of values for every stat.
+    ///
+    /// While it is bound to a thread (see \em Binding), the stats changed
+    /// by that thread use the values of this scope, instead of the global
+    /// ones. So, compilations running concurrently in different threads
+    /// do not clobber each other's stats. A scope may be bound to more than
+    /// one thread (e.g.: the workers of a single compilation).
+    class StatScope {
+        private:
+            std::vector<std::atomic<double>> mValues;
+
+        public:
+            typedef StatScope* Ref;
+
+            /// \brief Binds a \em StatScope to the current thread while alive,
+            /// restoring the previous one when destroyed.
+            class Binding {
+                private:
+                    StatScope::Ref mPrevious;
+
+                public:
+                    Binding(StatScope::Ref scope);
+                    ~Binding();
+
+                    Binding(const Binding&) = delete;
+                    Binding& operator=(const Binding&) = delete;
+            };
+
+            StatScope();
+
+            /// \brief Returns true if this scope has a slot for the stat \p id
+            /// (i.e.: it was registered before the scope was created).
+            bool hasSlot(uint32_t id) const;
+            /// \brief Returns the slot of the stat \p id.
+            std::atomic<double>& getSlot(uint32_t id);
+
+            /// \brief Adds the values of this scope to the ones seen by the
+            /// current thread (i.e.: those of the scope bound to it, or the
+            /// global ones).
+            void mergeIntoCurrent();
+
+            /// \brief Returns the scope bound to the current thread (or
+            /// nullptr if the global values are being used).
+            static StatScope::Ref Current();
+    };
+
+    /// \brief The value of a stat, at the moment it was collected.
+    struct StatRecord {
+        std::string mName;
+        std::string mDescription;
+        std::string mValue;
+    };
+
+    typedef std::vector<StatRecord> StatRecords;
+
+    /// \brief Collects the stats values seen by the current thread, sorted by
+    /// name. Stats whose value is zero are skipped, unless \p withZero is set.
+    StatRecords CollectStats(bool withZero = false);
+    /// \brief Adds the values of \p records to the stats of the same name seen
+    /// by the current thread (e.g.: for replaying the stats of a compilation
+    /// taken from a cache). Unknown names are ignored.
+    void RestoreStats(const StatRecords& records);
+
     /// \brief Usually called in the end of the program, i.e. when all statistical
     /// data have already been collected.
     void PrintStats(std::ostream& out = std::cout);
+    /// \brief Prints \p records as a JSON object (from name to value).
+    void PrintStatsJson(const StatRecords& records, std::ostream& out);
+    /// \brief Prints \p records as CSV rows `label,name,value`.
+    ///
+    /// The header is printed only if \p header is set.
+    void PrintStatsCsv(const StatRecords& records, std::ostream& out,
+                       const std::string& label = "", bool header = true);
 }
 
 template <typename T>
-efd::Stat<T>::Stat(std::string name, std::string description) : StatBase(name, description), mVal(0) {
+efd::Stat<T>::Stat(std::string name, std::string description) : StatBase(name, description) {
 }
 
 template <typename T>
 T efd::Stat<T>::getVal() const {
-    return mVal;
+    return (T) getSlot().load();
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator=(const T val) {
-    mVal = val;
+    getSlot().store((double) val);
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator+=(const T val) {
-    mVal += val;
+    update([val](double v) { return (double) ((T) v + val); });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator-=(const T val) {
-    mVal -= val;
+    update([val](double v) { return (double) ((T) v - val); });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator*=(const T val) {
-    mVal *= val;
+    update([val](double v) { return (double) ((T) v * val); });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator/=(const T val) {
-    mVal /= val;
+    update([val](double v) { return (double) ((T) v / val); });
     return *this;
 }
 
 template <typename T>
 bool efd::Stat<T>::isZero() const {
     double episilon = 0.00001;
-    double dVal = mVal;
+    double dVal = getVal();
     return dVal >= -episilon && dVal <= episilon;
 }
 
@@ -113,10 +212,15 @@ template <typename T>
 std::string efd::Stat<T>::toString() const {
     std::string s;
 
-    s += std::to_string(mVal) + "::";
+    s += valueToString() + "::";
     s += mName + "::";
     s += mDescription;
     return s;
 }
 
+template <typename T>
+std::string efd::Stat<T>::valueToString() const {
+    return std::to_string(getVal());
+}
+
 #endif
@@ -0,0 +1,38 @@
+#ifndef __EFD_SYMBOL_TABLE_H__
+#define __EFD_SYMBOL_TABLE_H__
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace efd {
+    /// \brief Interns strings, so that every distinct string is stored only once.
+    ///
+    /// Strings are looked up by a range of characters, so no temporary
+    /// \em std::string is created for the symbols already in the table.
+    class SymbolTable {
+        public:
+            /// \brief An interned string. Equal strings have equal symbols.
+            typedef const std::string* Symbol;
+
+        private:
+            std::deque<std::string> mStrings;
+            std::vector<Symbol> mSlots;
+
+            void grow();
+
+        public:
+            SymbolTable();
+
+            /// \brief Returns the symbol of the string in [\p begin, \p end).
+            Symbol intern(const char* begin, const char* end);
+            /// \brief Returns the symbol of \p str.
+            Symbol intern(const std::string& str);
+
+            /// \brief Number of distinct strings interned.
+            uint32_t size() const;
+    };
+}
+
+#endif
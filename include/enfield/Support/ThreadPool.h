@@ -0,0 +1,56 @@
+#ifndef __EFD_THREAD_POOL_H__
+#define __EFD_THREAD_POOL_H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace efd {
+    /// \brief Fixed set of worker threads that run the enqueued tasks in
+    /// first-in first-out order.
+    ///
+    /// The workers are joined when the pool is destroyed, after every
+    /// enqueued task has finished.
+    class ThreadPool {
+        public:
+            typedef ThreadPool* Ref;
+            typedef std::unique_ptr<ThreadPool> uRef;
+            typedef std::function<void()> Task;
+
+        private:
+            std::vector<std::thread> mWorkers;
+            std::queue<Task> mTasks;
+            uint32_t mRunning;
+            bool mStop;
+
+            std::mutex mMutex;
+            std::condition_variable mTaskCV;
+            std::condition_variable mIdleCV;
+
+            void work();
+
+        public:
+            /// \brief Starts \p threads workers. If \p threads is 0, uses the
+            /// number of hardware threads.
+            ThreadPool(uint32_t threads = 0);
+            ~ThreadPool();
+
+            /// \brief Returns the number of workers.
+            uint32_t size() const;
+
+            /// \brief Schedules \p task to be run by one of the workers.
+            void enqueue(Task task);
+            /// \brief Blocks until every enqueued task has finished.
+            void wait();
+
+            /// \brief Creates an instance of this class.
+            static uRef Create(uint32_t threads = 0);
+    };
+}
+
+#endif
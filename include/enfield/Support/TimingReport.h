@@ -0,0 +1,81 @@
+#ifndef __EFD_TIMING_REPORT_H__
+#define __EFD_TIMING_REPORT_H__
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace efd {
+    /// \brief Process-wide, hierarchical report of where the compilation
+    /// time (and memory) goes.
+    ///
+    /// Each named region (see \em TimingScope) becomes an entry, child of
+    /// the region that was open in the same thread when it started. Regions
+    /// with the same name and parent are merged, accumulating the number of
+    /// calls, the elapsed time and the growth of the peak resident set size.
+    ///
+    /// Nothing is recorded until \em Enable is called.
+    class TimingReport {
+        public:
+            /// \brief The data collected for one region.
+            struct Entry {
+                std::string mName;
+                uint32_t mParent;
+                uint32_t mCalls;
+                uint64_t mNanoseconds;
+                uint64_t mPeakRSSDelta;
+                std::vector<uint32_t> mChildren;
+            };
+
+            TimingReport() = delete;
+
+            /// \brief Starts recording the regions.
+            static void Enable(bool enabled = true);
+            /// \brief Returns true if the regions are being recorded.
+            static bool IsEnabled();
+            /// \brief Removes every entry recorded so far.
+            static void Clear();
+
+            /// \brief Opens the region \p name in the current thread, and
+            /// returns its entry id.
+            static uint32_t Enter(const std::string& name);
+            /// \brief Closes the region \p id (opened by this thread),
+            /// accumulating the measured values.
+            static void Exit(uint32_t id, uint64_t nanoseconds, uint64_t peakRSSDelta);
+
+            /// \brief Returns a copy of the entries, where the entry 0 is the
+            /// (unnamed) root.
+            static std::vector<Entry> GetEntries();
+
+            /// \brief Prints the report as an indented table.
+            static void Print(std::ostream& out = std::cerr);
+            /// \brief Prints the report as a JSON tree.
+            static void PrintJson(std::ostream& out);
+    };
+
+    /// \brief Records the lifetime of this object as the region \p name of
+    /// the \em TimingReport.
+    ///
+    /// It is a no-op when the report is not enabled.
+    class TimingScope {
+        private:
+            bool mActive;
+            uint32_t mId;
+            uint64_t mPeakRSS;
+            std::chrono::steady_clock::time_point mStart;
+
+        public:
+            TimingScope(const std::string& name);
+            ~TimingScope();
+
+            TimingScope(const TimingScope&) = delete;
+            TimingScope& operator=(const TimingScope&) = delete;
+    };
+
+    /// \brief Returns the peak resident set size of the process, in kilobytes.
+    uint64_t GetPeakRSS();
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef __EFD_TRACE_H__
+#define __EFD_TRACE_H__
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efd {
+    /// \brief Process-wide recorder of timed events, written in the Chrome
+    /// trace format (readable by chrome://tracing and Perfetto).
+    ///
+    /// The events should be recorded through the \em EFD_TRACE_* macros,
+    /// which are only compiled in when \em EFD_ENABLE_TRACE is defined (see
+    /// the \em ENABLE_TRACE CMake option). Even then, nothing is recorded
+    /// until \em Enable is called.
+    class Trace {
+        public:
+            typedef std::vector<std::pair<std::string, int64_t>> Args;
+
+            /// \brief One complete event (a span of time).
+            struct Event {
+                std::string mName;
+                const char* mCategory;
+                uint32_t mThread;
+                uint64_t mBegin;
+                uint64_t mDuration;
+                Args mArgs;
+            };
+
+            Trace() = delete;
+
+            /// \brief Starts recording the events.
+            static void Enable(bool enabled = true);
+            /// \brief Returns true if the events are being recorded.
+            static bool IsEnabled();
+            /// \brief Removes every recorded event.
+            static void Clear();
+
+            /// \brief Returns the microseconds elapsed since the process started
+            /// tracing (the time base of the events).
+            static uint64_t Now();
+            /// \brief Records the span [\p begin, \p end) of the current thread.
+            static void Record(const std::string& name, const char* category,
+                               uint64_t begin, uint64_t end, Args args);
+
+            /// \brief Returns a copy of the recorded events.
+            static std::vector<Event> GetEvents();
+            /// \brief Writes the events as a Chrome trace JSON object.
+            static void Write(std::ostream& out);
+    };
+
+    /// \brief Records the lifetime of this object as a \em Trace event.
+    ///
+    /// Numeric arguments may be attached to the event with \em arg. The
+    /// current event may also be closed, and a new one (with the same name)
+    /// started with \em restart.
+    class TraceScope {
+        private:
+            bool mActive;
+            std::string mName;
+            const char* mCategory;
+            uint64_t mBegin;
+            Trace::Args mArgs;
+
+            void record();
+
+        public:
+            TraceScope(const std::string& name, const char* category);
+            ~TraceScope();
+
+            TraceScope(const TraceScope&) = delete;
+            TraceScope& operator=(const TraceScope&) = delete;
+
+            /// \brief Attaches the argument \p key with value \p val to the event.
+            void arg(const std::string& key, int64_t val);
+            /// \brief Records the current event, and starts a new one.
+            void restart();
+    };
+}
+
+#ifdef EFD_ENABLE_TRACE
+#define EFD_TRACE_SCOPE(_Var_, _Name_, _Cat_) efd::TraceScope _Var_(_Name_, _Cat_)
+#define EFD_TRACE_ARG(_Var_, _Key_, _Val_) _Var_.arg(_Key_, _Val_)
+#define EFD_TRACE_RESTART(_Var_) _Var_.restart()
+#else
+#define EFD_TRACE_SCOPE(_Var_, _Name_, _Cat_)
+#define EFD_TRACE_ARG(_Var_, _Key_, _Val_)
+#define EFD_TRACE_RESTART(_Var_)
+#endif
+
+#endif
@@ -19,6 +19,8 @@ namespace efd {
         WrapperVal();
         /// \brief Parses the string to a double value.
         WrapperVal(std::string str);
+        /// \brief Uses \p val, already parsed from \p str.
+        WrapperVal(T val, std::string str);
 
         bool operator==(const WrapperVal<T>& rhs) const;
         bool operator!=(const WrapperVal<T>& rhs) const;
@@ -35,6 +37,9 @@ namespace efd {
 template <typename T>
 efd::WrapperVal<T>::WrapperVal() : mStr("") {}
 
+template <typename T>
+efd::WrapperVal<T>::WrapperVal(T val, std::string str) : mV(val), mStr(str) {}
+
 template <typename T>
 bool efd::WrapperVal<T>::operator==(const WrapperVal<T>& rhs) const{
     return mStr == rhs.mStr;
@@ -23,7 +23,7 @@ namespace efd {
             typedef std::set<uint32_t> AdjSet;
             typedef std::vector<AdjSet> AdjList;
             typedef std::unordered_map<Node::Ref, uint32_t> NodeUIntMap;
-            typedef std::unordered_map<Node::Ref, CircuitGraph::CircuitNode::Ref> NodeCNodeMap;
+            typedef std::unordered_map<Node::Ref, CircuitGraph::CircuitNode> NodeCNodeMap;
 
             CircuitGraph mCGraph;
             CircuitGraph::Iterator mIt;
@@ -32,7 +32,7 @@ namespace efd {
             uint32_t mXbitSize;
 
             void advanceXbitId(uint32_t i);
-            void advanceCNode(CircuitGraph::CircuitNode::Ref cnode);
+            void advanceCNode(CircuitGraph::CircuitNode cnode);
 
         protected:
             void initImpl() override;
@@ -162,8 +162,13 @@ namespace efd {
         typedef MapSeqSelector* Ref;
         typedef std::unique_ptr<MapSeqSelector> uRef;
         virtual ~MapSeqSelector() = default;
+        /// \brief Sets the max number of lines to be selected.
+        void setMaxSelected(uint32_t n) { mMaxSelected = n; }
         /// \brief Returns a vector with the line indexes chosen to be tracebacked.
         virtual bmt::Vector select(const bmt::TIMatrix& mem) = 0;
+
+        protected:
+            uint32_t mMaxSelected = 1;
     };
 
     /// \brief Subgraph Isomorphism based Qubit Allocator.
@@ -27,7 +27,7 @@ namespace efd {
             uint32_t mLQubits;
             std::vector<std::vector<uint32_t>> mDist;
 
-            AllocationResult tryAllocateLayer(Layer& layer, Mapping current,
+            AllocationResult tryAllocateLayer(Layer layer, Mapping current,
                                               std::set<uint32_t> qubitsSet,
                                               DependencyBuilder& depData);
 
@@ -0,0 +1,33 @@
+#ifndef __EFD_PORTFOLIO_QALLOCATOR_H__
+#define __EFD_PORTFOLIO_QALLOCATOR_H__
+
+#include "enfield/Transform/Allocators/QbitAllocator.h"
+
+namespace efd {
+    /// \brief Races a set of allocators, and keeps the cheapest result.
+    ///
+    /// Each allocator listed in \em AllocatorOptions::portfolio runs on its own
+    /// thread, over a private copy of the module. The results are scored by
+    /// their weighted cost (see \em QModuleQualityEvalPass).
+    ///
+    /// The remaining allocators are cancelled when a result costs at most
+    /// \em portfolioThreshold times a lower bound (the weighted cost of the
+    /// module without any swap), or when the deadline passes. Allocators that
+    /// do not check for cancellation run until the end.
+    class PortfolioQAllocator : public QbitAllocator {
+        public:
+            typedef PortfolioQAllocator* Ref;
+            typedef std::unique_ptr<PortfolioQAllocator> uRef;
+
+        protected:
+            PortfolioQAllocator(ArchGraph::sRef ag);
+
+            Mapping allocate(QModule::Ref qmod) override;
+
+        public:
+            /// \brief Creates an instance of this class.
+            static uRef Create(ArchGraph::sRef ag);
+    };
+}
+
+#endif
@@ -7,7 +7,42 @@
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Stats.h"
 
+#include <atomic>
+
 namespace efd {
+    /// \brief Parameters that tune the behavior of the allocators.
+    ///
+    /// Each allocator only reads the fields it uses.
+    struct AllocatorOptions {
+        /// \brief Seed used by the randomized algorithms.
+        uint32_t seed;
+        /// \brief Number of times that \em IBMQAllocator tries to allocate
+        /// a layer.
+        uint32_t trials;
+        /// \brief Max number of children per partial solution (BMT).
+        uint32_t bmtMaxChildren;
+        /// \brief Max number of partial solutions per step (BMT).
+        uint32_t bmtMaxPartial;
+        /// \brief Number of mapping sequences selected in phase 2 (BMT).
+        uint32_t bmtMaxMapSeq;
+        /// \brief Number of instructions SABRE peeks.
+        uint32_t sabreLookAhead;
+        /// \brief Number of times SABRE is run.
+        uint32_t sabreIterations;
+        /// \brief Names of the allocators raced by \em PortfolioQAllocator.
+        std::vector<std::string> portfolio;
+        /// \brief The portfolio stops as soon as a result costs at most
+        /// this many times the lower bound.
+        double portfolioThreshold;
+        /// \brief Milliseconds after which the portfolio stops (0 for
+        /// no deadline).
+        uint32_t portfolioDeadline;
+
+        /// \brief Initializes every field with its default value. The seed
+        /// is taken from the current time.
+        AllocatorOptions();
+    };
+
     /// \brief Base abstract class that allocates the qbits used in the program to
     /// the qbits that are in the physical architecture.
     class QbitAllocator : public PassT<Mapping> {
@@ -21,6 +56,7 @@ namespace efd {
         private:
             uint32_t mCXCost;
             uint32_t mHCost;
+            std::atomic<bool> mCancelled;
 
             /// \brief Calculates the cost of a \em CNOT and a \em H gate, based on the
             /// defined weights.
@@ -35,6 +71,7 @@ namespace efd {
         protected:
             ArchGraph::sRef mArchGraph;
             GateWeightMap mGateWeightMap;
+            AllocatorOptions mOptions;
 
             uint32_t mVQubits;
             uint32_t mPQubits;
@@ -44,6 +81,12 @@ namespace efd {
             /// \brief Executes the allocation algorithm after the preprocessing.
             virtual Mapping allocate(QModule::Ref qmod) = 0;
 
+            /// \brief Returns true if \em cancel was called.
+            ///
+            /// Allocators may check it in their main loops, and finish early
+            /// with the best (valid) solution found so far.
+            bool isCancelled() const;
+
             /// \brief Returns the cost of a \em CNOT gate, based on the defined weights.
             uint32_t getCXCost(uint32_t u, uint32_t v);
             /// \brief Returns the cost of a \em SWAP gate, based on the defined weights.
@@ -56,6 +99,13 @@ namespace efd {
 
             /// \brief Sets the weights to be used for each gate.
             void setGateWeightMap(const GateWeightMap& weightMap);
+            /// \brief Sets the parameters of the allocation algorithm.
+            void setOptions(const AllocatorOptions& options);
+
+            /// \brief Asks the allocator to finish as soon as possible.
+            ///
+            /// May be called from any thread.
+            void cancel();
     };
 
     /// \brief Generates an assignment mapping (maps the architecture's qubits
@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/CircuitGraph.h"
 #include "enfield/Support/BFSCachedDistance.h"
 
 #include <random>
@@ -23,10 +24,18 @@ namespace efd {
 
             uint32_t mLookAhead;
             uint32_t mIterations;
+            uint32_t mSwaps;
             BFSCachedDistance mBFSDistance;
             XbitToNumber mXbitToNumber;
 
+            /// \brief Runs SABRE over the gates of \p cGraph, from \p initialMapping.
+            ///
+            /// \p stmts is the order in which the gates were appended to \p cGraph.
+            /// The new statements are only inserted into \p qmod if \p issueInstructions
+            /// is true.
             MappingAndNSwaps allocateWithInitialMapping(const Mapping& initialMapping,
+                                                        CircuitGraph& cGraph,
+                                                        const std::vector<Node::Ref>& stmts,
                                                         QModule::Ref qmod,
                                                         bool issueInstructions);
 
@@ -35,6 +44,9 @@ namespace efd {
             Mapping allocate(QModule::Ref qmod) override;
 
         public:
+            /// \brief Number of swaps inserted by the last allocation.
+            uint32_t getNumberOfSwaps() const;
+
             static uRef Create(ArchGraph::sRef ag);
     };
 }
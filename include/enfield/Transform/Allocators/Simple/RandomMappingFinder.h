@@ -4,6 +4,8 @@
 #include "enfield/Transform/Allocators/SimpleQAllocator.h"
 #include "enfield/Support/WeightedGraph.h"
 
+#include <random>
+
 namespace efd {
     /// \brief Randomizes the mapping.
     class RandomMappingFinder : public MappingFinder {
@@ -11,10 +13,20 @@ namespace efd {
             typedef RandomMappingFinder* Ref;
             typedef std::unique_ptr<RandomMappingFinder> uRef;
 
+        private:
+            uint32_t mSeed;
+            std::default_random_engine mGenerator;
+
+        public:
+            RandomMappingFinder(uint32_t seed = AllocatorOptions().seed);
+
+            void setSeed(uint32_t seed) override;
+            /// \brief Returns the seed of this finder.
+            uint32_t getSeed() const;
             Mapping find(ArchGraph::Ref g, DepsVector& deps) override;
 
             /// \brief Creates an instance of this class.
-            static uRef Create();
+            static uRef Create(uint32_t seed = AllocatorOptions().seed);
     };
 }
 
@@ -15,6 +15,9 @@ namespace efd {
 
             virtual ~MappingFinder() = default;
 
+            /// \brief Sets the seed used by randomized finders.
+            virtual void setSeed(uint32_t seed) {}
+
             /// \brief Returns a mapping generated from a set of dependencies.
             virtual Mapping find(ArchGraph::Ref g, DepsVector& deps) = 0;
     };
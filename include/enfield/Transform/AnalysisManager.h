@@ -0,0 +1,102 @@
+#ifndef __EFD_ANALYSIS_MANAGER_H__
+#define __EFD_ANALYSIS_MANAGER_H__
+
+#include "enfield/Transform/Pass.h"
+#include "enfield/Support/Defs.h"
+
+#include <unordered_map>
+#include <mutex>
+
+namespace efd {
+    class QModule;
+
+    /// \brief Caches the analyses (passes that do not modify the module)
+    /// run on a single \em QModule.
+    ///
+    /// Every \em QModule owns one of these. So, modules that are compiled in
+    /// different threads never share any cached data. It is also safe to query
+    /// analyses of the same module from different threads, as long as none of
+    /// them is modifying it.
+    ///
+    /// When a pass modifies the module, only the analyses it declares as
+    /// preserved (see \em Pass::preserves) are kept.
+    class AnalysisManager {
+        public:
+            typedef AnalysisManager* Ref;
+            typedef std::unique_ptr<AnalysisManager> uRef;
+
+            typedef std::unordered_map<uint8_t*, Pass::sRef> PassMap;
+
+        private:
+            QModule* mQMod;
+            PassMap mPasses;
+            mutable std::mutex mMutex;
+
+            Pass::Ref find(uint8_t* id) const;
+            /// \brief Caches \p pass, unless another thread already did it.
+            Pass::Ref insert(uint8_t* id, Pass::sRef pass);
+            /// \brief Caches \p pass, replacing the one already cached (if any).
+            void replace(uint8_t* id, Pass::sRef pass);
+            /// \brief Runs \p pass on the module, recording it in the
+            /// \em TimingReport and the \em Trace.
+            bool runPass(Pass::Ref pass);
+
+        public:
+            AnalysisManager(QModule* qmod);
+
+            /// \brief Removes every cached analysis.
+            void clear();
+            /// \brief Removes the cached analyses not preserved by \p pass.
+            void invalidate(Pass::Ref pass);
+
+            /// \brief Returns true if the analysis \p T is cached.
+            template <typename T>
+            bool has() const {
+                return find(&T::ID) != nullptr;
+            }
+
+            /// \brief Runs the pass \p T, caching it if it did not modify
+            /// the module.
+            template <typename T>
+            void run() {
+                if (has<T>()) return;
+
+                Pass::sRef pass = T::Create();
+
+                // The pass is run unlocked, since it will probably
+                // query other analyses.
+                if (runPass(pass.get())) invalidate(pass.get());
+                else insert(&T::ID, pass);
+            }
+
+            /// \brief Runs the already created \p pass, invalidating the
+            /// analyses accordingly.
+            template <typename T>
+            void run(T* pass) {
+                if (runPass(pass)) invalidate(pass);
+            }
+
+            /// \brief Caches \p pass as the analysis \p T, as if it had been
+            /// run on the module.
+            ///
+            /// Used by passes that compute several analyses at once. If the
+            /// publishing pass modifies the module, it must also preserve \p T.
+            template <typename T>
+            void publish(std::shared_ptr<T> pass) {
+                replace(&T::ID, pass);
+            }
+
+            /// \brief Gets the analysis \p T, running it if it is not cached.
+            template <typename T>
+            T* get() {
+                if (auto pass = find(&T::ID)) return (T*) pass;
+
+                Pass::sRef pass = T::Create();
+                EfdAbortIf(runPass(pass.get()),
+                           "Analysis modified the module it was analysing.");
+                return (T*) insert(&T::ID, pass);
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __EFD_CIRCUIT_ANALYSIS_PASS_H__
+#define __EFD_CIRCUIT_ANALYSIS_PASS_H__
+
+#include "enfield/Transform/Pass.h"
+#include "enfield/Transform/QModule.h"
+
+namespace efd {
+    /// \brief Flattens the given QModule and computes, at once, the analyses
+    /// most passes start from.
+    ///
+    /// The statements are walked only once: each one is flattened (see
+    /// \em FlattenPass) and appended to the \em GateStream. The dependencies,
+    /// the \em CircuitGraph and the layers are then built from the stream.
+    /// All of them are cached as the results of \em XbitToNumberWrapperPass,
+    /// \em GateStreamBuilderPass, \em DependencyBuilderWrapperPass,
+    /// \em CircuitGraphBuilderPass and \em LayersBuilderPass, which are not
+    /// run separately while the module is not modified.
+    class CircuitAnalysisPass : public PassT<void> {
+        public:
+            typedef CircuitAnalysisPass* Ref;
+            typedef std::unique_ptr<CircuitAnalysisPass> uRef;
+
+            static uint8_t ID;
+
+        private:
+            CircuitAnalysisPass();
+
+        public:
+            bool run(QModule::Ref qmod) override;
+            static uRef Create();
+    };
+}
+
+#endif
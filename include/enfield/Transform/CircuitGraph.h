@@ -2,8 +2,9 @@
 #define __EFD_CIRCUIT_GRAPH_H__
 
 #include "enfield/Analysis/Nodes.h"
+#include "enfield/Support/Slice.h"
 
-#include <unordered_map>
+#include <vector>
 
 namespace efd {
     /// \brief Represents the id of one Quantum or Classical bit.
@@ -35,44 +36,59 @@ namespace efd {
     };
 
     /// \brief The Circuit representation of the \em QModule.
+    ///
+    /// Gates are identified by dense ids, given in the order they are appended.
+    /// Each (distinct) xbit of a gate is one of its slots, and the slots of a
+    /// gate are contiguous. A slot records its xbit, its gate, and the previous
+    /// and the next slots in the wire of that xbit. Each xbit also has an input
+    /// and an output slot, at the ends of its wire.
+    ///
+    /// So, the whole graph is just a few flat arrays, and walking a wire is
+    /// following the slots one after the other.
     class CircuitGraph {
         public:
-            /// \brief Representation of a quantum operation.
-            struct CircuitNode {
-                public:
-                    typedef CircuitNode* Ref;
-                    typedef std::unique_ptr<CircuitNode> uRef;
-                    typedef std::shared_ptr<CircuitNode> sRef;
-
+            /// \brief Handle to a node of the graph: a gate, or the input or
+            /// output of the xbits.
+            ///
+            /// It is a small value, only valid while the \em CircuitGraph it was
+            /// taken from is. Two handles are equal if they refer to the same
+            /// node, and gate nodes are ordered by their ids.
+            class CircuitNode {
                 private:
-                    enum class Type { INPUT, OUTPUT, GATE };
+                    static const uint32_t Input;
+                    static const uint32_t Output;
 
-                    Type mType;
-                    Node::Ref mNode;
-                    std::unordered_map
-                        <uint32_t, std::pair<CircuitNode::sRef, CircuitNode::sRef>>
-                        mStepMap;
+                    const CircuitGraph* mGraph;
+                    uint32_t mId;
 
-                    CircuitNode(Type type);
+                    CircuitNode(const CircuitGraph* graph, uint32_t id);
 
                 public:
+                    CircuitNode();
+
                     /// \brief Returns the \em Node::Ref associated with this circuit node.
-                    Node::Ref node();
+                    Node::Ref node() const;
+                    /// \brief Returns the id of this gate node.
+                    uint32_t id() const;
 
                     /// \brief Returns the number of \p Xbit's in this node.
-                    uint32_t numberOfXbits();
+                    uint32_t numberOfXbits() const;
 
                     /// \brief True if this node has reached the end (output node).
-                    bool isOutputNode();
+                    bool isOutputNode() const;
                     /// \brief True if this node is in the beginning (input node).
-                    bool isInputNode();
+                    bool isInputNode() const;
                     /// \brief True if this node is in the middle (gate node).
-                    bool isGateNode();
+                    bool isGateNode() const;
 
                     /// \brief Returns the \p Xbits in this node.
-                    std::vector<Xbit> getXbits(uint32_t qubits, uint32_t cbits);
+                    std::vector<Xbit> getXbits(uint32_t qubits, uint32_t cbits) const;
                     /// \brief Returns the \p Xbit ids in this node.
-                    std::vector<uint32_t> getXbitsId();
+                    Slice<uint32_t> getXbitsId() const;
+
+                    bool operator==(const CircuitNode& rhs) const;
+                    bool operator!=(const CircuitNode& rhs) const;
+                    bool operator<(const CircuitNode& rhs) const;
 
                     friend class CircuitGraph;
             };
@@ -81,20 +97,26 @@ namespace efd {
             bool mInit;
             uint32_t mQubits;
             uint32_t mCbits;
-            std::vector<CircuitNode::sRef> mGraphHead;
-            std::vector<CircuitNode::sRef> mGraphTail;
+
+            std::vector<uint32_t> mSlotXbit;
+            std::vector<uint32_t> mSlotGate;
+            std::vector<uint32_t> mSlotPrev;
+            std::vector<uint32_t> mSlotNext;
+
+            std::vector<uint32_t> mGateSlotsBegin;
+            std::vector<Node::Ref> mGateNode;
 
         public:
             /// \brief Abstracts the iteration of the \em CircuitGraph.
+            ///
+            /// It is only a cursor (slot) for each xbit. It is valid while the
+            /// \em CircuitGraph it was built from is.
             class Iterator {
                 private:
-                    uint32_t mQubits;
-                    uint32_t mCbits;
-                    std::vector<CircuitNode::sRef> mPtr;
+                    const CircuitGraph* mGraph;
+                    std::vector<uint32_t> mSlot;
 
-                    Iterator(uint32_t qubits,
-                             uint32_t cbits,
-                             std::vector<CircuitNode::sRef> ptr);
+                    Iterator(const CircuitGraph* graph);
 
                 public:
                     Iterator();
@@ -106,11 +128,11 @@ namespace efd {
                     bool back(Xbit xbit);
                     bool back(uint32_t id);
                     /// \brief Returns the \p Node::Ref for the bit \p xbit.
-                    Node::Ref get(Xbit xbit);
-                    Node::Ref get(uint32_t id);
+                    Node::Ref get(Xbit xbit) const;
+                    Node::Ref get(uint32_t id) const;
 
-                    CircuitNode::sRef operator[](Xbit xbit);
-                    CircuitNode::sRef operator[](uint32_t id);
+                    CircuitNode operator[](Xbit xbit) const;
+                    CircuitNode operator[](uint32_t id) const;
 
                     friend class CircuitGraph;
             };
@@ -121,7 +143,7 @@ namespace efd {
             /// \brief Initializes the CircuitGraph.
             void init(uint32_t qubits, uint32_t cbits);
             /// \brief Checks if the CircuitGraph is initialized. Exits with error if not.
-            void checkInitialized();
+            void checkInitialized() const;
 
             /// \brief Returns the number of qubits.
             uint32_t getQSize() const;
@@ -129,12 +151,19 @@ namespace efd {
             uint32_t getCSize() const;
             /// \brief Returns the number of bits.
             uint32_t size() const;
+            /// \brief Returns the number of gates.
+            uint32_t getNumberOfGates() const;
+
+            /// \brief Returns the node of the gate with id \p id.
+            CircuitNode getGate(uint32_t id) const;
 
             /// \brief Appends a node to the bits \p xbits.
-            void append(std::vector<Xbit> xbits, Node::Ref node);
+            ///
+            /// Repeated xbits are only considered once.
+            void append(const std::vector<Xbit>& xbits, Node::Ref node);
 
             /// \brief Builds an iterator instance for this \p CircuitGraph.
-            Iterator build_iterator();
+            Iterator build_iterator() const;
     };
 }
 
@@ -5,6 +5,7 @@
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
 #include "enfield/Transform/CircuitGraph.h"
+#include "enfield/Transform/GateStream.h"
 
 namespace efd {
     /// \brief Builds the circuit graph corresponding to the \em QModule
@@ -24,6 +25,13 @@ namespace efd {
             bool run(QModule* qmod) override;
             static uRef Create();
     };
+
+    /// \brief Builds the circuit graph of the gates in \p stream.
+    ///
+    /// If \p reversed is true, the gates are appended from the last to the
+    /// first one. i.e.: the circuit graph of the reversed circuit, without
+    /// having to reorder (or copy) the statements themselves.
+    CircuitGraph BuildCircuitGraph(const GateStream& stream, bool reversed = false);
 }
 
 #endif
@@ -0,0 +1,67 @@
+#ifndef __EFD_COMPILATION_CACHE_H__
+#define __EFD_COMPILATION_CACHE_H__
+
+#include "enfield/Transform/Driver.h"
+#include "enfield/Support/Stats.h"
+
+#include <mutex>
+
+namespace efd {
+    /// \brief Content-addressed on-disk cache of compilation results.
+    ///
+    /// Each result is stored in its own file inside a directory, named after
+    /// the 128-bit hash of everything that may change it (see \em ComputeKey).
+    /// When the directory grows larger than the size limit, the least recently
+    /// used entries are removed.
+    class CompilationCache {
+        public:
+            typedef CompilationCache* Ref;
+            typedef std::unique_ptr<CompilationCache> uRef;
+
+            /// \brief A cached compilation result.
+            ///
+            /// \em stats holds the stats collected by the compilation, so that
+            /// they may be restored (see \em RestoreStats) on a hit.
+            struct Entry {
+                std::string output;
+                QModuleQuality quality;
+                StatRecords stats;
+            };
+
+        private:
+            std::string mDir;
+            uint64_t mMaxBytes;
+            std::mutex mMutex;
+
+            std::string getPath(const std::string& key) const;
+            /// \brief Removes the least recently used entries (but \p keep),
+            /// until the directory fits in \p mMaxBytes.
+            void evict(const std::string& keep);
+
+        public:
+            /// \brief Uses the directory \p dir (creating it if needed), which
+            /// shall hold at most \p maxBytes.
+            CompilationCache(std::string dir, uint64_t maxBytes);
+
+            /// \brief Returns true and fills \p entry if there is an entry
+            /// for \p key.
+            bool lookup(const std::string& key, Entry& entry);
+            /// \brief Stores \p entry under \p key.
+            void store(const std::string& key, const Entry& entry);
+
+            /// \brief Computes the key of compiling \p qmod with \p settings.
+            ///
+            /// It hashes the flattened \p qmod (\p qmod is flattened in place, as
+            /// \em Compile would do), the architecture's adjacency, the allocator,
+            /// the gate weights and every allocator option. \p extra is hashed as
+            /// well (e.g.: for output format flags).
+            static std::string ComputeKey(QModule::Ref qmod,
+                                          const CompilationSettings& settings,
+                                          const std::string& extra = "");
+
+            /// \brief Creates an instance of this class.
+            static uRef Create(std::string dir, uint64_t maxBytes);
+    };
+}
+
+#endif
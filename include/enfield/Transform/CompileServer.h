@@ -0,0 +1,114 @@
+#ifndef __EFD_COMPILE_SERVER_H__
+#define __EFD_COMPILE_SERVER_H__
+
+#include "enfield/Transform/CompilationCache.h"
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace efd {
+    /// \brief Long-lived compilation service.
+    ///
+    /// Keeps the registries initialized and the architectures loaded between
+    /// requests. Each request is a header, an empty line and a body:
+    ///
+    ///     arch=A_ibmqx2
+    ///     alloc=Q_sabre
+    ///     length=<number of bytes of the body>
+    ///
+    ///     <QASM program>
+    ///
+    /// Header entries not given are taken from the default settings. The
+    /// recognized keys are: \em arch, \em arch-file, \em alloc, \em gate-w,
+    /// \em seed, \em trials, \em bmt-max-children, \em bmt-max-partial,
+    /// \em bmt-max-mapseq, \em sabre-lookahead, \em sabre-iterations,
+    /// \em portfolio (comma separated), \em portfolio-threshold,
+    /// \em portfolio-deadline, \em reorder, \em verify, \em force,
+    /// \em pretty and \em stats.
+    ///
+    /// The response has the same format. Its header has the \em status (either
+    /// \em ok or \em error), the quality metrics (\em Depth, \em Gates and
+    /// \em WeightedCost) or an error \em message, and the \em length of the
+    /// body, which is the compiled program. If \em stats was set, it also has
+    /// the \em stats collected by the compilation, as a JSON object.
+    ///
+    /// Each request collects its stats in its own \em StatScope. If a
+    /// \em CompilationCache is set (see \em setCache), the results (and their
+    /// stats) are taken from, and stored in, it.
+    ///
+    /// Bodies longer than \em MaxBodyLength are rejected, and the connection
+    /// is closed. A request with the \em quit key (and no body) stops the
+    /// server (see \em stop).
+    class CompileServer {
+        public:
+            typedef CompileServer* Ref;
+            typedef std::unique_ptr<CompileServer> uRef;
+            typedef std::map<std::string, std::string> Header;
+
+            /// \brief Max number of bytes of a request body.
+            static const uint32_t MaxBodyLength = 64 << 20;
+
+        private:
+            CompilationSettings mDefaults;
+            CompilationCache::Ref mCache;
+            std::map<std::string, ArchGraph::sRef> mArchs;
+            std::mutex mArchsMutex;
+
+            std::atomic<bool> mStopped;
+            std::atomic<int> mListenFd;
+            std::set<int> mConnections;
+            std::mutex mConnectionsMutex;
+
+            /// \brief Returns the architecture named \p name (or in the file
+            /// \p name, if \p isFile), loading it only once.
+            ArchGraph::sRef getArchitecture(const std::string& name, bool isFile);
+            /// \brief Overrides \p settings with the entries of \p header.
+            ///
+            /// Returns an error message, or an empty string on success.
+            std::string applyHeader(const Header& header,
+                                    CompilationSettings& settings,
+                                    bool& pretty,
+                                    bool& stats);
+
+        public:
+            CompileServer(CompilationSettings defaults);
+
+            /// \brief Uses \p cache (which must outlive the server) for the
+            /// results of the requests. It may be nullptr (no caching).
+            void setCache(CompilationCache::Ref cache);
+
+            /// \brief Reads one request from \p in, and writes its response
+            /// to \p out.
+            ///
+            /// Returns false if there was no complete request to be read.
+            bool serveOne(std::istream& in, std::ostream& out);
+            /// \brief Serves the requests from \p in until it ends.
+            void serve(std::istream& in, std::ostream& out);
+            /// \brief Serves the requests from the standard input.
+            ///
+            /// The log messages written to the standard output are moved to the
+            /// standard error while serving.
+            void serveStdio();
+            /// \brief Listens on the Unix domain socket \p path, serving up to
+            /// \p threads connections at the same time.
+            ///
+            /// Serves until \em stop is called, or until a \em SIGINT or
+            /// \em SIGTERM is received. Returns false if the socket could not
+            /// be set up, or if it failed while accepting connections.
+            bool serveUnixSocket(const std::string& path, uint32_t threads = 0);
+
+            /// \brief Stops accepting connections, and closes the open ones
+            /// after their current request.
+            ///
+            /// May be called from any thread.
+            void stop();
+
+            /// \brief Creates an instance of this class.
+            static uRef Create(CompilationSettings defaults);
+    };
+}
+
+#endif
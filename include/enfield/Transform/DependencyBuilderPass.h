@@ -5,6 +5,7 @@
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
 #include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/GateStream.h"
 
 #include <unordered_map>
 #include <map>
@@ -87,6 +88,12 @@ namespace efd {
         /// \brief Gets the dependencies for a specific instruction.
         const Dependencies getDeps(Node* ref) const;
         Dependencies getDeps(Node* ref);
+
+        /// \brief Computes the dependencies inside each gate declaration of
+        /// \p qmod, and of each gate in \p stream (the global ones).
+        ///
+        /// The xbits are numbered by \p xtn.
+        void build(QModule::Ref qmod, const XbitToNumber& xtn, const GateStream& stream);
     };
 
     /// \brief WrapperPass that yields a \em DependencyBuilder structure.
@@ -2,6 +2,7 @@
 #define __EFD_DRIVER_H__
 
 #include "enfield/Transform/QModule.h"
+#include "enfield/Transform/QModuleQualityEvalPass.h"
 #include "enfield/Arch/Architectures.h"
 #include "enfield/Transform/Allocators/Allocators.h"
 #include "enfield/Transform/Utils.h"
@@ -15,6 +16,7 @@ namespace efd {
         bool reorder;
         bool verify;
         bool force;
+        AllocatorOptions allocatorOptions;
     };
 
     /// \brief Compile \p qmod, and return the compiled version.
@@ -23,6 +25,14 @@ namespace efd {
     /// the allocator to use, the basis vector and whether to reorder the program or not.
     QModule::uRef Compile(QModule::uRef qmod, CompilationSettings settings);
 
+    /// \brief Computes the quality metrics of the compiled \p qmod.
+    ///
+    /// Reverses the edges not in \p archGraph, and inlines every gate not in
+    /// \p weights (so, \p qmod is modified).
+    QModuleQuality EvaluateQuality(QModule::Ref qmod,
+                                   ArchGraph::sRef archGraph,
+                                   const GateWeightMap& weights);
+
     /// \brief Parse file in the path \p filepath.
     QModule::uRef ParseFile(std::string filepath);
 
@@ -0,0 +1,24 @@
+#ifndef __EFD_FLAT_PARSER_H__
+#define __EFD_FLAT_PARSER_H__
+
+#include "enfield/Transform/QModule.h"
+
+namespace efd {
+    /// \brief Builds a \em QModule from the program in [\p begin, \p end),
+    /// without going through the full parser.
+    ///
+    /// Only programs that are already flat are recognized: register
+    /// declarations, standard library includes, and `U`, `CX`, `measure`,
+    /// `reset`, `barrier` and standard library gate calls whose operands are
+    /// all single bits (e.g.: `q[0]`). Each statement is created directly in
+    /// its final form, so there is no intermediate AST to be copied into the
+    /// module (nor anything for \em FlattenPass to do).
+    ///
+    /// Returns nullptr as soon as anything else is found (e.g.: gate
+    /// declarations, `if` statements or whole registers as operands), so that
+    /// the caller falls back to the full parser. Errors are not reported
+    /// here, for the same reason.
+    QModule::uRef ParseFlatProgram(const char* begin, const char* end);
+}
+
+#endif
@@ -24,6 +24,12 @@ namespace efd {
 
             static uRef Create();
     };
+
+    /// \brief Flattens the statement \p stmt of \p qmod, appending the
+    /// resulting statements to \p flattened.
+    ///
+    /// Returns false (and appends nothing) if \p stmt is already flat.
+    bool FlattenStatement(QModule::Ref qmod, Node::Ref stmt, std::vector<Node::uRef>& flattened);
 }
 
 #endif
@@ -0,0 +1,141 @@
+#ifndef __EFD_GATE_STREAM_H__
+#define __EFD_GATE_STREAM_H__
+
+#include "enfield/Analysis/Nodes.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Support/Slice.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace efd {
+    /// \brief Flat, structure-of-arrays representation of the statements of
+    /// a \em QModule.
+    ///
+    /// Every statement is lowered to a gate entry, identified by its position
+    /// in the stream (its dense gate id). Each attribute of the gates lives in
+    /// its own contiguous array, and the variable-sized ones (quantum operands,
+    /// classical operands and parameters) are stored as offsets into a shared
+    /// array. Operands are the already resolved xbit uids, as given by
+    /// \em XbitToNumber.
+    ///
+    /// Classical operands include the target bit of measurements and every
+    /// bit of the register tested by an `if` statement.
+    ///
+    /// It is immutable after built, and it keeps references to the
+    /// statements (and their parameter expressions) it was built from. So, it
+    /// is only valid while the \em QModule is not modified.
+    class GateStream {
+        public:
+            typedef GateStream* Ref;
+            typedef std::unique_ptr<GateStream> uRef;
+
+            /// \brief The kinds of gates that may be found in the stream.
+            enum class Kind : uint8_t {
+                CX = 0,
+                U,
+                MEASURE,
+                RESET,
+                BARRIER,
+                GEN,
+                INTRINSIC_SWAP,
+                INTRINSIC_REV_CX,
+                INTRINSIC_LCX
+            };
+
+            typedef Slice<uint32_t> IdSlice;
+            typedef Slice<Node::Ref> ArgSlice;
+
+        private:
+            uint32_t mQubits;
+            uint32_t mCbits;
+            bool mIsFlat;
+
+            std::vector<Kind> mKind;
+            std::vector<uint32_t> mGateName;
+            std::vector<uint32_t> mQArgsBegin;
+            std::vector<uint32_t> mQArgs;
+            std::vector<uint32_t> mCArgsBegin;
+            std::vector<uint32_t> mCArgs;
+            std::vector<uint32_t> mArgsBegin;
+            std::vector<Node::Ref> mArgs;
+            std::vector<uint32_t> mCondReg;
+            std::vector<long long> mCondVal;
+            std::vector<Node::Ref> mNode;
+
+            std::vector<std::string> mGateNames;
+            std::unordered_map<std::string, uint32_t> mGateNameId;
+            std::vector<std::string> mCRegNames;
+            std::unordered_map<std::string, uint32_t> mCRegNameId;
+            std::unordered_map<Node::Ref, uint32_t> mNodeId;
+
+            std::vector<Node::sRef> mQNodes;
+            std::vector<Node::sRef> mCNodes;
+
+            uint32_t internGateName(const std::string& name);
+            uint32_t internCRegName(const std::string& name);
+            void checkGateId(uint32_t i) const;
+
+        public:
+            GateStream();
+
+            /// \brief Resets the stream, taking the number of xbits (and the
+            /// nodes that represent them) from \p xton.
+            void init(const XbitToNumber& xton);
+
+            /// \brief Lowers \p stmt, and appends it to the end of the stream.
+            ///
+            /// Returns the gate id of the new entry.
+            uint32_t append(Node::Ref stmt, const XbitToNumber& xton);
+
+            /// \brief Returns the number of gates in the stream.
+            uint32_t size() const;
+            /// \brief Returns the number of qubits.
+            uint32_t getQSize() const;
+            /// \brief Returns the number of classical bits.
+            uint32_t getCSize() const;
+            /// \brief Returns true if every operand was a single bit (i.e.:
+            /// no register was used as a whole).
+            bool isFlat() const;
+
+            /// \brief Returns the kind of the \p i-th gate.
+            Kind getKind(uint32_t i) const;
+            /// \brief Returns the name of the gate called by the \p i-th gate.
+            const std::string& getGateName(uint32_t i) const;
+            /// \brief Returns the interned id of the name of the \p i-th gate.
+            uint32_t getGateNameId(uint32_t i) const;
+            /// \brief Returns the quantum operands of the \p i-th gate.
+            IdSlice getQArgs(uint32_t i) const;
+            /// \brief Returns the classical operands of the \p i-th gate.
+            IdSlice getCArgs(uint32_t i) const;
+            /// \brief Returns the parameter expressions of the \p i-th gate.
+            ArgSlice getArgs(uint32_t i) const;
+
+            /// \brief Returns true if the \p i-th gate is inside an `if`.
+            bool isConditional(uint32_t i) const;
+            /// \brief Returns the name of the register tested by the \p i-th gate.
+            const std::string& getCondRegName(uint32_t i) const;
+            /// \brief Returns the value the register is tested against.
+            long long getCondVal(uint32_t i) const;
+
+            /// \brief Returns the xbit uids used by the \p i-th gate, where the
+            /// classical ones are shifted by the number of qubits.
+            std::vector<uint32_t> getXbits(uint32_t i) const;
+
+            /// \brief Returns the statement the \p i-th gate was built from.
+            Node::Ref getNode(uint32_t i) const;
+            /// \brief Returns true if \p stmt is in the stream.
+            bool hasNode(Node::Ref stmt) const;
+            /// \brief Returns the gate id of \p stmt.
+            uint32_t getGateId(Node::Ref stmt) const;
+
+            /// \brief Creates a new statement equivalent to the \p i-th gate.
+            ///
+            /// Only possible when the stream \em isFlat.
+            Node::uRef lower(uint32_t i) const;
+            /// \brief Lowers every gate, in order.
+            std::vector<Node::uRef> lower() const;
+    };
+}
+
+#endif
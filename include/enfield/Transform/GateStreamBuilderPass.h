@@ -0,0 +1,27 @@
+#ifndef __EFD_GATE_STREAM_BUILDER_PASS_H__
+#define __EFD_GATE_STREAM_BUILDER_PASS_H__
+
+#include "enfield/Transform/Pass.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/GateStream.h"
+
+namespace efd {
+    /// \brief Builds the \em GateStream corresponding to the statements of the
+    /// \em QModule given.
+    ///
+    /// The xbits are numbered by \em XbitToNumberWrapperPass, and the operands
+    /// resolved only once, here. Analyses that only need the operands of each
+    /// gate should use this instead of walking the AST.
+    class GateStreamBuilderPass : public PassT<GateStream> {
+        public:
+            typedef GateStreamBuilderPass* Ref;
+            typedef std::unique_ptr<GateStreamBuilderPass> uRef;
+
+            static uint8_t ID;
+
+            bool run(QModule* qmod) override;
+            static uRef Create();
+    };
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef __EFD_GATE_TEMPLATE_H__
+#define __EFD_GATE_TEMPLATE_H__
+
+#include "enfield/Analysis/Nodes.h"
+
+#include <unordered_map>
+
+namespace efd {
+    /// \brief Statements with holes, to be filled with copies of the operands
+    /// given on each expansion.
+    ///
+    /// Each hole is an operand slot and the path (child indices) to the
+    /// node it replaces. They are found only once, when the template is
+    /// created. So, expanding it is just copying its statements and putting
+    /// the operands at these paths, instead of walking the copies looking for
+    /// the names to be replaced.
+    ///
+    /// Used for inlining gates (the slots being the formal arguments of the
+    /// gate), and for flattening operations over whole registers (the slots
+    /// being the registers).
+    class GateTemplate {
+        public:
+            typedef GateTemplate* Ref;
+            typedef std::unique_ptr<GateTemplate> uRef;
+
+        private:
+            struct Hole {
+                uint32_t mStmt;
+                uint32_t mPathBegin;
+                uint32_t mPathEnd;
+                uint32_t mSlot;
+            };
+
+            uint32_t mSlots;
+            std::vector<Node::uRef> mStmts;
+            std::vector<Hole> mHoles;
+            std::vector<uint32_t> mPaths;
+
+            GateTemplate(uint32_t slots, std::vector<Node::uRef> stmts);
+
+            /// \brief Records a hole for each identifier named after one of
+            /// the slots, reachable from \p node.
+            void collectHoles(Node::Ref node, uint32_t stmt, std::vector<uint32_t>& path,
+                              const std::unordered_map<std::string, uint32_t>& slots);
+            void addHole(uint32_t stmt, const std::vector<uint32_t>& path, uint32_t slot);
+
+        public:
+            /// \brief Returns the number of operands an expansion takes.
+            uint32_t getNumberOfSlots() const;
+            /// \brief Returns the number of statements of each expansion.
+            uint32_t getNumberOfStmts() const;
+
+            /// \brief Appends to \p out the statements of this template, with
+            /// each hole replaced by a copy of its operand in \p operands.
+            ///
+            /// If \p ifstmt is not null, each statement is wrapped by a copy
+            /// of it.
+            void expand(const std::vector<Node::Ref>& operands,
+                        std::vector<Node::uRef>& out,
+                        NDIfStmt::Ref ifstmt = nullptr) const;
+            /// \brief Expands this (gate) template with the operands of \p call.
+            void expand(NDQOp::Ref call, std::vector<Node::uRef>& out,
+                        NDIfStmt::Ref ifstmt = nullptr) const;
+
+            /// \brief Creates the template of the \p gate whose body is \p body
+            /// (usually, already inlined).
+            ///
+            /// Its slots are the quantum arguments of \p gate, followed by its
+            /// parameters. These are the operands of the calls to \p gate,
+            /// in order.
+            static uRef Create(NDGateDecl::Ref gate, std::vector<Node::uRef> body);
+            /// \brief Creates a template of (a copy of) \p stmt, where the
+            /// i-th slot replaces the i-th node of \p holes.
+            ///
+            /// The nodes in \p holes must be descendants of \p stmt.
+            static uRef Create(Node::Ref stmt, const std::vector<Node::Ref>& holes);
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
+#include "enfield/Transform/GateTemplate.h"
 
 #include <set>
 
@@ -17,17 +18,31 @@ namespace efd {
         private:
             std::set<std::string> mBasis;
             std::unordered_map<std::string, NDGateDecl::Ref> mGateDeclarations;
-            std::unordered_map<std::string, std::vector<Node::uRef>> mGateInlinedInstructions;
+            std::unordered_map<NDGateDecl::Ref, GateTemplate::uRef> mGateTemplates;
 
-            void appendInlinedInstructionsOfNode(Node::Ref node,
+            /// \brief Appends to \p inlined the statements \p node is replaced
+            /// by. Returns true if it was inlined (instead of just cloned).
+            bool appendInlinedInstructionsOfNode(Node::Ref node,
                                                  std::vector<Node::uRef>& inlined);
-            std::vector<Node::uRef> getInlinedInstructionForGate(const std::string& gateName);
+            /// \brief Returns the template of the (completely inlined) body of
+            /// \p gate, creating it on the first call.
+            const GateTemplate& getTemplateForGate(NDGateDecl::Ref gate);
+            /// \brief Maps the name of each gate declared in \p qmod to its
+            /// declaration.
+            void collectGateDeclarations(QModule::Ref qmod);
             
         public:
             InlineAllPass(std::vector<std::string> basis = std::vector<std::string>());
 
             bool run(QModule::Ref qmod) override;
 
+            /// \brief Inlines the statements that replace others in \p repMap,
+            /// with the gates declared in \p qmod.
+            ///
+            /// Cheaper than running the pass after replacing them, when they
+            /// are the only statements to be inlined.
+            void inlineReplacements(QModule::Ref qmod, QModule::ReplacementMap& repMap);
+
             /// \brief Creates an instance of this pass.
             static uRef Create(std::vector<std::string> basis = 
                     std::vector<std::string>());
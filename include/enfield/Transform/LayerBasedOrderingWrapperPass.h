@@ -3,8 +3,6 @@
 
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
 #include "enfield/Transform/LayersBuilderPass.h"
-#include <set>
-#include <unordered_map>
 
 namespace efd {
     typedef std::vector<uint32_t> Ordering;
@@ -25,9 +23,12 @@ namespace efd {
             typedef LayerBasedOrderingWrapperPass* Ref;
 
         protected:
-            std::unordered_map<Node::Ref, uint32_t> mStmtId;
+            LayerBasedOrderingWrapperPass();
 
-            uint32_t getNodeId(Node::Ref ref);
+            /// \brief Returns the new order of the statements.
+            ///
+            /// The statements are the gates of \p graph, whose ids are their
+            /// indices in the \em QModule.
             virtual Ordering generate(CircuitGraph& graph) = 0;
 
         public:
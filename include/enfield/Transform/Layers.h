@@ -0,0 +1,62 @@
+#ifndef __EFD_LAYERS_H__
+#define __EFD_LAYERS_H__
+
+#include "enfield/Analysis/Nodes.h"
+#include "enfield/Support/Slice.h"
+
+#include <vector>
+
+namespace efd {
+    /// \brief The statements of one layer.
+    typedef Slice<Node::Ref> Layer;
+
+    /// \brief Sequence of layers, stored as a single array of statements and
+    /// the offsets where each layer begins in it.
+    ///
+    /// Each layer is a \em Layer view into that array. So, they are only valid
+    /// while this object is not modified.
+    class Layers {
+        private:
+            std::vector<uint32_t> mBegin;
+            std::vector<Node::Ref> mNodes;
+
+        public:
+            /// \brief Iterates over the layers, in order.
+            class Iterator {
+                private:
+                    const Layers* mLayers;
+                    uint32_t mI;
+
+                public:
+                    Iterator(const Layers* layers, uint32_t i);
+
+                    Layer operator*() const;
+                    Iterator& operator++();
+                    bool operator==(const Iterator& rhs) const;
+                    bool operator!=(const Iterator& rhs) const;
+            };
+
+            Layers();
+            /// \brief Builds the layers from the layer of each statement.
+            ///
+            /// Statements keep their relative order inside each layer.
+            Layers(const std::vector<Node::Ref>& nodes, const std::vector<uint32_t>& layerOf);
+
+            /// \brief Returns the number of layers.
+            uint32_t size() const;
+            /// \brief Returns true if there is no layer.
+            bool empty() const;
+            /// \brief Returns the total number of statements in the layers.
+            uint32_t getNumberOfNodes() const;
+
+            /// \brief Appends a new layer with the statements in \p layer.
+            void append(const std::vector<Node::Ref>& layer);
+
+            Layer operator[](uint32_t i) const;
+
+            Iterator begin() const;
+            Iterator end() const;
+    };
+}
+
+#endif
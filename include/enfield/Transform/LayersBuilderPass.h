@@ -2,15 +2,11 @@
 #define __EFD_LAYERS_BUILDER_PASS_H__
 
 #include "enfield/Transform/Pass.h"
-#include "enfield/Analysis/Nodes.h"
-
-#include <set>
-#include <unordered_map>
+#include "enfield/Transform/Layers.h"
 
 namespace efd {
     class QModule;
-    typedef std::vector<Node::Ref> Layer;
-    typedef std::vector<Layer> Layers;
+    class GateStream;
 
     /// \brief Create the layers of the 'QModule'.
     class LayersBuilderPass : public PassT<Layers> {
@@ -25,6 +21,12 @@ namespace efd {
             /// \brief Create an instance of this class.
             static uRef Create();
     };
+
+    /// \brief Builds the layers of the gates in \p stream.
+    ///
+    /// Each gate goes to the layer right after the last one that used any of
+    /// its xbits.
+    Layers BuildLayers(const GateStream& stream);
 }
 
 #endif
@@ -2,6 +2,9 @@
 #define __EFD_PASS_H__
 
 #include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
 
 namespace efd {
     class QModule;
@@ -21,10 +24,18 @@ namespace efd {
 
         private:
             Kind mK;
+            std::vector<uint8_t*> mPreserved;
 
         protected:
             Pass(Kind k);
 
+            /// \brief Declares that the analysis \p T is still valid after
+            /// this pass modifies a \em QModule.
+            template <typename T>
+            void preserve() {
+                mPreserved.push_back(&T::ID);
+            }
+
         public:
             virtual ~Pass() = default;
 
@@ -34,6 +45,14 @@ namespace efd {
 
             /// \brief Gets the kind of this pass.
             Kind getKind() const;
+
+            /// \brief Gets the name used for reporting this pass (by default,
+            /// its class name).
+            virtual std::string getName() const;
+
+            /// \brief Returns true if the analysis identified by \p id is
+            /// preserved by this pass.
+            bool preserves(uint8_t* id) const;
     };
 
     /// \brief Should serve as base class for classes that produces
@@ -3,8 +3,11 @@
 
 #include "enfield/Analysis/Nodes.h"
 #include "enfield/Transform/Pass.h"
+#include "enfield/Transform/AnalysisManager.h"
 
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace efd {
     class Pass;
@@ -21,7 +24,7 @@ namespace efd {
             typedef std::vector<NDGateSign::Ref> GatesVector; 
 
             typedef std::unordered_map<std::string, NDRegDecl::uRef> RegsMap; 
-            typedef std::unordered_map<std::string, NDGateSign::uRef> GatesMap; 
+            typedef std::unordered_map<std::string, NDGateSign::sRef> GatesMap; 
 
             typedef std::unordered_map<std::string, NDId::Ref> IdMap;
             typedef std::unordered_map<NDGateDecl::Ref, IdMap> GateIdMap;
@@ -35,6 +38,8 @@ namespace efd {
             typedef GatesVector::iterator GateIterator;
             typedef GatesVector::const_iterator GateConstIterator;
 
+            typedef std::unordered_map<Node::Ref, std::vector<Node::uRef>> ReplacementMap;
+
         private:
             NDQasmVersion::uRef mVersion;
             IncludeVector mIncludes;
@@ -43,12 +48,79 @@ namespace efd {
             RegsMap mRegsMap; 
             GatesMap mGatesMap; 
 
+            /// \brief Position of each statement, so that they can be found in
+            /// constant time.
+            ///
+            /// Inserting or removing statements does not rebuild it. Instead,
+            /// the shift of the statements after the edited position is logged,
+            /// and applied lazily to a position when it is looked up. It is only
+            /// rebuilt after \em MaxShifts edits (or after rewriting the whole list).
+            struct StatementIndex {
+                static const uint32_t MaxShifts = 64;
+
+                struct Entry {
+                    uint32_t mPosition;
+                    /// \brief Number of shifts already applied to \em mPosition.
+                    uint32_t mShifts;
+                };
+
+                /// \brief Statements at \em mFrom or after moved by \em mDelta.
+                struct Shift {
+                    uint32_t mFrom;
+                    int32_t mDelta;
+                };
+
+                std::unordered_map<Node::Ref, Entry> mEntries;
+                std::vector<Shift> mShifts;
+                bool mValid = false;
+            };
+
+            /// \brief Statement list that may be shared by the modules
+            /// created with \em cloneShared.
+            ///
+            /// Modules sharing a list may live in different threads. So,
+            /// \em mOwners and the ownership of \em mList are guarded by
+            /// \em mMutex.
+            struct SharedStmtList {
+                NDStmtList::uRef mList;
+                std::vector<QModule*> mOwners;
+                std::mutex mMutex;
+
+                StatementIndex mIndex;
+            };
+
             RegsVector mRegs;
             GatesVector mGates;
-            NDStmtList::uRef mStatements;
+            /// \brief Gates shared with other modules (e.g.: from the standard
+            /// library), instead of owned by this one.
+            std::unordered_set<NDGateSign::Ref> mSharedGates;
+            std::shared_ptr<SharedStmtList> mStatements;
+
+            AnalysisManager::uRef mAnalyses;
 
             QModule();
 
+            friend std::unique_ptr<QModule> ParseFlatProgram(const char* begin, const char* end);
+
+            /// \brief Drops this module from the owners of the current
+            /// statement list.
+            void releaseStatements();
+            /// \brief Returns the iterator pointing to \p ref, or \em stmt_end
+            /// if it is not a statement of this module.
+            Iterator lookupStatement(Node::Ref ref);
+            /// \brief Marks the statement positions as out of date.
+            void invalidateStatementIndex();
+            /// \brief Records that the statements at \p from or after moved
+            /// by \p delta positions.
+            void shiftStatementIndex(uint32_t from, int32_t delta);
+            /// \brief Indexes the \p n statements starting at \p from.
+            void indexStatements(uint32_t from, uint32_t n);
+            /// \brief Inserts \p gate, replacing the one with the same id.
+            void insertGate(NDGateSign::sRef gate, bool shared);
+            /// \brief Inserts the gates of this module into \p qmod, cloning
+            /// only the ones that are not shared.
+            void copyGatesTo(QModule::Ref qmod) const;
+
         public:
             ~QModule();
 
@@ -84,12 +156,38 @@ namespace efd {
 
             /// \brief Replaces the \p stmt by the vector \p stmts.
             Iterator replaceStatement(Node::Ref stmt, std::vector<Node::uRef> stmts);
+            /// \brief Replaces every statement in \p repMap by its corresponding
+            /// vector of statements.
+            ///
+            /// All replacements are done in a single pass over the statements.
+            /// So, it should be preferred over many \em replaceStatement calls.
+            void replaceStatements(ReplacementMap repMap);
 
             /// \brief Removes all statements present int this module.
             void clearStatements();
+            /// \brief Removes all statements present in this module, and
+            /// returns them (they are not copied, unless they are shared).
+            std::vector<Node::uRef> takeStatements();
+
+            /// \brief Makes this module the only owner of its statement list.
+            ///
+            /// This module keeps the nodes it already had (i.e.: iterators and
+            /// references remain valid), and the other owners get a copy of them.
+            /// Structural modifications already do this. It only has to be called
+            /// before modifying the statements in place, through the iterators.
+            void detachStatements();
+            /// \brief Returns true if the statement list is shared with other
+            /// modules.
+            bool hasSharedStatements() const;
 
             /// \brief Inserts a gate to the QModule.
             void insertGate(NDGateSign::uRef gate);
+            /// \brief Inserts a gate that is shared with other modules.
+            ///
+            /// It must not be modified. Clones of this module share it as well.
+            void insertSharedGate(NDGateSign::sRef gate);
+            /// \brief Returns true if \p gate is shared with other modules.
+            bool isSharedGate(NDGateSign::Ref gate) const;
 
             /// \brief Returns the \p i-th statement.
             Node::Ref getStatement(uint32_t i);
@@ -147,8 +245,17 @@ namespace efd {
             /// \brief Returns true if there is a quantum gate \p id.
             bool hasQGate(std::string id) const;
 
+            /// \brief Returns the manager of the analyses run on this module.
+            AnalysisManager::Ref getAnalysisManager();
+
             /// \brief Clones the current qmodule.
             uRef clone() const;
+            /// \brief Clones the current qmodule, sharing the statement list
+            /// with it.
+            ///
+            /// The statements are only copied when either of them is modified
+            /// (see \em detachStatements).
+            uRef cloneShared() const;
 
             /// \brief Create a new empty QModule.
             static uRef Create();
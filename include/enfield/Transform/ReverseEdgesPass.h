@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
+#include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Arch/ArchGraph.h"
 
 namespace efd {
@@ -16,12 +17,17 @@ namespace efd {
 
         private:
             ArchGraph::sRef mG;
+            std::unique_ptr<InlineAllPass> mInliner;
 
             ReverseEdgesPass(ArchGraph::sRef graph);
 
         public:
             bool run(QModule::Ref qmod) override;
 
+            /// \brief Flags the pass to inline the reversed gates, but those
+            /// inside the \p basis vector.
+            void setInlineAll(std::vector<std::string> basis = {});
+
             /// \brief Create an instance of this class.
             static uRef Create(ArchGraph::sRef graph);
     };
@@ -7,26 +7,18 @@
 #include <map>
 
 namespace efd {
+    struct XbitToNumber;
+    class ArchGraph;
+
     using GateWeightMap = std::map<std::string, uint32_t>;
     using GateNameVector = std::vector<std::string>;
     using StatementPair = std::pair<NDIfStmt::Ref, NDQOp::Ref>;
-    using InlineArgMap = std::unordered_map<std::string, Node::Ref>;
 
     /// \brief Extracts only the gate names to a separate vector.
     GateNameVector ExtractGateNames(const GateWeightMap& map);
     /// \brief Breakdowns the \p node into \em NDIfStmt and \em NDQOp pair.
     StatementPair GetStatementPair(const Node::Ref node);
 
-    /// \brief Create an \em InlineArgMap for \p call and \p gateDecl.
-    ///
-    /// Creates a mapping from the qubits used in \p gateDecl to the qubits used
-    /// in \p call. It prepares for inlining.
-    InlineArgMap CreateInlineArgMap(NDGateDecl::Ref gateDecl, NDQOp::Ref call);
-    /// \brief Replace the qubits used in \p inlinedInstructions according to
-    /// the mapping \p argMap.
-    void ReplaceInlineArgMap(const InlineArgMap& argMap,
-                             std::vector<Node::uRef>& inlinedInstructions,
-                             NDIfStmt::Ref ifstmt = nullptr);
     /// \brief If found, inlines the gate that \p qop calls.
     void InlineGate(QModule::Ref qmod, NDQOp::Ref qop);
     /// \brief Processes the \p root node, and transform the entire AST into
@@ -34,7 +26,14 @@ namespace efd {
     void ProcessAST(QModule::Ref qmod, Node::Ref root);
 
     /// \brief Returns a vector with the intrinsic gates implementation.
-    std::vector<NDGateSign::uRef> GetIntrinsicGates();
+    ///
+    /// They are parsed only once per process, and shared by every module.
+    const std::vector<NDGateSign::sRef>& GetIntrinsicGates();
+    /// \brief Returns the gates declared by the standard library file
+    /// \p filename (see \em GetStdLibAST), or nullptr if there is no such file.
+    ///
+    /// They are created only once per process, and shared by every module.
+    const std::vector<NDGateSign::sRef>* GetStdLibGates(const std::string& filename);
 
     /// \brief Creates a call to the intrinsic swap function.
     NDQOp::uRef CreateISwap(Node::uRef lhs, Node::uRef rhs);
@@ -57,6 +56,12 @@ namespace efd {
     /// \brief Creates an intrinsic gate of kind \p kind and arguments \p args.
     NDQOp::uRef CreateIntrinsicGate(NDQOpGen::IntrinsicKind kind,
                                     std::vector<Node::uRef> qargs);
+
+    /// \brief Returns, for each qubit uid of \p xton, the uid of the vertex
+    /// of \p arch with the same name (or \em _undef, if there is none).
+    ///
+    /// So, the operands of a \em GateStream may be used as vertices of \p arch.
+    std::vector<uint32_t> GetArchQUIds(const XbitToNumber& xton, ArchGraph& arch);
 }
 
 #endif
@@ -2,6 +2,7 @@
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/PoolAllocator.h"
 #include "enfield/Support/Defs.h"
 
 #include <algorithm>
@@ -18,6 +19,14 @@ void efd::Node::innerAddChild(uRef ref) {
 efd::Node::~Node() {
 }
 
+void* efd::Node::operator new(std::size_t size) {
+    return PoolAllocator::Allocate(size);
+}
+
+void efd::Node::operator delete(void* ptr, std::size_t size) {
+    PoolAllocator::Deallocate(ptr, size);
+}
+
 efd::Node::Ref efd::Node::getChild(uint32_t i) const {
     return mChild[i].get();
 }
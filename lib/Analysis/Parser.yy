@@ -4,6 +4,8 @@
     #include "enfield/Analysis/Nodes.h"
     #include "enfield/Analysis/Driver.h"
     #include "enfield/Support/WrapperVal.h"
+    #include "enfield/Support/SymbolTable.h"
+    #include "enfield/Support/MappedFile.h"
     #include "enfield/Support/RTTI.h"
     #include "enfield/Support/Defs.h"
     #include "enfield/Support/CommandLine.h"
@@ -16,56 +18,55 @@
 %code provides {
     #include <unordered_map>
     #include <sstream>
+    #include <mutex>
 
     extern efd::Opt<std::vector<std::string>> IncludePath;
     extern std::unordered_map<std::string, std::string> StdLib;
 }
 
 %code provides {
-    #if ! defined(yyFlexLexerOnce)
-    #include <FlexLexer.h>
-    #endif
-
     #define YYDEBUG 1
 
     #include <cstdio>
     #include <cstring>
     #include <cerrno>
 
-    /* Size of default input buffer. */
-    #ifndef YY_BUF_SIZE
-    #ifdef __ia64__
-    /* On IA-64, the buffer size is 16k, not 8k.
-     * Moreover, YY_BUF_SIZE is 2*YY_READ_BUF_SIZE in the general case.
-     * Ditto for the __ia64__ case accordingly.
-     */
-    #define YY_BUF_SIZE 32768
-    #else
-    #define YY_BUF_SIZE 16384
-    #endif /* __ia64__ */
-    #endif
-
     #include <iostream>
-    #include <fstream>
+    #include <vector>
 
     namespace efd {
-        class EfdScanner : public yyFlexLexer {
+        /// \brief Scanner that reads its input in place.
+        ///
+        /// The input is a stack of buffers (e.g.: memory-mapped files), and
+        /// each token is a range of the buffer on top. Identifiers are interned
+        /// in a \em SymbolTable, and numbers are parsed as they are scanned, so
+        /// that no temporary string is created for them.
+        class EfdScanner {
+            private:
+                struct Buffer {
+                    const char* mCur;
+                    const char* mEnd;
+                    yy::location mLoc;
+                };
+
+                std::vector<Buffer> mBuffers;
+                SymbolTable mSymbols;
+
             public:
-                EfdScanner(std::istream* iStream, std::ostream* oStream);
+                EfdScanner(const char* begin, const char* end, std::string* filename = nullptr);
+
+                /// \brief Scans [\p begin, \p end) until \em popBuffer is called.
+                void pushBuffer(const char* begin, const char* end, std::string* filename = nullptr);
+                /// \brief Resumes scanning the previous buffer.
+                void popBuffer();
+
+                /// \brief Returns the next token of the buffer on top.
                 yy::EfdParser::symbol_type lex();
         };
     }
-
-    #undef YY_DECL
-    #define YY_DECL \
-        efd::yy::EfdParser::symbol_type efd::EfdScanner::lex()
 }
 
 %code {
-    efd::EfdScanner::EfdScanner(std::istream* iStream, std::ostream* oStream)
-       : yyFlexLexer(iStream, oStream) {
-    }
-
     void efd::yy::EfdParser::error(efd::yy::location const& loc, std::string const& err) {
         std::string filename = "unknown";
         if (loc.begin.filename) filename = *loc.begin.filename;
@@ -128,7 +129,7 @@
 
 %token <efd::IntVal> INT;
 %token <efd::RealVal> REAL;
-%token <std::string> ID;
+%token <efd::SymbolTable::Symbol> ID;
 %token <std::string> STRING;
 
 %token EOF 0 "end of file";
@@ -188,44 +189,38 @@ statement: decl         { $$ = $1; }
          ;
 
 include: INCLUDE string ";"     {
-                                    std::istream* istr = nullptr;
-                                    std::ifstream ifs;
-                                    std::istringstream iss;
-                                    efd::ASTWrapper _ast;
-
                                     std::string file = efd::dynCast<efd::NDString>($2)->getVal();
 
-                                    if (StdLib.find(file) != StdLib.end()) {
-                                        _ast = efd::ASTWrapper { file, "./", nullptr, false };
-                                        iss.str(StdLib[file]);
-                                        istr = &iss;
+                                    if (auto stdLibAST = efd::GetStdLibAST(file)) {
+                                        // Already parsed once for the whole process.
                                         ast.mStdLibParsed = true;
+                                        $$ = efd::NDInclude::Create(efd::NDString::uRef($2), stdLibAST->clone()).release();
                                     } else {
+                                        efd::MappedFile::uRef mapped;
+                                        efd::ASTWrapper _ast;
+
                                         std::vector<std::string> includePaths = IncludePath.getVal();
                                         includePaths.push_back(ast.mPath);
 
                                         for (auto path : includePaths) {
                                             _ast = efd::ASTWrapper { file, path, nullptr, false };
-                                            ifs.open((_ast.mPath + _ast.mFile).c_str());
-                                            if (!ifs.fail()) {
-                                                istr = &ifs;
-                                                break;
-                                            }
+                                            mapped = efd::MappedFile::Open(_ast.mPath + _ast.mFile);
+                                            if (mapped.get() != nullptr) break;
                                         }
-                                    }
 
-                                    if (istr == nullptr) {
-                                        error(@$, "Could not open file: " + _ast.mPath + _ast.mFile);
-                                        error(@$, "Error: " + std::string(strerror(errno)));
-                                        return 1;
-                                    }
+                                        if (mapped.get() == nullptr) {
+                                            error(@$, "Could not open file: " + _ast.mPath + _ast.mFile);
+                                            error(@$, "Error: " + std::string(strerror(errno)));
+                                            return 1;
+                                        }
 
-                                    efd::yy::EfdParser parser(_ast, scanner);
-                                    scanner.yypush_buffer_state(scanner.yy_create_buffer(istr, YY_BUF_SIZE));
-                                    if (parser.parse()) return 1;
-                                    scanner.yypop_buffer_state();
+                                        efd::yy::EfdParser parser(_ast, scanner);
+                                        scanner.pushBuffer(mapped->begin(), mapped->end(), &_ast.mFile);
+                                        if (parser.parse()) return 1;
+                                        scanner.popBuffer();
 
-                                    $$ = efd::NDInclude::Create(efd::NDString::uRef($2), efd::Node::uRef(_ast.mAST)).release();
+                                        $$ = efd::NDInclude::Create(efd::NDString::uRef($2), efd::Node::uRef(_ast.mAST)).release();
+                                    }
                                 }
         ;
 
@@ -380,7 +375,7 @@ idref: id "[" integer "]"   {
                             }
      ;
 
-id: ID { $$ = efd::NDId::Create($1).release(); }
+id: ID { $$ = efd::NDId::Create(*$1).release(); }
   ;
 
 integer: INT { $$ = efd::NDInt::Create($1).release(); }
@@ -393,8 +388,8 @@ real: REAL { $$ = efd::NDReal::Create($1).release(); }
 
 %%
 
-static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
-    efd::EfdScanner scanner(&istr, nullptr);
+static int Parse(const char* begin, const char* end, efd::ASTWrapper& ast, bool forceStdLib) {
+    efd::EfdScanner scanner(begin, end, &ast.mFile);
     efd::yy::EfdParser parser(ast, scanner);
 
     int ret = parser.parse();
@@ -412,9 +407,9 @@ static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
             EfdAbortIf(true, "AST Root node is neither a `NDQasmVersion` nor a `NDStmtList`.");
         }
 
-        for (auto pair : StdLib) {
+        for (auto& pair : StdLib) {
             auto refInclude = efd::NDInclude::Create
-                (efd::NDString::Create(pair.first), efd::ParseString(pair.second, false));
+                (efd::NDString::Create(pair.first), efd::GetStdLibAST(pair.first)->clone());
             auto inclNode = efd::Node::uRef(refInclude.release());
 
             auto it = stmts->begin();
@@ -428,27 +423,53 @@ static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
 efd::Node::uRef efd::ParseFile(std::string filename, std::string path, bool forceStdLib) {
     ASTWrapper ast { filename, path, nullptr, false };
 
-    std::ifstream ifs((ast.mPath + ast.mFile).c_str());
-    if (ifs.fail()) {
+    auto mapped = efd::MappedFile::Open(ast.mPath + ast.mFile);
+    if (mapped.get() == nullptr) {
         std::cerr << "Could not open file: " << ast.mPath + ast.mFile << std::endl;
         std::cerr << "Error: " << strerror(errno) << std::endl;
         return nullptr;
     }
 
-    if (Parse(ifs, ast, forceStdLib)) return efd::Node::uRef(nullptr);
-
-    ifs.close();
+    if (Parse(mapped->begin(), mapped->end(), ast, forceStdLib)) return efd::Node::uRef(nullptr);
     return efd::Node::uRef(ast.mAST);
 }
 
 efd::Node::uRef efd::ParseString(std::string program, bool forceStdLib) {
     std::string filename = "qasm-" + std::to_string((uint64_t) &program) + ".qasm";
     std::string path =  "./";
-    std::stringstream ss(program);
 
     ASTWrapper ast { filename, path, nullptr, false };
-    int ret = Parse(ss, ast, forceStdLib);
+    int ret = Parse(program.data(), program.data() + program.size(), ast, forceStdLib);
 
     if (ret) return efd::Node::uRef(nullptr);
     return efd::Node::uRef(ast.mAST);
 }
+
+efd::Node::Ref efd::GetStdLibAST(const std::string& filename) {
+    // Never destroyed: the nodes may outlive the other static objects.
+    static auto& Parsed = *new std::unordered_map<std::string, efd::Node::uRef>();
+    static std::mutex Mutex;
+
+    auto lib = StdLib.find(filename);
+    if (lib == StdLib.end()) return nullptr;
+
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    auto& ast = Parsed[filename];
+    if (ast.get() == nullptr) {
+        ast = efd::ParseString(lib->second, false);
+        EfdAbortIf(ast.get() == nullptr, "Could not parse the standard library `" << filename << "`.");
+    }
+
+    return ast.get();
+}
+
+std::vector<std::string> efd::GetStdLibFilenames() {
+    std::vector<std::string> filenames;
+
+    for (auto& pair : StdLib) {
+        filenames.push_back(pair.first);
+    }
+
+    return filenames;
+}
@@ -0,0 +1,219 @@
+#include "enfield/Analysis/QASMEmitter.h"
+
+efd::QASMEmitter::QASMEmitter(std::ostream& out, bool pretty)
+    : mOut(out), mPretty(pretty) {
+    mBuffer.reserve(BufferSize);
+}
+
+efd::QASMEmitter::~QASMEmitter() {
+    flush();
+}
+
+void efd::QASMEmitter::write(const std::string& str) {
+    mBuffer.append(str);
+    if (mBuffer.size() >= BufferSize) flush();
+}
+
+void efd::QASMEmitter::write(const char* str) {
+    mBuffer.append(str);
+    if (mBuffer.size() >= BufferSize) flush();
+}
+
+void efd::QASMEmitter::write(char c) {
+    mBuffer.push_back(c);
+    if (mBuffer.size() >= BufferSize) flush();
+}
+
+void efd::QASMEmitter::endl() {
+    if (mPretty) write('\n');
+}
+
+void efd::QASMEmitter::emit(Node::Ref ref) {
+    ref->apply(this);
+}
+
+void efd::QASMEmitter::flush() {
+    mOut.write(mBuffer.data(), mBuffer.size());
+    mBuffer.clear();
+}
+
+void efd::QASMEmitter::emitQOp(NDQOp::Ref ref) {
+    write(ref->getId()->getValRef());
+
+    auto args = ref->getArgs();
+    if (!args->isEmpty()) {
+        write('(');
+        args->apply(this);
+        write(')');
+    }
+
+    write(' ');
+    ref->getQArgs()->apply(this);
+    write(';');
+    endl();
+}
+
+void efd::QASMEmitter::emitGateSign(NDGateSign::Ref ref) {
+    write(' ');
+    write(ref->getId()->getValRef());
+
+    auto args = ref->getArgs();
+    if (!args->isEmpty()) {
+        write('(');
+        args->apply(this);
+        write(')');
+    }
+
+    write(' ');
+    ref->getQArgs()->apply(this);
+}
+
+void efd::QASMEmitter::visit(NDQasmVersion::Ref ref) {
+    write("OPENQASM ");
+    ref->getVersion()->apply(this);
+    write(';');
+    endl();
+
+    ref->getStatements()->apply(this);
+}
+
+void efd::QASMEmitter::visit(NDInclude::Ref ref) {
+    write("include \"");
+    write(ref->getFilename()->getValRef());
+    write("\";");
+    endl();
+}
+
+void efd::QASMEmitter::visit(NDRegDecl::Ref ref) {
+    write((ref->isQReg()) ? "qreg " : "creg ");
+    write(ref->getId()->getValRef());
+    write('[');
+    ref->getSize()->apply(this);
+    write("];");
+    endl();
+}
+
+void efd::QASMEmitter::visit(NDGateDecl::Ref ref) {
+    write("gate");
+    emitGateSign(ref);
+    write(" {");
+    endl();
+
+    auto gopList = ref->getGOpList();
+    if (!gopList->isEmpty()) gopList->apply(this);
+
+    write('}');
+    endl();
+}
+
+void efd::QASMEmitter::visit(NDOpaque::Ref ref) {
+    write("opaque");
+    emitGateSign(ref);
+    write(';');
+    endl();
+}
+
+void efd::QASMEmitter::visit(NDQOpMeasure::Ref ref) {
+    write("measure ");
+    ref->getQBit()->apply(this);
+    write(" -> ");
+    ref->getCBit()->apply(this);
+    write(';');
+    endl();
+}
+
+void efd::QASMEmitter::visit(NDQOpReset::Ref ref) {
+    emitQOp(ref);
+}
+
+void efd::QASMEmitter::visit(NDQOpU::Ref ref) {
+    emitQOp(ref);
+}
+
+void efd::QASMEmitter::visit(NDQOpCX::Ref ref) {
+    emitQOp(ref);
+}
+
+void efd::QASMEmitter::visit(NDQOpBarrier::Ref ref) {
+    emitQOp(ref);
+}
+
+void efd::QASMEmitter::visit(NDQOpGen::Ref ref) {
+    emitQOp(ref);
+}
+
+void efd::QASMEmitter::visit(NDBinOp::Ref ref) {
+    write('(');
+    ref->getLhs()->apply(this);
+    write(' ');
+    write(ref->getOperation());
+    write(' ');
+    ref->getRhs()->apply(this);
+    write(')');
+}
+
+void efd::QASMEmitter::visit(NDUnaryOp::Ref ref) {
+    if (ref->isNeg()) {
+        write("(-");
+        ref->getOperand()->apply(this);
+        write(')');
+    } else {
+        write(ref->getOperation());
+        write('(');
+        ref->getOperand()->apply(this);
+        write(')');
+    }
+}
+
+void efd::QASMEmitter::visit(NDIdRef::Ref ref) {
+    write(ref->getId()->getValRef());
+    write('[');
+    ref->getN()->apply(this);
+    write(']');
+}
+
+void efd::QASMEmitter::visit(NDList::Ref ref) {
+    bool first = true;
+
+    for (auto& child : *ref) {
+        if (!first) write(", ");
+        child->apply(this);
+        first = false;
+    }
+}
+
+void efd::QASMEmitter::visit(NDStmtList::Ref ref) {
+    for (auto& child : *ref) {
+        child->apply(this);
+    }
+}
+
+void efd::QASMEmitter::visit(NDGOpList::Ref ref) {
+    for (auto& child : *ref) {
+        if (!child->isEmpty()) {
+            if (mPretty) write('\t');
+            child->apply(this);
+        }
+    }
+}
+
+void efd::QASMEmitter::visit(NDIfStmt::Ref ref) {
+    write("if (");
+    write(ref->getCondId()->getValRef());
+    write(" == ");
+    ref->getCondN()->apply(this);
+    write(") ");
+    ref->getQOp()->apply(this);
+}
+
+void efd::QASMEmitter::visit(NDValue<std::string>::Ref ref) {
+    write(ref->getValRef());
+}
+
+void efd::QASMEmitter::visit(NDValue<IntVal>::Ref ref) {
+    write(ref->getValRef().mStr);
+}
+
+void efd::QASMEmitter::visit(NDValue<RealVal>::Ref ref) {
+    write(ref->getValRef().mStr);
+}
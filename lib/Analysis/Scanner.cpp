@@ -0,0 +1,255 @@
+#include "EfdParser.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+typedef efd::yy::EfdParser Parser;
+typedef Parser::token Token;
+
+namespace {
+    struct Keyword {
+        const char* mName;
+        uint32_t mLength;
+        Token::yytokentype mToken;
+    };
+}
+
+/// \brief Keywords that would otherwise be scanned as identifiers.
+static const Keyword Keywords[] = {
+    { "include", 7, Token::TOK_INCLUDE },
+    { "opaque", 6, Token::TOK_OPAQUE },
+    { "if", 2, Token::TOK_IF },
+    { "barrier", 7, Token::TOK_BARRIER },
+    { "qreg", 4, Token::TOK_QREG },
+    { "creg", 4, Token::TOK_CREG },
+    { "gate", 4, Token::TOK_GATE },
+    { "measure", 7, Token::TOK_MEASURE },
+    { "reset", 5, Token::TOK_RESET },
+    { "sin", 3, Token::TOK_SIN },
+    { "cos", 3, Token::TOK_COS },
+    { "tan", 3, Token::TOK_TAN },
+    { "exp", 3, Token::TOK_EXP },
+    { "ln", 2, Token::TOK_LN },
+    { "sqrt", 4, Token::TOK_SQRT }
+};
+
+/// \brief Integers with more digits than this may not fit in a long long.
+static const uint32_t MaxSafeIntDigits = 18;
+/// \brief Reals longer than this are copied to the heap before being parsed.
+static const uint32_t MaxStackRealLength = 64;
+
+static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool IsLower(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+static bool IsIdChar(char c) {
+    return IsLower(c) || (c >= 'A' && c <= 'Z') || IsDigit(c) || c == '_';
+}
+
+static bool StartsWith(const char* begin, const char* end, const char* prefix, uint32_t length) {
+    return (uint32_t) (end - begin) >= length && std::memcmp(begin, prefix, length) == 0;
+}
+
+/// \brief Returns the end of the digits starting at \p begin.
+static const char* SkipDigits(const char* begin, const char* end) {
+    while (begin != end && IsDigit(*begin)) ++begin;
+    return begin;
+}
+
+static efd::IntVal MakeInt(const char* begin, const char* end) {
+    std::string str(begin, end);
+    if ((uint32_t) (end - begin) > MaxSafeIntDigits) return efd::IntVal(str);
+
+    long long val = 0;
+    for (; begin != end; ++begin) val = val * 10 + (*begin - '0');
+    return efd::IntVal(val, str);
+}
+
+static efd::RealVal MakeReal(const char* begin, const char* end) {
+    uint32_t length = end - begin;
+
+    // `strtod` needs a terminated string, and the buffer is not.
+    if (length >= MaxStackRealLength) {
+        std::string str(begin, end);
+        return efd::RealVal(std::strtod(str.c_str(), nullptr), str);
+    }
+
+    char buffer[MaxStackRealLength];
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    return efd::RealVal(std::strtod(buffer, nullptr), std::string(begin, end));
+}
+
+efd::EfdScanner::EfdScanner(const char* begin, const char* end, std::string* filename) {
+    pushBuffer(begin, end, filename);
+}
+
+void efd::EfdScanner::pushBuffer(const char* begin, const char* end, std::string* filename) {
+    mBuffers.push_back(Buffer { begin, end, yy::location(filename) });
+}
+
+void efd::EfdScanner::popBuffer() {
+    EfdAbortIf(mBuffers.size() <= 1, "Can't pop the first buffer of the scanner.");
+    mBuffers.pop_back();
+}
+
+efd::yy::EfdParser::symbol_type efd::EfdScanner::lex() {
+    auto& buffer = mBuffers.back();
+    auto& loc = buffer.mLoc;
+    const char*& cur = buffer.mCur;
+    const char* end = buffer.mEnd;
+
+    while (true) {
+        loc.step();
+        if (cur == end) return Parser::make_EOF(loc);
+
+        const char* begin = cur;
+        char c = *cur;
+
+        if (c == ' ' || c == '\t') {
+            ++cur;
+            loc.columns(1);
+            continue;
+        }
+
+        if (c == '\r' || c == '\n') {
+            uint32_t lines = 0;
+            for (; cur != end && (*cur == '\r' || *cur == '\n'); ++cur) {
+                if (*cur == '\n') ++lines;
+            }
+
+            loc.lines(lines > 0 ? lines : 1);
+            continue;
+        }
+
+        if (IsLower(c)) {
+            while (cur != end && IsIdChar(*cur)) ++cur;
+
+            uint32_t length = cur - begin;
+            loc.columns(length);
+
+            for (auto& keyword : Keywords) {
+                if (keyword.mLength == length &&
+                    std::memcmp(keyword.mName, begin, length) == 0) {
+                    return Parser::symbol_type(keyword.mToken, loc);
+                }
+            }
+
+            return Parser::make_ID(mSymbols.intern(begin, cur), loc);
+        }
+
+        if (IsDigit(c) || c == '.') {
+            bool isReal = false;
+
+            // An integer is either `0` or has no leading zeros.
+            if (c == '0') ++cur;
+            else cur = SkipDigits(cur, end);
+
+            if (cur != end && *cur == '.') {
+                isReal = true;
+                cur = SkipDigits(cur + 1, end);
+            }
+
+            if (cur != end && (*cur == 'e' || *cur == 'E')) {
+                const char* exp = cur + 1;
+                if (exp != end && (*exp == '+' || *exp == '-')) ++exp;
+
+                if (exp != end && IsDigit(*exp)) {
+                    isReal = true;
+                    cur = SkipDigits(exp, end);
+                }
+            }
+
+            loc.columns(cur - begin);
+            if (isReal) return Parser::make_REAL(MakeReal(begin, cur), loc);
+            return Parser::make_INT(MakeInt(begin, cur), loc);
+        }
+
+        ++cur;
+
+        switch (c) {
+            case 'O':
+                if (StartsWith(begin, end, "OPENQASM", 8)) {
+                    cur = begin + 8;
+                    loc.columns(8);
+                    return Parser::make_IBMQASM(loc);
+                }
+                break;
+
+            case 'C':
+                if (cur != end && *cur == 'X') {
+                    ++cur;
+                    loc.columns(2);
+                    return Parser::make_CX(loc);
+                }
+                break;
+
+            case 'U':
+                loc.columns(1);
+                return Parser::make_U(loc);
+
+            case '"': {
+                // A string goes up to the last quote of the line.
+                const char* last = nullptr;
+                for (const char* it = cur; it != end && *it != '\n'; ++it) {
+                    if (*it == '"') last = it;
+                }
+
+                if (last != nullptr) {
+                    cur = last + 1;
+                    loc.columns(cur - begin);
+                    return Parser::make_STRING(std::string(begin, cur), loc);
+                }
+                break;
+            }
+
+            case '/':
+                if (cur != end && *cur == '/') {
+                    // Comments go up to the end of the line.
+                    while (cur != end && *cur != '\n') ++cur;
+                    loc.columns(cur - begin);
+                    continue;
+                }
+
+                loc.columns(1);
+                return Parser::make_DIV(loc);
+
+            case '=':
+                if (cur != end && *cur == '=') {
+                    ++cur;
+                    loc.columns(2);
+                    return Parser::make_EQUAL(loc);
+                }
+                break;
+
+            case '-':
+                if (cur != end && *cur == '>') {
+                    ++cur;
+                    loc.columns(2);
+                    return Parser::make_MARROW(loc);
+                }
+
+                loc.columns(1);
+                return Parser::make_SUB(loc);
+
+            case '+': loc.columns(1); return Parser::make_ADD(loc);
+            case '*': loc.columns(1); return Parser::make_MUL(loc);
+            case '^': loc.columns(1); return Parser::make_POW(loc);
+            case '(': loc.columns(1); return Parser::make_LPAR(loc);
+            case ')': loc.columns(1); return Parser::make_RPAR(loc);
+            case '[': loc.columns(1); return Parser::make_LSBRAC(loc);
+            case ']': loc.columns(1); return Parser::make_RSBRAC(loc);
+            case '{': loc.columns(1); return Parser::make_LCBRAC(loc);
+            case '}': loc.columns(1); return Parser::make_RCBRAC(loc);
+            case ',': loc.columns(1); return Parser::make_COMMA(loc);
+            case ';': loc.columns(1); return Parser::make_SEMICOL(loc);
+        }
+
+        // Any other character is skipped.
+        loc.columns(cur - begin);
+    }
+}
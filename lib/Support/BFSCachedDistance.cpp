@@ -1,30 +1,64 @@
 #include "enfield/Support/BFSCachedDistance.h"
 
 #include <queue>
+#include <mutex>
+#include <deque>
 
 using namespace efd;
 
-BFSCachedDistance::BFSCachedDistance()
-    : DistanceGetter() {}
+typedef BFSCachedDistance::VecUInt32 VecUInt32;
+typedef BFSCachedDistance::MatrixUInt32 MatrixUInt32;
+typedef BFSCachedDistance::MatrixRef MatrixRef;
+
+namespace {
+    /// \brief The graphs whose distances were computed last, identified by
+    /// their adjacency lists (so that a freed graph is never mistaken for
+    /// another one allocated in the same address).
+    struct DistanceMatrixCache {
+        static const uint32_t MaxEntries = 16;
+
+        struct Entry {
+            MatrixUInt32 mAdjacency;
+            MatrixRef mDistance;
+        };
+
+        std::mutex mMutex;
+        std::deque<Entry> mEntries;
+    };
+}
+
+static DistanceMatrixCache& GetDistanceMatrixCache() {
+    // Leaked, so that it outlives the allocators of other static objects.
+    static DistanceMatrixCache* cache = new DistanceMatrixCache();
+    return *cache;
+}
+
+static MatrixUInt32 GetAdjacency(Graph::Ref g) {
+    MatrixUInt32 adjacency(g->size());
 
-void BFSCachedDistance::cacheDistanceFrom(uint32_t u) {
-    auto& distance = mDistance[u];
-    distance.assign(mG->size(), _undef);
+    for (uint32_t u = 0, e = g->size(); u < e; ++u) {
+        auto adj = g->adj(u);
+        adjacency[u].assign(adj.begin(), adj.end());
+    }
+
+    return adjacency;
+}
+
+static void ComputeDistanceFrom(const MatrixUInt32& adjacency, uint32_t u,
+                                VecUInt32& distance) {
+    distance.assign(adjacency.size(), _undef);
 
     std::queue<uint32_t> q;
-    std::vector<bool> visited(mG->size(), false);
 
     q.push(u);
-    visited[u] = true;
     distance[u] = 0;
 
     while (!q.empty()) {
         uint32_t u = q.front();
         q.pop();
 
-        for (uint32_t v : mG->adj(u)) {
-            if (!visited[v]) {
-                visited[v] = true;
+        for (uint32_t v : adjacency[u]) {
+            if (distance[v] == _undef) {
                 distance[v] = distance[u] + 1;
                 q.push(v);
             }
@@ -32,15 +66,41 @@ void BFSCachedDistance::cacheDistanceFrom(uint32_t u) {
     }
 }
 
+BFSCachedDistance::BFSCachedDistance()
+    : DistanceGetter() {}
+
 void BFSCachedDistance::initImpl() {
-    mDistance.assign(mG->size(), VecUInt32());
+    mDistance = GetDistanceMatrix(mG);
 }
 
 uint32_t BFSCachedDistance::getImpl(uint32_t u, uint32_t v) {
-    if (!mDistance[u].empty()) return mDistance[u][v];
-    if (!mDistance[v].empty()) return mDistance[v][u];
-    cacheDistanceFrom(u);
-    return mDistance[u][v];
+    return (*mDistance)[u][v];
+}
+
+MatrixRef BFSCachedDistance::GetDistanceMatrix(Graph::Ref g) {
+    auto& cache = GetDistanceMatrixCache();
+    auto adjacency = GetAdjacency(g);
+
+    std::lock_guard<std::mutex> lock(cache.mMutex);
+
+    for (auto& entry : cache.mEntries) {
+        if (entry.mAdjacency == adjacency) {
+            return entry.mDistance;
+        }
+    }
+
+    std::shared_ptr<MatrixUInt32> distance(new MatrixUInt32(adjacency.size()));
+
+    for (uint32_t u = 0, e = adjacency.size(); u < e; ++u) {
+        ComputeDistanceFrom(adjacency, u, (*distance)[u]);
+    }
+
+    if (cache.mEntries.size() == DistanceMatrixCache::MaxEntries) {
+        cache.mEntries.pop_front();
+    }
+
+    cache.mEntries.push_back({ std::move(adjacency), distance });
+    return distance;
 }
 
 BFSCachedDistance::uRef BFSCachedDistance::Create() {
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 
 using namespace efd;
 
@@ -10,12 +11,10 @@ using namespace efd;
 Graph::Graph(Kind k, uint32_t n, Type ty) : mK(k), mN(n), mTy(ty) {
     mSuccessors.assign(n, std::set<uint32_t>());
     mPredecessors.assign(n, std::set<uint32_t>());
+    mAdjacency.assign(n * n, false);
 }
 
-Graph::Graph(uint32_t n, Type ty) : mK(K_GRAPH), mN(n), mTy(ty) {
-    mSuccessors.assign(n, std::set<uint32_t>());
-    mPredecessors.assign(n, std::set<uint32_t>());
-}
+Graph::Graph(uint32_t n, Type ty) : Graph(K_GRAPH, n, ty) {}
 
 std::string Graph::vertexToString(uint32_t i) const {
     return std::to_string(i);
@@ -56,21 +55,28 @@ std::set<uint32_t> Graph::adj(uint32_t i) const {
     return adj;
 }
 
-bool Graph::hasEdge(uint32_t i, uint32_t j) {
-    std::set<uint32_t>& succ = this->succ(i);
-    return succ.find(j) != succ.end();
+bool Graph::hasEdge(uint32_t i, uint32_t j) const {
+    return mAdjacency[i * mN + j];
 }
 
 void Graph::putEdge(uint32_t i, uint32_t j) {
     mSuccessors[i].insert(j);
     mPredecessors[j].insert(i);
+    mAdjacency[i * mN + j] = true;
 
     if (!isDirectedGraph()) {
         mSuccessors[j].insert(i);
         mPredecessors[i].insert(j);
+        mAdjacency[j * mN + i] = true;
     }
 }
 
+void Graph::clearEdges(uint32_t i) {
+    mSuccessors[i].clear();
+    mPredecessors[i].clear();
+    std::fill(mAdjacency.begin() + i * mN, mAdjacency.begin() + (i + 1) * mN, false);
+}
+
 bool Graph::isWeighted() const {
     return mK == K_WEIGHTED ||
         mK == K_ARCH;
@@ -0,0 +1,59 @@
+#include "enfield/Support/MappedFile.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+efd::MappedFile::MappedFile(const char* data, uint64_t size) : mData(data), mSize(size) {
+}
+
+efd::MappedFile::~MappedFile() {
+    if (mSize > 0) munmap(const_cast<char*>(mData), mSize);
+}
+
+const char* efd::MappedFile::begin() const {
+    return mData;
+}
+
+const char* efd::MappedFile::end() const {
+    return mData + mSize;
+}
+
+uint64_t efd::MappedFile::size() const {
+    return mSize;
+}
+
+efd::MappedFile::uRef efd::MappedFile::Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || S_ISDIR(st.st_mode)) {
+        int err = S_ISDIR(st.st_mode) ? EISDIR : errno;
+        close(fd);
+        errno = err;
+        return nullptr;
+    }
+
+    // Empty files can't be mapped.
+    if (st.st_size == 0) {
+        close(fd);
+        return uRef(new MappedFile(nullptr, 0));
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        errno = err;
+        return nullptr;
+    }
+
+    // The scanner reads it front to back, only once.
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    return uRef(new MappedFile(static_cast<const char*>(data), st.st_size));
+}
@@ -0,0 +1,186 @@
+#include "enfield/Support/PoolAllocator.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+using namespace efd;
+
+namespace {
+    struct FreeChunk {
+        FreeChunk* mNext;
+    };
+
+    const std::size_t NumberOfClasses = PoolAllocator::MaxObjectSize / PoolAllocator::Granularity;
+
+    struct ThreadPools {
+        FreeChunk* mFree[NumberOfClasses];
+        char* mCur;
+        char* mEnd;
+        // The thread registered its \em PoolsReaper.
+        bool mRegistered;
+        // The thread is exiting (its \em PoolsReaper already ran).
+        bool mDead;
+    };
+
+    /// \brief Chunks handed back by the threads that exited.
+    struct GlobalPools {
+        std::mutex mMutex;
+        std::atomic<FreeChunk*> mFree[NumberOfClasses];
+    };
+
+    /// \brief Gives the memory held by the current thread to the global pools,
+    /// when the thread exits.
+    struct PoolsReaper {
+        ~PoolsReaper();
+    };
+
+    thread_local ThreadPools Pools = { {}, nullptr, nullptr, false, false };
+    thread_local PoolsReaper Reaper;
+    std::atomic<uint64_t> ReservedBytes(0);
+}
+
+static std::size_t GetSizeClass(std::size_t size) {
+    return (size + PoolAllocator::Granularity - 1) / PoolAllocator::Granularity - 1;
+}
+
+static GlobalPools& GetGlobalPools() {
+    // Never destroyed: nodes may still be freed by other static destructors.
+    static GlobalPools* Global = new GlobalPools();
+    return *Global;
+}
+
+/// \brief Prepends the list [\p first, \p last] to the global list of \p cls.
+///
+/// The global mutex must be held.
+static void PushGlobal(std::size_t cls, FreeChunk* first, FreeChunk* last) {
+    auto& global = GetGlobalPools();
+    last->mNext = global.mFree[cls].load(std::memory_order_relaxed);
+    global.mFree[cls].store(first, std::memory_order_relaxed);
+}
+
+/// \brief Takes the whole global list of \p cls (or nullptr if it is empty).
+static FreeChunk* StealGlobal(std::size_t cls) {
+    auto& global = GetGlobalPools();
+    // Avoids locking when there is nothing to steal.
+    if (global.mFree[cls].load(std::memory_order_relaxed) == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(global.mMutex);
+    return global.mFree[cls].exchange(nullptr, std::memory_order_relaxed);
+}
+
+/// \brief Takes one chunk of the global list of \p cls (or nullptr if it is empty).
+static FreeChunk* PopGlobal(std::size_t cls) {
+    auto& global = GetGlobalPools();
+    std::lock_guard<std::mutex> lock(global.mMutex);
+
+    auto chunk = global.mFree[cls].load(std::memory_order_relaxed);
+    if (chunk != nullptr) global.mFree[cls].store(chunk->mNext, std::memory_order_relaxed);
+    return chunk;
+}
+
+PoolsReaper::~PoolsReaper() {
+    auto& pools = Pools;
+    std::lock_guard<std::mutex> lock(GetGlobalPools().mMutex);
+
+    for (std::size_t cls = 0; cls < NumberOfClasses; ++cls) {
+        if (auto first = pools.mFree[cls]) {
+            auto last = first;
+            while (last->mNext != nullptr) last = last->mNext;
+            PushGlobal(cls, first, last);
+            pools.mFree[cls] = nullptr;
+        }
+    }
+
+    // Splits the tail of the current slab into the biggest chunks possible.
+    while (pools.mCur != nullptr &&
+           (std::size_t)(pools.mEnd - pools.mCur) >= PoolAllocator::Granularity) {
+        std::size_t size = pools.mEnd - pools.mCur;
+        if (size > PoolAllocator::MaxObjectSize) size = PoolAllocator::MaxObjectSize;
+        size -= size % PoolAllocator::Granularity;
+
+        auto chunk = reinterpret_cast<FreeChunk*>(pools.mCur);
+        PushGlobal(GetSizeClass(size), chunk, chunk);
+        pools.mCur += size;
+    }
+
+    pools.mCur = pools.mEnd = nullptr;
+    pools.mDead = true;
+}
+
+/// \brief Returns the pools of the current thread, making sure they are handed
+/// back when the thread exits. Returns nullptr if the thread is exiting.
+static ThreadPools* GetThreadPools() {
+    auto& pools = Pools;
+
+    if (!pools.mRegistered) {
+        pools.mRegistered = true;
+        // Using it registers its destructor.
+        (void) &Reaper;
+    }
+
+    return pools.mDead ? nullptr : &pools;
+}
+
+void* PoolAllocator::Allocate(std::size_t size) {
+    if (size == 0) size = 1;
+    if (size > MaxObjectSize) return ::operator new(size);
+
+    auto cls = GetSizeClass(size);
+    std::size_t chunkSize = (cls + 1) * Granularity;
+    auto pools = GetThreadPools();
+
+    if (pools == nullptr) {
+        // The thread is exiting. Only the global pools can be used.
+        if (auto chunk = PopGlobal(cls)) return chunk;
+
+        ReservedBytes += chunkSize;
+        return ::operator new(chunkSize);
+    }
+
+    if (pools->mFree[cls] == nullptr) pools->mFree[cls] = StealGlobal(cls);
+
+    if (auto chunk = pools->mFree[cls]) {
+        pools->mFree[cls] = chunk->mNext;
+        return chunk;
+    }
+
+    if (pools->mCur == nullptr || (std::size_t)(pools->mEnd - pools->mCur) < chunkSize) {
+        // The tail of the current slab is lost. It is, at most,
+        // 'MaxObjectSize' bytes.
+        pools->mCur = static_cast<char*>(::operator new(SlabSize));
+        pools->mEnd = pools->mCur + SlabSize;
+        ReservedBytes += SlabSize;
+    }
+
+    void* ptr = pools->mCur;
+    pools->mCur += chunkSize;
+    return ptr;
+}
+
+void PoolAllocator::Deallocate(void* ptr, std::size_t size) {
+    if (ptr == nullptr) return;
+    if (size == 0) size = 1;
+
+    if (size > MaxObjectSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    auto cls = GetSizeClass(size);
+    auto chunk = static_cast<FreeChunk*>(ptr);
+    auto pools = GetThreadPools();
+
+    if (pools == nullptr) {
+        std::lock_guard<std::mutex> lock(GetGlobalPools().mMutex);
+        PushGlobal(cls, chunk, chunk);
+        return;
+    }
+
+    chunk->mNext = pools->mFree[cls];
+    pools->mFree[cls] = chunk;
+}
+
+uint64_t PoolAllocator::GetReservedBytes() {
+    return ReservedBytes;
+}
@@ -1,8 +1,10 @@
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 
+#include <cstdlib>
 #include <memory>
 #include <map>
+#include <mutex>
 
 namespace efd {
     class StatsPool {
@@ -10,31 +12,69 @@ namespace efd {
             typedef std::map<std::string, StatBase*> StatMap;
 
             StatMap mMap;
+            std::vector<StatBase*> mStats;
+            mutable std::mutex mMutex;
 
         public:
-            void addStat(StatBase* stat);
+            /// \brief Registers \p stat, returning its index.
+            uint32_t addStat(StatBase* stat);
             bool hasStat(std::string name);
+            /// \brief Returns the stat named \p name, or nullptr.
+            StatBase* getStat(std::string name) const;
+            uint32_t size() const;
 
-            void print(std::ostream& out);
+            /// \brief Returns the stats sorted by name.
+            std::vector<StatBase*> getStats() const;
     };
 }
 
-void efd::StatsPool::addStat(StatBase* stat) {
-    EfdAbortIf(hasStat(stat->getName()),
+static thread_local efd::StatScope::Ref CurrentScope = nullptr;
+
+uint32_t efd::StatsPool::addStat(StatBase* stat) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    EfdAbortIf(mMap.find(stat->getName()) != mMap.end(),
                "Stat with the same name already defined: `" << stat->getName() << "`.");
 
     mMap[stat->getName()] = stat;
+    mStats.push_back(stat);
+    return mStats.size() - 1;
 }
 
 bool efd::StatsPool::hasStat(std::string name) {
+    std::lock_guard<std::mutex> lock(mMutex);
     return mMap.find(name) != mMap.end();
 }
 
-void efd::StatsPool::print(std::ostream& out) {
-    for (auto pair : mMap) {
-        if (!pair.second->isZero())
-            pair.second->print(out);
+efd::StatBase* efd::StatsPool::getStat(std::string name) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mMap.find(name);
+    return (it != mMap.end()) ? it->second : nullptr;
+}
+
+uint32_t efd::StatsPool::size() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats.size();
+}
+
+std::vector<efd::StatBase*> efd::StatsPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::vector<StatBase*> stats;
+    for (auto& pair : mMap) stats.push_back(pair.second);
+    return stats;
+}
+
+/// \brief Quotes \p field, if it can't be written as a CSV field as is.
+static std::string QuoteCsv(const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) return field;
+
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') quoted += '"';
+        quoted += c;
     }
+    return quoted + "\"";
 }
 
 static std::shared_ptr<efd::StatsPool> getPool() {
@@ -42,10 +82,17 @@ static std::shared_ptr<efd::StatsPool> getPool() {
     return Pool;
 }
 
+// ----------------------------- StatBase -------------------------------
 efd::StatBase::StatBase(std::string name, std::string description) :
-    mName(name), mDescription(description) {
+    mGlobal(0), mName(name), mDescription(description) {
     mPool = getPool();
-    mPool->addStat(this);
+    mId = mPool->addStat(this);
+}
+
+std::atomic<double>& efd::StatBase::getSlot() const {
+    auto scope = CurrentScope;
+    if (scope != nullptr && scope->hasSlot(mId)) return scope->getSlot(mId);
+    return mGlobal;
 }
 
 void efd::StatBase::print(std::ostream& out) {
@@ -60,11 +107,112 @@ std::string efd::StatBase::getDescription() const {
     return mDescription;
 }
 
-void efd::PrintStats(std::ostream& out) {
-    auto Pool = getPool();
+uint32_t efd::StatBase::getId() const {
+    return mId;
+}
+
+// ----------------------------- StatScope -------------------------------
+efd::StatScope::StatScope() : mValues(getPool()->size()) {
+    for (auto& value : mValues) value.store(0);
+}
+
+bool efd::StatScope::hasSlot(uint32_t id) const {
+    return id < mValues.size();
+}
+
+std::atomic<double>& efd::StatScope::getSlot(uint32_t id) {
+    return mValues[id];
+}
+
+/// \brief Atomically adds \p value to \p slot.
+static void AddToSlot(std::atomic<double>& slot, double value) {
+    double old = slot.load();
+    while (!slot.compare_exchange_weak(old, old + value));
+}
+
+void efd::StatScope::mergeIntoCurrent() {
+    for (auto stat : getPool()->getStats()) {
+        uint32_t id = stat->getId();
+        if (!hasSlot(id)) continue;
+
+        double value = mValues[id].load();
+        if (value == 0) continue;
+
+        AddToSlot(stat->getSlot(), value);
+    }
+}
+
+efd::StatScope::Ref efd::StatScope::Current() {
+    return CurrentScope;
+}
 
+efd::StatScope::Binding::Binding(StatScope::Ref scope) : mPrevious(CurrentScope) {
+    CurrentScope = scope;
+}
+
+efd::StatScope::Binding::~Binding() {
+    CurrentScope = mPrevious;
+}
+
+// ----------------------------- Functions -------------------------------
+efd::StatRecords efd::CollectStats(bool withZero) {
+    StatRecords records;
+
+    for (auto stat : getPool()->getStats()) {
+        if (withZero || !stat->isZero()) {
+            records.push_back(StatRecord {
+                    stat->getName(), stat->getDescription(), stat->valueToString() });
+        }
+    }
+
+    return records;
+}
+
+void efd::RestoreStats(const StatRecords& records) {
+    auto pool = getPool();
+
+    for (auto& record : records) {
+        auto stat = pool->getStat(record.mName);
+        if (stat == nullptr) continue;
+
+        char* end = nullptr;
+        double value = std::strtod(record.mValue.c_str(), &end);
+        if (end == record.mValue.c_str()) continue;
+
+        AddToSlot(stat->getSlot(), value);
+    }
+}
+
+void efd::PrintStats(std::ostream& out) {
     out << std::endl;
     out << " ==-------------- Stats --------------==" << std::endl;
-    Pool->print(out);
+
+    for (auto& record : CollectStats()) {
+        out << record.mValue << "::" << record.mName << "::" << record.mDescription << std::endl;
+    }
+
     out << " ==-----------------------------------==" << std::endl;
 }
+
+void efd::PrintStatsJson(const StatRecords& records, std::ostream& out) {
+    out << "{";
+
+    for (uint32_t i = 0, e = records.size(); i < e; ++i) {
+        if (i > 0) out << ", ";
+        auto& value = records[i].mValue;
+        bool isNumber = value.find("nan") == std::string::npos &&
+                        value.find("inf") == std::string::npos;
+        out << "\"" << records[i].mName << "\": " << (isNumber ? value : "null");
+    }
+
+    out << "}";
+}
+
+void efd::PrintStatsCsv(const StatRecords& records, std::ostream& out,
+                        const std::string& label, bool header) {
+    if (header) out << "label,name,value" << std::endl;
+
+    for (auto& record : records) {
+        out << QuoteCsv(label) << "," << record.mName << "," << record.mValue << std::endl;
+    }
+}
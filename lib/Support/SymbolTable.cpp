@@ -0,0 +1,63 @@
+#include "enfield/Support/SymbolTable.h"
+
+#include <cstring>
+
+/// \brief FNV-1a hash of the characters in [\p begin, \p end).
+static uint64_t Hash(const char* begin, const char* end) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; begin != end; ++begin) {
+        hash ^= static_cast<unsigned char>(*begin);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+efd::SymbolTable::SymbolTable() : mSlots(64, nullptr) {
+}
+
+void efd::SymbolTable::grow() {
+    std::vector<Symbol> slots(mSlots.size() * 2, nullptr);
+    uint64_t mask = slots.size() - 1;
+
+    for (auto symbol : mSlots) {
+        if (symbol == nullptr) continue;
+
+        const char* data = symbol->data();
+        uint64_t i = Hash(data, data + symbol->size()) & mask;
+        while (slots[i] != nullptr) i = (i + 1) & mask;
+        slots[i] = symbol;
+    }
+
+    mSlots.swap(slots);
+}
+
+efd::SymbolTable::Symbol efd::SymbolTable::intern(const char* begin, const char* end) {
+    uint64_t size = end - begin;
+    uint64_t mask = mSlots.size() - 1;
+    uint64_t i = Hash(begin, end) & mask;
+
+    // Open addressing with linear probing.
+    for (; mSlots[i] != nullptr; i = (i + 1) & mask) {
+        auto symbol = mSlots[i];
+        if (symbol->size() == size && std::memcmp(symbol->data(), begin, size) == 0) {
+            return symbol;
+        }
+    }
+
+    mStrings.emplace_back(begin, end);
+    mSlots[i] = &mStrings.back();
+
+    // Keeping the load factor below 1/2.
+    if (2 * mStrings.size() > mSlots.size()) grow();
+    return &mStrings.back();
+}
+
+efd::SymbolTable::Symbol efd::SymbolTable::intern(const std::string& str) {
+    return intern(str.data(), str.data() + str.size());
+}
+
+uint32_t efd::SymbolTable::size() const {
+    return mStrings.size();
+}
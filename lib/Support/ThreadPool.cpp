@@ -0,0 +1,72 @@
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/Defs.h"
+
+using namespace efd;
+
+ThreadPool::ThreadPool(uint32_t threads) : mRunning(0), mStop(false) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (uint32_t i = 0; i < threads; ++i) {
+        mWorkers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mTaskCV.notify_all();
+    for (auto& worker : mWorkers) worker.join();
+}
+
+void ThreadPool::work() {
+    while (true) {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskCV.wait(lock, [this] { return mStop || !mTasks.empty(); });
+
+            // Only leaves when there is nothing else to be done.
+            if (mTasks.empty()) return;
+
+            task = std::move(mTasks.front());
+            mTasks.pop();
+            ++mRunning;
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            --mRunning;
+            if (mRunning == 0 && mTasks.empty()) mIdleCV.notify_all();
+        }
+    }
+}
+
+uint32_t ThreadPool::size() const {
+    return mWorkers.size();
+}
+
+void ThreadPool::enqueue(Task task) {
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        EfdAbortIf(mStop, "Enqueueing a task in a stopped `ThreadPool`.");
+        mTasks.push(std::move(task));
+    }
+
+    mTaskCV.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdleCV.wait(lock, [this] { return mRunning == 0 && mTasks.empty(); });
+}
+
+ThreadPool::uRef ThreadPool::Create(uint32_t threads) {
+    return uRef(new ThreadPool(threads));
+}
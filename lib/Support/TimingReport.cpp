@@ -0,0 +1,181 @@
+#include "enfield/Support/TimingReport.h"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#include <sys/resource.h>
+
+using namespace efd;
+
+static std::atomic<bool> Enabled(false);
+static std::mutex EntriesMutex;
+static std::vector<TimingReport::Entry> Entries { { "", 0, 0, 0, 0, {} } };
+
+// The region currently open in each thread. Threads start at the root.
+static thread_local uint32_t Current = 0;
+
+static std::string EscapeJson(const std::string& str) {
+    std::string escaped;
+
+    for (char c : str) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+static void PrintEntry(std::ostream& out,
+                       const std::vector<TimingReport::Entry>& entries,
+                       uint32_t id, uint32_t depth, double total) {
+    auto& entry = entries[id];
+    double ms = (double) entry.mNanoseconds / 1000000.0;
+
+    out << std::setw(12) << ms
+        << std::setw(8) << ((total > 0) ? 100.0 * ms / total : 0.0) << "%"
+        << std::setw(10) << entry.mCalls
+        << std::setw(12) << entry.mPeakRSSDelta
+        << "  " << std::string(depth * 2, ' ') << entry.mName << std::endl;
+
+    for (auto child : entry.mChildren) {
+        PrintEntry(out, entries, child, depth + 1, total);
+    }
+}
+
+static void PrintEntryJson(std::ostream& out,
+                           const std::vector<TimingReport::Entry>& entries,
+                           uint32_t id) {
+    auto& entry = entries[id];
+
+    out << "{\"name\": \"" << EscapeJson(entry.mName) << "\""
+        << ", \"calls\": " << entry.mCalls
+        << ", \"ms\": " << (double) entry.mNanoseconds / 1000000.0
+        << ", \"peakRSSDeltaKB\": " << entry.mPeakRSSDelta
+        << ", \"children\": [";
+
+    for (uint32_t i = 0, e = entry.mChildren.size(); i < e; ++i) {
+        if (i > 0) out << ", ";
+        PrintEntryJson(out, entries, entry.mChildren[i]);
+    }
+
+    out << "]}";
+}
+
+void TimingReport::Enable(bool enabled) {
+    Enabled = enabled;
+}
+
+bool TimingReport::IsEnabled() {
+    return Enabled;
+}
+
+void TimingReport::Clear() {
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+    Entries.resize(1);
+    Entries[0].mChildren.clear();
+    Current = 0;
+}
+
+uint32_t TimingReport::Enter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+
+    uint32_t parent = (Current < Entries.size()) ? Current : 0;
+
+    for (auto child : Entries[parent].mChildren) {
+        if (Entries[child].mName == name) {
+            return Current = child;
+        }
+    }
+
+    uint32_t id = Entries.size();
+    Entries.push_back(Entry { name, parent, 0, 0, 0, {} });
+    Entries[parent].mChildren.push_back(id);
+    return Current = id;
+}
+
+void TimingReport::Exit(uint32_t id, uint64_t nanoseconds, uint64_t peakRSSDelta) {
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+
+    // The report was cleared while this region was open.
+    if (id >= Entries.size()) {
+        Current = 0;
+        return;
+    }
+
+    auto& entry = Entries[id];
+    entry.mCalls += 1;
+    entry.mNanoseconds += nanoseconds;
+    entry.mPeakRSSDelta += peakRSSDelta;
+    Current = entry.mParent;
+}
+
+std::vector<TimingReport::Entry> TimingReport::GetEntries() {
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+    return Entries;
+}
+
+void TimingReport::Print(std::ostream& out) {
+    auto entries = GetEntries();
+
+    double total = 0;
+    for (auto child : entries[0].mChildren) {
+        total += (double) entries[child].mNanoseconds / 1000000.0;
+    }
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "===" << std::string(60, '-') << "===" << std::endl;
+    ss << "  Timing report (peak RSS: " << GetPeakRSS() << " KB)" << std::endl;
+    ss << "===" << std::string(60, '-') << "===" << std::endl;
+    ss << std::setw(12) << "Wall (ms)"
+       << std::setw(9) << "%"
+       << std::setw(10) << "Calls"
+       << std::setw(12) << "RSS+ (KB)"
+       << "  Name" << std::endl;
+
+    ss << std::setprecision(1);
+    for (auto child : entries[0].mChildren) {
+        PrintEntry(ss, entries, child, 0, total);
+    }
+
+    out << ss.str();
+}
+
+void TimingReport::PrintJson(std::ostream& out) {
+    auto entries = GetEntries();
+
+    out << "{\"peakRSSKB\": " << GetPeakRSS() << ", \"regions\": [";
+
+    for (uint32_t i = 0, e = entries[0].mChildren.size(); i < e; ++i) {
+        if (i > 0) out << ", ";
+        PrintEntryJson(out, entries, entries[0].mChildren[i]);
+    }
+
+    out << "]}" << std::endl;
+}
+
+TimingScope::TimingScope(const std::string& name) : mActive(TimingReport::IsEnabled()) {
+    if (mActive) {
+        mId = TimingReport::Enter(name);
+        mPeakRSS = GetPeakRSS();
+        mStart = std::chrono::steady_clock::now();
+    }
+}
+
+TimingScope::~TimingScope() {
+    if (mActive) {
+        auto end = std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mStart).count();
+        auto peakRSS = GetPeakRSS();
+        TimingReport::Exit(mId, ns, (peakRSS > mPeakRSS) ? peakRSS - mPeakRSS : 0);
+    }
+}
+
+uint64_t efd::GetPeakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    // Linux reports it in kilobytes.
+    return usage.ru_maxrss;
+}
@@ -1,7 +1,12 @@
 #include "enfield/Support/TokenSwapFinder.h"
+#include "enfield/Support/Trace.h"
+#include "enfield/Support/Stats.h"
 
 using namespace efd;
 
+static Stat<uint32_t> TokenSwapCalls
+("TokenSwapCalls", "Number of token swap problems solved.");
+
 TokenSwapFinder::TokenSwapFinder() : mG(nullptr) {}
 
 void TokenSwapFinder::checkGraphSet() {
@@ -15,5 +20,10 @@ void TokenSwapFinder::setGraph(Graph::Ref graph) {
 
 SwapSeq TokenSwapFinder::find(const InverseMap& from, const InverseMap& to) {
     checkGraphSet();
-    return findImpl(from, to);
+    TokenSwapCalls += 1;
+
+    EFD_TRACE_SCOPE(trace, "TokenSwap", "tokenswap");
+    auto swaps = findImpl(from, to);
+    EFD_TRACE_ARG(trace, "swaps", swaps.size());
+    return swaps;
 }
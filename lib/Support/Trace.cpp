@@ -0,0 +1,118 @@
+#include "enfield/Support/Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+using namespace efd;
+
+static std::atomic<bool> Enabled(false);
+static std::mutex EventsMutex;
+static std::vector<Trace::Event> Events;
+
+static const std::chrono::steady_clock::time_point Origin = std::chrono::steady_clock::now();
+
+static std::atomic<uint32_t> NextThread(0);
+static thread_local uint32_t ThreadId = NextThread++;
+
+static std::string EscapeJson(const std::string& str) {
+    std::string escaped;
+
+    for (char c : str) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+void Trace::Enable(bool enabled) {
+    Enabled = enabled;
+}
+
+bool Trace::IsEnabled() {
+    return Enabled;
+}
+
+void Trace::Clear() {
+    std::lock_guard<std::mutex> lock(EventsMutex);
+    Events.clear();
+}
+
+uint64_t Trace::Now() {
+    auto elapsed = std::chrono::steady_clock::now() - Origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void Trace::Record(const std::string& name, const char* category,
+                   uint64_t begin, uint64_t end, Args args) {
+    Event event { name, category, ThreadId, begin, end - begin, std::move(args) };
+
+    std::lock_guard<std::mutex> lock(EventsMutex);
+    Events.push_back(std::move(event));
+}
+
+std::vector<Trace::Event> Trace::GetEvents() {
+    std::lock_guard<std::mutex> lock(EventsMutex);
+    return Events;
+}
+
+void Trace::Write(std::ostream& out) {
+    auto events = GetEvents();
+
+    std::ostringstream ss;
+    ss << "{\"traceEvents\": [";
+
+    for (uint32_t i = 0, e = events.size(); i < e; ++i) {
+        auto& event = events[i];
+
+        if (i > 0) ss << ",";
+        ss << std::endl
+           << "{\"name\": \"" << EscapeJson(event.mName) << "\""
+           << ", \"cat\": \"" << event.mCategory << "\""
+           << ", \"ph\": \"X\", \"pid\": 1"
+           << ", \"tid\": " << event.mThread
+           << ", \"ts\": " << event.mBegin
+           << ", \"dur\": " << event.mDuration
+           << ", \"args\": {";
+
+        for (uint32_t j = 0, f = event.mArgs.size(); j < f; ++j) {
+            if (j > 0) ss << ", ";
+            ss << "\"" << EscapeJson(event.mArgs[j].first) << "\": " << event.mArgs[j].second;
+        }
+
+        ss << "}}";
+    }
+
+    ss << std::endl << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+    out << ss.str();
+}
+
+TraceScope::TraceScope(const std::string& name, const char* category)
+    : mActive(Trace::IsEnabled()), mCategory(category), mBegin(0) {
+    if (mActive) {
+        mName = name;
+        mBegin = Trace::Now();
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (mActive) record();
+}
+
+void TraceScope::record() {
+    Trace::Record(mName, mCategory, mBegin, Trace::Now(), std::move(mArgs));
+    mArgs.clear();
+}
+
+void TraceScope::arg(const std::string& key, int64_t val) {
+    if (mActive) mArgs.push_back(std::make_pair(key, val));
+}
+
+void TraceScope::restart() {
+    if (mActive) {
+        record();
+        mBegin = Trace::Now();
+    }
+}
@@ -6,9 +6,6 @@ using namespace bmt;
 
 #include <queue>
 
-static Opt<uint32_t> MaxMapSeqCandidates
-("-bmt-max-mapseq", "Select the best N mapping sequences from phase 2.", 1, false);
-
 // --------------------- SeqNCandidatesGenerator ------------------------
 void SeqNCandidatesGenerator::initImpl() {
     mIt = mMod->stmt_begin();
@@ -138,7 +135,6 @@ Vector BestNMSSelector::select(const TIMatrix& mem) {
     typedef std::pair<uint32_t, uint32_t> UIntPair;
 
     Vector selected;
-    uint32_t maxMapSeq = MaxMapSeqCandidates.getVal();
     uint32_t lastLayer = mem.size() - 1;
     std::priority_queue<UIntPair,
                         std::vector<UIntPair>,
@@ -149,7 +145,7 @@ Vector BestNMSSelector::select(const TIMatrix& mem) {
         pQueue.push(std::make_pair(info.mappingCost + info.swapEstimatedCost, i));
     }
 
-    while (!pQueue.empty() && selected.size() < maxMapSeq) {
+    while (!pQueue.empty() && selected.size() < mMaxSelected) {
         selected.push_back(pQueue.top().second);
         pQueue.pop();
     }
@@ -14,8 +14,8 @@ void CircuitCandidatesGenerator::advanceXbitId(uint32_t i) {
     ++mReached[mIt.get(i)];
 }
 
-void CircuitCandidatesGenerator::advanceCNode(CircuitGraph::CircuitNode::Ref cnode) {
-    for (auto id : cnode->getXbitsId()) {
+void CircuitCandidatesGenerator::advanceCNode(CircuitGraph::CircuitNode cnode) {
+    for (auto id : cnode.getXbitsId()) {
         advanceXbitId(id);
     }
 }
@@ -32,7 +32,7 @@ void CircuitCandidatesGenerator::initImpl() {
 
 bool CircuitCandidatesGenerator::finishedImpl() {
     for (uint32_t i = 0; i < mXbitSize; ++i)
-        if (!mIt[i]->isOutputNode())
+        if (!mIt[i].isOutputNode())
             return false;
     return true;
 }
@@ -42,11 +42,11 @@ std::vector<Node::Ref> CircuitCandidatesGenerator::generateImpl() {
 
     for (uint32_t i = 0; i < mXbitSize; ++i) {
         auto cnode = mIt[i];
-        auto node = cnode->node();
+        auto node = cnode.node();
 
-        if (mReached[node] == cnode->numberOfXbits()) {
+        if (cnode.isGateNode() && mReached[node] == cnode.numberOfXbits()) {
             nodeCandidateSet.insert(node);
-            mNCNMap[node] = cnode.get();
+            mNCNMap[node] = cnode;
         }
     }
 
@@ -9,20 +9,14 @@
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/TimingReport.h"
+#include "enfield/Support/Trace.h"
 
 #include <algorithm>
 
 using namespace efd;
 using namespace bmt;
 
-static Opt<uint32_t> MaxChildren
-("-bmt-max-children", "Limits the max number of children per partial solution.",
- std::numeric_limits<uint32_t>::max(), false);
-
-static Opt<uint32_t> MaxPartialSolutions
-("-bmt-max-partial", "Limits the max number of partial solutions per step.",
- std::numeric_limits<uint32_t>::max(), false);
-
 Stat<double> Phase1Time
 ("Phase1Time", "Time spent by the 1st phase of BMT allocators.");
 
@@ -35,6 +29,12 @@ Stat<double> Phase3Time
 Stat<uint32_t> Partitions
 ("BMTPartitions", "Number of partitions split by *BMT allocators.");
 
+static Stat<uint32_t> CandidatesGenerated
+("BMTCandidatesGenerated", "Number of mapping candidates generated by BMT's 1st phase.");
+
+static Stat<uint32_t> CandidatesPruned
+("BMTCandidatesPruned", "Number of mapping candidates discarded by BMT's 1st phase.");
+
 bool efd::bmt::operator>(const NodeCandidate& lhs, const NodeCandidate& rhs) {
     if (lhs.mWeight != rhs.mWeight) return lhs.mWeight > rhs.mWeight;
     return lhs.mNode > rhs.mNode;
@@ -124,6 +124,7 @@ BoundedMappingTreeQAllocator::extendCandidates(Dep& dep,
     uint32_t a = dep.mFrom, b = dep.mTo;
     uint32_t childrenBound = (ignoreChildrenLimit) ? _undef : mMaxChildren;
     MCandidateVector newCandidates;
+    uint32_t generated = 0;
 
     for (auto cand : candidates) {
         PairVector pairV;
@@ -173,9 +174,15 @@ BoundedMappingTreeQAllocator::extendCandidates(Dep& dep,
 
         MCandidateVector selected = mChildrenCSelector->select(childrenBound, localCandidates);
         newCandidates.insert(newCandidates.end(), selected.begin(), selected.end());
+        generated += localCandidates.size();
     }
 
-    return mPartialSolutionCSelector->select(mMaxPartial, newCandidates);
+    auto selected = mPartialSolutionCSelector->select(mMaxPartial, newCandidates);
+
+    CandidatesGenerated += generated;
+    CandidatesPruned += generated - selected.size();
+
+    return selected;
 }
 
 NCPQueue
@@ -235,6 +242,8 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
 
     bool first = true;
 
+    EFD_TRACE_SCOPE(trace, "Partition", "bmt");
+
     while (!mNCGenerator->finished()) {
         auto nodeCandidates = mNCGenerator->generate();
         auto pQueue = rankCandidates(nodeCandidates, mapped, neighbors);
@@ -264,6 +273,11 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
         }
 
         if (newCandidates.empty()) {
+            EFD_TRACE_ARG(trace, "partition", collection.size());
+            EFD_TRACE_ARG(trace, "nodes", mPP.back().size());
+            EFD_TRACE_ARG(trace, "candidates", candidates.size());
+            EFD_TRACE_RESTART(trace);
+
             collection.push_back(candidates);
             // Reseting all data from the last partition.
             candidates = { { Mapping(mVQubits, _undef), 0 } };
@@ -282,6 +296,15 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
                 neighbors[b].insert(a);
 
                 candidates = newCandidates;
+
+                // Once cancelled, only the cheapest partial solution is extended.
+                if (isCancelled() && candidates.size() > 1) {
+                    auto cheapest = std::min_element(candidates.begin(), candidates.end(),
+                            [](const MappingCandidate& lhs, const MappingCandidate& rhs) {
+                                return lhs.cost < rhs.cost;
+                            });
+                    candidates = { *cheapest };
+                }
             }
 
             mPP.back().push_back(nCand.mNode);
@@ -289,6 +312,10 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
         }
     }
 
+    EFD_TRACE_ARG(trace, "partition", collection.size());
+    EFD_TRACE_ARG(trace, "nodes", mPP.back().size());
+    EFD_TRACE_ARG(trace, "candidates", candidates.size());
+
     collection.push_back(candidates);
 
     return collection;
@@ -379,12 +406,20 @@ BoundedMappingTreeQAllocator::phase2(const MCandidateVCollection& collection) {
         // INF << "Beginning: " << i << " of " << nofLayers << " layers." << std::endl;
 
         uint32_t jLayerSize = collection[i].size();
-        for (uint32_t j = 0; j < jLayerSize; ++j) {
+
+        EFD_TRACE_SCOPE(trace, "Layer", "bmt");
+        EFD_TRACE_ARG(trace, "layer", i);
+        EFD_TRACE_ARG(trace, "candidates", jLayerSize);
+        EFD_TRACE_ARG(trace, "parents", mem[i - 1].size());
+
+        // Once cancelled, each layer keeps a single candidate (still glued to
+        // the best of the previous one).
+        for (uint32_t j = 0; j < jLayerSize && (j == 0 || !isCancelled()); ++j) {
             // Timer jt;
             // jt.start();
 
             TracebackInfo best = { {}, _undef, _undef, 0 };
-            uint32_t kLayerSize = collection[i - 1].size();
+            uint32_t kLayerSize = mem[i - 1].size();
 
             for (uint32_t k = 0; k < kLayerSize; ++k) {
                 auto mapping = collection[i][j].m;
@@ -416,7 +451,9 @@ BoundedMappingTreeQAllocator::phase2(const MCandidateVCollection& collection) {
     Vector mapSequenceIndexes = mMSSelector->select(mem);
     MappingSwapSequence best = { {}, {}, _undef };
 
-    for (uint32_t idx : mapSequenceIndexes) {
+    for (uint32_t i = 0, e = mapSequenceIndexes.size();
+         i < e && (i == 0 || !isCancelled()); ++i) {
+        uint32_t idx = mapSequenceIndexes[i];
         // mapSCollection.push_back(tracebackPath(mem, idx));
         SwapSeqVector swapSeqCollection;
         auto seq = tracebackPath(mem, idx);
@@ -556,8 +593,9 @@ Mapping BoundedMappingTreeQAllocator::allocate(QModule::Ref qmod) {
 
     mTSFinder->setGraph(mArchGraph.get());
 
-    mMaxChildren = MaxChildren.getVal();
-    mMaxPartial = MaxPartialSolutions.getVal();
+    mMaxChildren = mOptions.bmtMaxChildren;
+    mMaxPartial = mOptions.bmtMaxPartial;
+    mMSSelector->setMaxSelected(mOptions.bmtMaxMapSeq);
 
     mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
     mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
@@ -568,17 +606,29 @@ Mapping BoundedMappingTreeQAllocator::allocate(QModule::Ref qmod) {
     if (nofDeps > 0) {
         Timer tPhase1, tPhase2, tPhase3;
 
-        tPhase1.start();
-        auto phase1Output = phase1();
-        tPhase1.stop();
+        MCandidateVCollection phase1Output;
+        MappingSwapSequence phase2Output;
 
-        tPhase2.start();
-        auto phase2Output = phase2(phase1Output);
-        tPhase2.stop();
+        {
+            TimingScope scope("Phase1");
+            tPhase1.start();
+            phase1Output = phase1();
+            tPhase1.stop();
+        }
+
+        {
+            TimingScope scope("Phase2");
+            tPhase2.start();
+            phase2Output = phase2(phase1Output);
+            tPhase2.stop();
+        }
 
-        tPhase3.start();
-        initialMapping = phase3(qmod, phase2Output);
-        tPhase3.stop();
+        {
+            TimingScope scope("Phase3");
+            tPhase3.start();
+            initialMapping = phase3(qmod, phase2Output);
+            tPhase3.stop();
+        }
 
         // Stats collection.
         Phase1Time = (double) tPhase1.getMilliseconds() / 1000.0;
@@ -148,7 +148,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
     SwapSeq swapSequence;
 
     while (true) {
-        std::set<CircuitGraph::CircuitNode::sRef> allocatable;
+        std::set<CircuitGraph::CircuitNode> allocatable;
         std::vector<Dep> dependencies;
         bool changed, redo = false;
 
@@ -159,11 +159,11 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
                 auto cnode = it[i];
                 auto node = it.get(i);
 
-                if (cnode->isGateNode()) {
+                if (cnode.isGateNode()) {
                     auto dep = depBuilder.getDeps(node);
 
-                    if (dep.size() == 0 && cnode->numberOfXbits() == reached[it.get(i)]) {
-                        for (uint32_t i : cnode->getXbitsId()) {
+                    if (dep.size() == 0 && cnode.numberOfXbits() == reached[it.get(i)]) {
+                        for (uint32_t i : cnode.getXbitsId()) {
                             if (i < mVQubits) {
                                 mapping[i] = getOrAssignPQubitFor(i, mapping, inverse);
                                 inverse[mapping[i]] = i;
@@ -186,9 +186,9 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
         // Advance the xbitNumber' cgraph and unmark them.
         for (uint32_t i = 0; i < xbitNumber; ++i) {
             auto cnode = it[i];
-            auto node = cnode->node();
+            auto node = cnode.node();
 
-            if (cnode->isGateNode() && reached[node] == cnode->numberOfXbits()) {
+            if (cnode.isGateNode() && reached[node] == cnode.numberOfXbits()) {
                 allocatable.insert(cnode);
             }
         }
@@ -196,7 +196,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
         if (allocatable.empty()) break;
 
         for (auto cnode : allocatable) {
-            auto node = cnode->node();
+            auto node = cnode.node();
             auto deps = depBuilder.getDeps(node);
             EfdAbortIf(deps.size() != 1,
                        "Can only handle gates with one or less dependencies.");
@@ -252,7 +252,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
                 if (!mArchGraph->hasEdge(best.aQ, best.bQ)) std::swap(best.aQ, best.bQ);
                 appliedGates.push_back(UIntPair(best.aQ, best.bQ));
 
-                for (uint32_t i : cnode->getXbitsId()) {
+                for (uint32_t i : cnode.getXbitsId()) {
                     it.next(i);
                     ++reached[it.get(i)];
                 }
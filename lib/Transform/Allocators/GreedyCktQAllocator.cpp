@@ -12,7 +12,7 @@ using namespace efd;
 enum PropKind { K_SWP, K_FRZ } type;
 
 struct AllocProps {
-    CircuitGraph::CircuitNode::sRef cnode;
+    CircuitGraph::CircuitNode cnode;
     uint32_t cost;
     std::vector<uint32_t> path;
 
@@ -71,8 +71,8 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
             for (uint32_t i = 0; i < xbitNumber; ++i) {
                 auto cnode = it[i];
 
-                if (cnode->isGateNode() && cnode->numberOfXbits() <= 1) {
-                    allocatedStatements.push_back(cnode->node()->clone());
+                if (cnode.isGateNode() && cnode.numberOfXbits() <= 1) {
+                    allocatedStatements.push_back(cnode.node()->clone());
                     it.next(i);
                     changed = true;
                 }
@@ -87,25 +87,25 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
         // Reach gates with non-marked xbitNumber and mark them.
         for (uint32_t i = 0; i < xbitNumber; ++i) {
             auto cnode = it[i];
-            auto node = cnode->node();
+            auto node = cnode.node();
 
-            if (cnode->isGateNode() && !marked[i]) {
+            if (cnode.isGateNode() && !marked[i]) {
                 marked[i] = true;
 
                 if (reached.find(node) == reached.end())
-                    reached[node] = cnode->numberOfXbits();
+                    reached[node] = cnode.numberOfXbits();
                 --reached[node];
             }
         }
 
-        std::set<CircuitGraph::CircuitNode::sRef> allocatable;
+        std::set<CircuitGraph::CircuitNode> allocatable;
 
         // Advance the xbitNumber' cgraph and unmark them.
         for (uint32_t i = 0; i < xbitNumber; ++i) {
             auto cnode = it[i];
-            auto node = cnode->node();
+            auto node = cnode.node();
 
-            if (cnode->isGateNode() && !reached[node]) {
+            if (cnode.isGateNode() && !reached[node]) {
                 allocatable.insert(cnode);
             }
         }
@@ -114,14 +114,14 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
 
         // Removing instructions that don't use only one qubit, but do not have any dependencies
         for (auto cnode : allocatable) {
-            auto node = cnode->node();
+            auto node = cnode.node();
             auto dep = depBuilder.getDeps(node);
 
             if (dep.size() == 0) {
                 redo = true;
                 allocatedStatements.push_back(node->clone());
 
-                for (uint32_t i : cnode->getXbitsId()) {
+                for (uint32_t i : cnode.getXbitsId()) {
                     if (i < qubitNumber) frozen[i] = true;
                     marked[i] = false;
                     it.next(i);
@@ -132,13 +132,13 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
         if (redo) continue;
 
         AllocProps best;
-        best.cnode = nullptr;
+        best.cnode = CircuitGraph::CircuitNode();
         best.cost = _undef;
 
         for (auto cnode : allocatable) {
-            // Calculate cost for allocating cnode->node;
+            // Calculate cost for allocating cnode.node;
 
-            auto node = cnode->node();
+            auto node = cnode.node();
             auto dep = depBuilder.getDeps(node);
 
             EfdAbortIf(dep.size() > 1,
@@ -227,12 +227,12 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
                 best = props;
         }
 
-        EfdAbortIf(best.cnode.get() == nullptr, "There must be a 'best' node.");
+        EfdAbortIf(!best.cnode.isGateNode(), "There must be a 'best' node.");
 
         // Allocate best node;
         // Setting the 'stop' flag;
         auto& ops = sol.mOpSeqs[t++];
-        auto node = best.cnode->node();
+        auto node = best.cnode.node();
         auto newNode = node->clone();
 
         ops.first = newNode.get();
@@ -277,7 +277,7 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
             ops.second.push_back({ Operation::K_OP_REV, a, b });
         }
 
-        for (uint32_t i : best.cnode->getXbitsId()) {
+        for (uint32_t i : best.cnode.getXbitsId()) {
             marked[i] = false;
             it.next(i);
         }
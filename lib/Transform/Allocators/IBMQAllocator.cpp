@@ -2,17 +2,10 @@
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Support/BFSPathFinder.h"
 
-#include <chrono>
 #include <random>
 
 using namespace efd;
 
-static Opt<uint32_t> Seed
-("seed", "Seed to be used in random algorithms.",
-std::chrono::system_clock::now().time_since_epoch().count(), false);
-static Opt<uint32_t> Trials
-("trials", "Number of times that IBMQAllocator should try.", 20, false);
-
 IBMQAllocator::IBMQAllocator(ArchGraph::sRef archGraph) : StdSolutionQAllocator(archGraph) {}
 
 IBMQAllocator::uRef IBMQAllocator::Create(ArchGraph::sRef archGraph) {
@@ -20,11 +13,11 @@ IBMQAllocator::uRef IBMQAllocator::Create(ArchGraph::sRef archGraph) {
 }
 
 IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
-(Layer& layer, Mapping current, std::set<uint32_t> qubitsSet, DependencyBuilder& depData) {
+(Layer layer, Mapping current, std::set<uint32_t> qubitsSet, DependencyBuilder& depData) {
     AllocationResult result { current, true, {}, false };
     InverseMap inv = InvertMapping(mPQubits, current);
 
-    std::default_random_engine generator(Seed.getVal());
+    std::default_random_engine generator(mOptions.seed);
     std::normal_distribution<double> distribution(0.0, (double) (1 / (double) mPQubits));
 
     std::vector<Dep> deps;
@@ -57,8 +50,8 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
     StdSolution::OpVector bestOpv;
     bool found = false;
 
-    uint32_t trials = Trials.getVal();
-    for (uint32_t i = 0; i < trials; ++i) {
+    uint32_t trials = mOptions.trials;
+    for (uint32_t i = 0; i < trials && !(found && isCancelled()); ++i) {
 
         auto trialMap = current;
         auto trialAssign = inv;
@@ -169,7 +162,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
 }
 
 StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
-    std::srand(Seed.getVal());
+    std::srand(mOptions.seed);
 
     StdSolution sol;
 
@@ -177,7 +170,7 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
     auto depData = dbwPass->getData();
 
     auto lbPass = PassCache::Get<LayersBuilderPass>(qmod);
-    auto layers = lbPass->getData();
+    auto& layers = lbPass->getData();
 
     BFSPathFinder bfs;
 
@@ -210,7 +203,7 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
     bool firstLayer = true;
 
     for (uint32_t i = 0, e = layers.size(); i < e; ++i) {
-        auto& layer = layers[i];
+        auto layer = layers[i];
 
         auto result = tryAllocateLayer(layer, current, qubitsSet, depData);
 
@@ -263,8 +256,8 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
         } else {
             INF << "Serializing this layer!" << std::endl;
 
-            for (auto node : layer) {
-                Layer sublayer { node };
+            for (auto& node : layer) {
+                Layer sublayer(&node, &node + 1);
 
                 auto result = tryAllocateLayer(sublayer, current, qubitsSet, depData);
 
@@ -11,16 +11,13 @@
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/TimingReport.h"
 
 #include <algorithm>
 
 using namespace efd;
 using namespace l_bmt;
 
-static Opt<uint32_t> MaxPartialSolutions
-("-bmt-max-partial", "Limits the max number of partial solutions per step.",
- std::numeric_limits<uint32_t>::max(), false);
-
 extern Stat<double> Phase1Time;
 extern Stat<double> Phase2Time;
 extern Stat<double> Phase3Time;
@@ -181,7 +178,7 @@ std::vector<std::vector<MappingCandidate>> LayeredBMTQAllocator::phase1(QModule:
 
     INF << "PHASE 1 >>>> Solving SIP Instances" << std::endl;
 
-    for (auto& l : mLayers) {
+    for (auto l : mLayers) {
         candidates = { { Mapping(mVQubits, _undef), 0 } };
         mapped.assign(mVQubits, false);
 
@@ -204,14 +201,12 @@ std::vector<std::vector<MappingCandidate>> LayeredBMTQAllocator::phase1(QModule:
             uint32_t a = dep.mFrom, b = dep.mTo;
 
             if (!mapped[b]) {
-                partitionGraph.succ(b).clear();
-                partitionGraph.pred(b).clear();
+                partitionGraph.clearEdges(b);
                 mapped[b] = true;
             }
 
             if (!mapped[a]) {
-                partitionGraph.succ(a).clear();
-                partitionGraph.pred(a).clear();
+                partitionGraph.clearEdges(a);
                 mapped[a] = true;
             }
 
@@ -359,12 +354,14 @@ LayeredBMTQAllocator::phase2(const std::vector<std::vector<MappingCandidate>>& c
         // INF << "Beginning: " << i << " of " << layers << " layers." << std::endl;
 
         uint32_t jLayerSize = collection[i].size();
-        for (uint32_t j = 0; j < jLayerSize; ++j) {
+        // Once cancelled, each layer keeps a single candidate (still glued to
+        // the best of the previous one).
+        for (uint32_t j = 0; j < jLayerSize && (j == 0 || !isCancelled()); ++j) {
             // Timer jt;
             // jt.start();
 
             TracebackInfo best = { {}, _undef, _undef, 0 };
-            uint32_t kLayerSize = collection[i - 1].size();
+            uint32_t kLayerSize = mem[i - 1].size();
 
             for (uint32_t k = 0; k < kLayerSize; ++k) {
                 auto mapping = collection[i][j].m;
@@ -393,7 +390,8 @@ LayeredBMTQAllocator::phase2(const std::vector<std::vector<MappingCandidate>>& c
 
     MappingSwapSequence best = { {}, {}, _undef };
 
-    for (uint32_t idx = 0, end = mem.back().size(); idx < end; ++idx) {
+    for (uint32_t idx = 0, end = mem.back().size();
+         idx < end && (idx == 0 || !isCancelled()); ++idx) {
         std::vector<SwapSeq> swapSeqs;
         std::vector<Mapping> mappings = tracebackPath(mem, idx);
 
@@ -435,7 +433,7 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
     INF << "Layers: " << mLayers.size() << std::endl;
     INF << "Mappings: " << mss.mappings.size() << std::endl;
 
-    for (auto& l : mLayers) {
+    for (auto l : mLayers) {
         if (idx > 0) {
             auto swaps = mss.swapSeqs[idx - 1];
 
@@ -501,7 +499,7 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
 }
 
 void LayeredBMTQAllocator::init(QModule::Ref qmod) {
-    mMaxPartial = MaxPartialSolutions.getVal();
+    mMaxPartial = mOptions.bmtMaxPartial;
 
     mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
     mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
@@ -532,17 +530,29 @@ Mapping LayeredBMTQAllocator::allocate(QModule::Ref qmod) {
     if (nofDeps > 0) {
         Timer tPhase1, tPhase2, tPhase3;
 
-        tPhase1.start();
-        auto phase1Output = phase1(qmod);
-        tPhase1.stop();
+        std::vector<std::vector<MappingCandidate>> phase1Output;
+        MappingSwapSequence phase2Output;
 
-        tPhase2.start();
-        auto phase2Output = phase2(phase1Output);
-        tPhase2.stop();
+        {
+            TimingScope scope("Phase1");
+            tPhase1.start();
+            phase1Output = phase1(qmod);
+            tPhase1.stop();
+        }
 
-        tPhase3.start();
-        initialMapping = phase3(qmod, phase2Output);
-        tPhase3.stop();
+        {
+            TimingScope scope("Phase2");
+            tPhase2.start();
+            phase2Output = phase2(phase1Output);
+            tPhase2.stop();
+        }
+
+        {
+            TimingScope scope("Phase3");
+            tPhase3.start();
+            initialMapping = phase3(qmod, phase2Output);
+            tPhase3.stop();
+        }
 
         // Stats collection.
         Phase1Time = (double) tPhase1.getMilliseconds() / 1000.0;
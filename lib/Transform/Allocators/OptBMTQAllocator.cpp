@@ -11,6 +11,7 @@
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/TimingReport.h"
 
 #include <algorithm>
 
@@ -19,10 +20,6 @@ using namespace opt_bmt;
 
 using CircuitNode = CircuitGraph::CircuitNode;
 
-static Opt<uint32_t> MaxPartialSolutions
-("-bmt-max-partial", "Limits the max number of partial solutions per step.",
- std::numeric_limits<uint32_t>::max(), false);
-
 extern Stat<double> Phase1Time;
 extern Stat<double> Phase2Time;
 extern Stat<double> Phase3Time;
@@ -43,7 +40,7 @@ namespace opt_bmt {
     
     struct CNodeCandidate {
         Dep dep;
-        CircuitNode::Ref cNode;
+        CircuitNode cNode;
         uint32_t weight;
     };
 
@@ -219,7 +216,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             changed = false;
 
             for (uint32_t i = 0; i < mXbitSize; ++i) {
-                if (it[i]->isGateNode() && it[i]->numberOfXbits() == 1) {
+                if (it[i].isGateNode() && it[i].numberOfXbits() == 1) {
                     mPP.back().push_back(it.get(i));
                     it.next(i);
                     ++reached[it.get(i)];
@@ -234,28 +231,28 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
         // It sounds dumb to have this kind of thing, but we do it so that
         // we can ensure deterministic behaviour. Otherwise, we will be susceptible
         // to different results if we change the the order of CircuitNodes.
-        std::set<CircuitNode::Ref> circuitNodeCandidatesSet;
-        std::vector<CircuitNode::Ref> circuitNodeCandidatesVector;
-        std::set<CircuitNode::Ref> toBeIssued;
+        std::set<CircuitNode> circuitNodeCandidatesSet;
+        std::vector<CircuitNode> circuitNodeCandidatesVector;
+        std::set<CircuitNode> toBeIssued;
 
         for (uint32_t i = 0; i < mXbitSize; ++i) {
-            if (it[i]->isGateNode() && reached[it.get(i)] == it[i]->numberOfXbits()) {
+            if (it[i].isGateNode() && reached[it.get(i)] == it[i].numberOfXbits()) {
                 if (mDBuilder.getDeps(it.get(i)).empty()) {
-                    toBeIssued.insert(it[i].get());
+                    toBeIssued.insert(it[i]);
                 } else {
-                    auto node = it[i].get();
+                    auto node = it[i];
                     if (circuitNodeCandidatesSet.find(node) == circuitNodeCandidatesSet.end()) {
-                        circuitNodeCandidatesSet.insert(it[i].get());
-                        circuitNodeCandidatesVector.push_back(it[i].get());
+                        circuitNodeCandidatesSet.insert(it[i]);
+                        circuitNodeCandidatesVector.push_back(it[i]);
                     }
                 }
             }
         }
 
         for (auto& cnode : toBeIssued) {
-            mPP.back().push_back(cnode->node());
+            mPP.back().push_back(cnode.node());
 
-            for (auto& i : cnode->getXbitsId()) {
+            for (auto& i : cnode.getXbitsId()) {
                 it.next(i);
                 ++reached[it.get(i)];
             }
@@ -280,7 +277,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             CNodeCandidate cNCand;
 
             cNCand.cNode = cnode;
-            cNCand.dep = mDBuilder.getDeps(cnode->node())[0];
+            cNCand.dep = mDBuilder.getDeps(cnode.node())[0];
 
             uint32_t a = cNCand.dep.mFrom, b = cNCand.dep.mTo;
 
@@ -342,14 +339,12 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             uint32_t a = dep.mFrom, b = dep.mTo;
 
             if (!mapped[b]) {
-                partitionGraph.succ(b).clear();
-                partitionGraph.pred(b).clear();
+                partitionGraph.clearEdges(b);
                 mapped[b] = true;
             }
 
             if (!mapped[a]) {
-                partitionGraph.succ(a).clear();
-                partitionGraph.pred(a).clear();
+                partitionGraph.clearEdges(a);
                 mapped[a] = true;
             }
 
@@ -358,9 +353,9 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             partitionGraph.putEdge(a, b);
 
             candidates = newCandidates;
-            mPP.back().push_back(cNCand.cNode->node());
+            mPP.back().push_back(cNCand.cNode.node());
 
-            for (auto i : cNCand.cNode->getXbitsId()) {
+            for (auto i : cNCand.cNode.getXbitsId()) {
                 it.next(i);
                 ++reached[it.get(i)];
             }
@@ -498,12 +493,14 @@ OptBMTQAllocator::phase2(const std::vector<std::vector<MappingCandidate>>& colle
         // INF << "Beginning: " << i << " of " << layers << " layers." << std::endl;
 
         uint32_t jLayerSize = collection[i].size();
-        for (uint32_t j = 0; j < jLayerSize; ++j) {
+        // Once cancelled, each layer keeps a single candidate (still glued to
+        // the best of the previous one).
+        for (uint32_t j = 0; j < jLayerSize && (j == 0 || !isCancelled()); ++j) {
             // Timer jt;
             // jt.start();
 
             TracebackInfo best = { {}, _undef, _undef, 0 };
-            uint32_t kLayerSize = collection[i - 1].size();
+            uint32_t kLayerSize = mem[i - 1].size();
 
             for (uint32_t k = 0; k < kLayerSize; ++k) {
                 auto mapping = collection[i][j].m;
@@ -532,7 +529,8 @@ OptBMTQAllocator::phase2(const std::vector<std::vector<MappingCandidate>>& colle
 
     MappingSwapSequence best = { {}, {}, _undef };
 
-    for (uint32_t idx = 0, end = mem.back().size(); idx < end; ++idx) {
+    for (uint32_t idx = 0, end = mem.back().size();
+         idx < end && (idx == 0 || !isCancelled()); ++idx) {
         std::vector<SwapSeq> swapSeqs;
         std::vector<Mapping> mappings = tracebackPath(mem, idx);
 
@@ -637,7 +635,7 @@ Mapping OptBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequence& m
 }
 
 void OptBMTQAllocator::init(QModule::Ref qmod) {
-    mMaxPartial = MaxPartialSolutions.getVal();
+    mMaxPartial = mOptions.bmtMaxPartial;
 
     mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
     mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
@@ -666,17 +664,29 @@ Mapping OptBMTQAllocator::allocate(QModule::Ref qmod) {
     if (nofDeps > 0) {
         Timer tPhase1, tPhase2, tPhase3;
 
-        tPhase1.start();
-        auto phase1Output = phase1(qmod);
-        tPhase1.stop();
+        std::vector<std::vector<MappingCandidate>> phase1Output;
+        MappingSwapSequence phase2Output;
 
-        tPhase2.start();
-        auto phase2Output = phase2(phase1Output);
-        tPhase2.stop();
+        {
+            TimingScope scope("Phase1");
+            tPhase1.start();
+            phase1Output = phase1(qmod);
+            tPhase1.stop();
+        }
 
-        tPhase3.start();
-        initialMapping = phase3(qmod, phase2Output);
-        tPhase3.stop();
+        {
+            TimingScope scope("Phase2");
+            tPhase2.start();
+            phase2Output = phase2(phase1Output);
+            tPhase2.stop();
+        }
+
+        {
+            TimingScope scope("Phase3");
+            tPhase3.start();
+            initialMapping = phase3(qmod, phase2Output);
+            tPhase3.stop();
+        }
 
         // Stats collection.
         Phase1Time = (double) tPhase1.getMilliseconds() / 1000.0;
@@ -0,0 +1,142 @@
+#include "enfield/Transform/Allocators/PortfolioQAllocator.h"
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Transform/QModuleQualityEvalPass.h"
+#include "enfield/Transform/InlineAllPass.h"
+#include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Support/Defs.h"
+#include "enfield/Support/Stats.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+using namespace efd;
+
+namespace {
+    struct Candidate {
+        std::string name;
+        QbitAllocator::uRef allocator;
+        QModule::uRef qmod;
+        uint32_t cost;
+        std::unique_ptr<StatScope> stats;
+    };
+}
+
+/// \brief Computes the weighted cost of \p qmod, after reversing the edges
+/// (if \p reverse) and inlining every gate without a weight.
+static uint32_t ComputeWeightedCost(QModule::Ref qmod,
+                                    ArchGraph::sRef archGraph,
+                                    const GateWeightMap& weights,
+                                    bool reverse) {
+    auto inlinePass = InlineAllPass::Create(ExtractGateNames(weights));
+    PassCache::Run(qmod, inlinePass.get());
+
+    if (reverse) {
+        auto reversePass = ReverseEdgesPass::Create(archGraph);
+        PassCache::Run(qmod, reversePass.get());
+        PassCache::Run(qmod, inlinePass.get());
+    }
+
+    auto qualityPass = QModuleQualityEvalPass::Create(weights);
+    PassCache::Run(qmod, qualityPass.get());
+    return qualityPass->getData().mWeightedCost;
+}
+
+PortfolioQAllocator::PortfolioQAllocator(ArchGraph::sRef ag) : QbitAllocator(ag) {}
+
+Mapping PortfolioQAllocator::allocate(QModule::Ref qmod) {
+    EfdAbortIf(mOptions.portfolio.empty(), "No allocator in the portfolio.");
+
+    // Routing only adds gates. So, the module as it is (already inlined) is a
+    // lower bound for every candidate.
+    auto lowerBoundMod = qmod->clone();
+    uint32_t lowerBound = ComputeWeightedCost(lowerBoundMod.get(), mArchGraph,
+                                              mGateWeightMap, false);
+    double goal = lowerBound * mOptions.portfolioThreshold;
+
+    std::vector<Candidate> candidates;
+
+    for (auto& name : mOptions.portfolio) {
+        EfdAbortIf(!EnumAllocator::Has(name),
+                   "Unknown allocator in the portfolio: `" << name << "`.");
+
+        EnumAllocator key(name);
+        EfdAbortIf(key.getValue() == Allocator::Q_portfolio,
+                   "The portfolio can't contain itself.");
+        EfdAbortIf(!HasAllocator(key), "Allocator not registered: `" << name << "`.");
+
+        auto allocator = CreateQbitAllocator(key, mArchGraph);
+        allocator->setGateWeightMap(mGateWeightMap);
+        allocator->setOptions(mOptions);
+
+        candidates.push_back(Candidate {
+            name, std::move(allocator), qmod->clone(), std::numeric_limits<uint32_t>::max(),
+            std::unique_ptr<StatScope>(new StatScope())
+        });
+    }
+
+    std::mutex mutex;
+    std::condition_variable finishedCV;
+    uint32_t finished = 0;
+
+    auto cancelAll = [&candidates]() {
+        for (auto& candidate : candidates) candidate.allocator->cancel();
+    };
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0, e = candidates.size(); i < e; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            auto& candidate = candidates[i];
+
+            // Each candidate keeps its own stats. Only the winner's are
+            // reported (see below).
+            StatScope::Binding binding(candidate.stats.get());
+            PassCache::Run(candidate.qmod.get(), candidate.allocator.get());
+
+            auto scored = candidate.qmod->cloneShared();
+            uint32_t cost = ComputeWeightedCost(scored.get(), mArchGraph,
+                                                mGateWeightMap, true);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            candidate.cost = cost;
+            ++finished;
+
+            if (cost <= goal) cancelAll();
+            finishedCV.notify_all();
+        }));
+    }
+
+    if (mOptions.portfolioDeadline > 0) {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool allFinished = finishedCV.wait_for(
+                lock, std::chrono::milliseconds(mOptions.portfolioDeadline),
+                [&]() { return finished == candidates.size(); });
+        if (!allFinished) cancelAll();
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    uint32_t best = 0;
+    for (uint32_t i = 1, e = candidates.size(); i < e; ++i) {
+        if (candidates[i].cost < candidates[best].cost) best = i;
+    }
+
+    auto& winner = candidates[best];
+    INF << "Portfolio winner: `" << winner.name << "` (cost: " << winner.cost
+        << ", lower bound: " << lowerBound << ")." << std::endl;
+
+    winner.stats->mergeIntoCurrent();
+
+    qmod->clearStatements();
+    qmod->insertStatementLast(winner.qmod->takeStatements());
+
+    return winner.allocator->getData();
+}
+
+PortfolioQAllocator::uRef PortfolioQAllocator::Create(ArchGraph::sRef ag) {
+    return uRef(new PortfolioQAllocator(ag));
+}
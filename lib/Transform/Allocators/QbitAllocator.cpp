@@ -1,5 +1,6 @@
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/RenameQbitsPass.h"
+#include "enfield/Transform/CircuitAnalysisPass.h"
 #include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Arch/ArchGraph.h"
@@ -7,8 +8,13 @@
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/TimingReport.h"
 
 #include <iterator>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
 
 using namespace efd;
 
@@ -89,16 +95,35 @@ std::string efd::MappingToString(Mapping m) {
 }
 
 // ------------------ QbitAllocator ----------------------
-QbitAllocator::QbitAllocator(ArchGraph::sRef archGraph) : mArchGraph(archGraph) {
+AllocatorOptions::AllocatorOptions() :
+    seed(std::chrono::system_clock::now().time_since_epoch().count()),
+    trials(20),
+    bmtMaxChildren(std::numeric_limits<uint32_t>::max()),
+    bmtMaxPartial(std::numeric_limits<uint32_t>::max()),
+    bmtMaxMapSeq(1),
+    sabreLookAhead(20),
+    sabreIterations(5),
+    portfolio({ "Q_sabre", "Q_jku", "Q_bmt", "Q_opt_bmt" }),
+    portfolioThreshold(1.0),
+    portfolioDeadline(0) {}
+
+QbitAllocator::QbitAllocator(ArchGraph::sRef archGraph)
+    : mCancelled(false), mArchGraph(archGraph) {
     mGateWeightMap = { {"U", 1}, {"CX", 10} };
 }
 
+/// \brief Number of qubits of each gate the reverse CNOT is inlined into.
+typedef std::vector<std::pair<std::string, uint32_t>> InlinedRevCX;
+
 // In order for calculatin the cost of a CNOT and a Haddamard gate in the most
 // generic way possible, we create a program with only one application of the
 // RevCNOT gate (it uses both CNOT and Hadammard).
 // Then, we inline it based on the given gates and compute the cost of each
 // gate, knowing that the only single-qubit gate is a Hadammard, and the only
 // two-qubit gate is a CNOT.
+//
+// The inlined program only depends on the basis gates. So, it is built once
+// per basis, and shared by every allocator.
 void QbitAllocator::calculateHAndCXCost() {
     static const std::string revCXProgram =
 "\
@@ -107,15 +132,37 @@ include \"qelib1.inc\";\
 qreg q[2];\
 intrinsic_rev_cx__ q[0], q[1];\
 ";
-    auto qmod = QModule::ParseString(revCXProgram);
-    inlineAllGates(qmod.get());
+    static std::map<GateNameVector, InlinedRevCX> Inlined;
+    static std::mutex Mutex;
+
+    auto basis = ExtractGateNames(mGateWeightMap);
+    InlinedRevCX gates;
+
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        auto it = Inlined.find(basis);
+        if (it == Inlined.end()) {
+            auto qmod = QModule::ParseString(revCXProgram);
+            inlineAllGates(qmod.get());
+
+            InlinedRevCX inlined;
+            for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
+                auto qopNode = dynCast<NDQOp>(it->get());
+                inlined.push_back(std::make_pair(qopNode->getOperation(),
+                                                 qopNode->getQArgs()->getChildNumber()));
+            }
 
-    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
-        auto qopNode = dynCast<NDQOp>(it->get());
-        auto qargs = qopNode->getQArgs();
-        auto cost = mGateWeightMap[qopNode->getOperation()];
+            it = Inlined.insert(std::make_pair(basis, inlined)).first;
+        }
+
+        gates = it->second;
+    }
 
-        if (qargs->getChildNumber() == 2) mCXCost = cost;
+    for (auto& gate : gates) {
+        auto cost = mGateWeightMap[gate.first];
+
+        if (gate.second == 2) mCXCost = cost;
         else mHCost = cost;
     }
 }
@@ -175,7 +222,10 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     timer.start();
     // ---------------------------------
 
-    inlineAllGates(qmod);
+    {
+        TimingScope scope("InlineGates");
+        inlineAllGates(qmod);
+    }
 
     // Stopping timer and setting the stat -----------------
     timer.stop();
@@ -188,7 +238,10 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     timer.start();
     // ---------------------------------
 
-    replaceWithArchSpecs(qmod);
+    {
+        TimingScope scope("ReplaceWithArchSpecs");
+        replaceWithArchSpecs(qmod);
+    }
 
     // Stopping timer and setting the stat -----------------
     timer.stop();
@@ -196,7 +249,9 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     // -----------------------------------------------------
 
     // Getting the new information, since it can be the case that the qmodule
-    // was modified.
+    // was modified. The analyses the allocators use are all computed at once.
+    PassCache::Run<CircuitAnalysisPass>(qmod);
+
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
     auto depBuilder = depPass->getData();
     auto& deps = depBuilder.getDependencies();
@@ -214,7 +269,10 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     timer.start();
     // ---------------------------------
 
-    mData = allocate(qmod);
+    {
+        TimingScope scope("Allocate");
+        mData = allocate(qmod);
+    }
 
     // Stopping timer and setting the stat -----------------
     timer.stop();
@@ -228,3 +286,15 @@ bool QbitAllocator::run(QModule::Ref qmod) {
 void QbitAllocator::setGateWeightMap(const GateWeightMap& weightMap) {
     mGateWeightMap = weightMap;
 }
+
+void QbitAllocator::setOptions(const AllocatorOptions& options) {
+    mOptions = options;
+}
+
+void QbitAllocator::cancel() {
+    mCancelled = true;
+}
+
+bool QbitAllocator::isCancelled() const {
+    return mCancelled;
+}
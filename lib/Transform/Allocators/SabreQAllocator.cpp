@@ -1,14 +1,15 @@
 #include "enfield/Transform/Allocators/SabreQAllocator.h"
 #include "enfield/Transform/Allocators/Simple/RandomMappingFinder.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
 #include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/Utils.h"
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/Trace.h"
 
-#include <numeric>
 #include <unordered_map>
 
 using namespace efd;
@@ -16,34 +17,33 @@ using namespace efd;
 using CircuitNode = CircuitGraph::CircuitNode;
 using WeightedSwap = std::pair<double, Swap>;
 
-static Opt<uint32_t> LookAhead
-("-sabre-lookahead", "Sets the number of instructions to peek.", 20, false);
-static Opt<uint32_t> Iterations
-("-sabre-iterations", "Sets the number of times to run SABRE.", 5, false);
-
-Stat<uint32_t> Swaps
+static Stat<uint32_t> Swaps
 ("Swaps", "Number of swaps found.");
 
 SabreQAllocator::SabreQAllocator(ArchGraph::sRef ag)
-    : QbitAllocator(ag) {}
+    : QbitAllocator(ag), mSwaps(0) {}
+
+uint32_t SabreQAllocator::getNumberOfSwaps() const {
+    return mSwaps;
+}
 
 SabreQAllocator::MappingAndNSwaps
 SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
+                                            CircuitGraph& cGraph,
+                                            const std::vector<Node::Ref>& stmts,
                                             QModule::Ref qmod,
                                             bool issueInstructions) {
     auto mapping = initialMapping;
-    auto stmtNumber = qmod->getNumberOfStmts();
+    uint32_t stmtNumber = stmts.size();
 
-    auto depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    auto cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
+    auto& depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
 
     auto it = cGraph.build_iterator();
     auto xbitNumber = cGraph.size();
 
     std::unordered_map<Node::Ref, uint32_t> indexMap;
-    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
-        uint32_t indexMapSize = indexMap.size();
-        indexMap[it->get()] = indexMapSize;
+    for (uint32_t i = 0; i < stmtNumber; ++i) {
+        indexMap[stmts[i]] = i;
     }
 
     std::map<Node::Ref, uint32_t> reached;
@@ -64,19 +64,21 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
 
         do {
             changed = false;
-            std::set<CircuitNode::Ref> issueNodes;
+            // Issued in the order of the statements (not of the addresses of
+            // the circuit nodes), so that the output is deterministic.
+            std::map<uint32_t, CircuitNode> issueNodes;
 
             for (uint32_t i = 0; i < xbitNumber; ++i) {
                 auto cNode = it[i];
-                auto node = cNode->node();
+                auto node = cNode.node();
 
-                if (cNode->isGateNode() && cNode->numberOfXbits() == reached[node]) {
+                if (cNode.isGateNode() && cNode.numberOfXbits() == reached[node]) {
                     switch (node->getKind()) {
                         case Node::Kind::K_IF_STMT:
                         case Node::Kind::K_QOP_U:
                         case Node::Kind::K_QOP_CX:
                         case Node::Kind::K_QOP_GEN:
-                            if (cNode->numberOfXbits() > 1) {
+                            if (cNode.numberOfXbits() > 1) {
                                 auto deps = depBuilder.getDeps(node);
 
                                 EfdAbortIf(deps.size() > 1,
@@ -99,7 +101,7 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
                         case Node::Kind::K_QOP_BARRIER:
                         case Node::Kind::K_QOP_MEASURE:
                             // INF << "Issue: " << node->toString(false) << std::endl;
-                            issueNodes.insert(cNode.get());
+                            issueNodes[indexMap[node]] = cNode;
                             changed = true;
                             break;
 
@@ -109,14 +111,16 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
                 }
             }
 
-            for (auto cNode : issueNodes) {
-                for (auto i : cNode->getXbitsId()) {
+            for (auto& pair : issueNodes) {
+                auto cNode = pair.second;
+
+                for (auto i : cNode.getXbitsId()) {
                     it.next(i);
                     ++reached[it.get(i)];
                 }
 
                 if (issueInstructions) {
-                    auto clone = cNode->node()->clone();
+                    auto clone = cNode.node()->clone();
                     clone->apply(&visitor);
                     newStatements.push_back(std::move(clone));
                 }
@@ -129,7 +133,7 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
         uint32_t offset = std::numeric_limits<uint32_t>::max();
 
         for (uint32_t i = 0; i < xbitNumber; ++i) {
-            if (it[i]->isGateNode() && it[i]->numberOfXbits() == reached[it.get(i)]) {
+            if (it[i].isGateNode() && it[i].numberOfXbits() == reached[it.get(i)]) {
                 auto node = it.get(i);
                 auto dep = depBuilder.getDeps(node)[0];
 
@@ -146,7 +150,7 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
         if (currentLayer.empty()) break;
 
         while (nextLayer.size() < mLookAhead && offset < stmtNumber) {
-            auto node = qmod->getStatement(offset++);
+            auto node = stmts[offset++];
             if (pastLookAhead.find(node) == pastLookAhead.end()) {
                 auto deps = depBuilder.getDeps(node);
                 if (!deps.empty()) nextLayer.push_back(deps[0]);
@@ -213,55 +217,81 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
 }
 
 Mapping SabreQAllocator::allocate(QModule::Ref qmod) {
-    std::vector<uint32_t> order(qmod->getNumberOfStmts());
-    std::iota(order.begin(), order.end(), 0);
-    std::reverse(order.begin(), order.end());
-
-    mLookAhead = LookAhead.getVal();
-    mIterations = Iterations.getVal();
+    mLookAhead = mOptions.sabreLookAhead;
+    mIterations = mOptions.sabreIterations;
 
     auto depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
     mXbitToNumber = depBuilder.getXbitToNumber();
 
-    auto qmodReverse = qmod->clone();
-    qmodReverse->orderby(order);
+    // The reversed circuit is only a view of the original one: the same
+    // statements, appended to the circuit graph from the last to the first.
+    auto& stream = PassCache::Get<GateStreamBuilderPass>(qmod)->getData();
+    auto& cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
+    auto cGraphReverse = BuildCircuitGraph(stream, true);
+
+    std::vector<Node::Ref> stmts, stmtsReverse;
+    for (uint32_t i = 0, e = stream.size(); i < e; ++i) {
+        stmts.push_back(stream.getNode(i));
+    }
+
+    stmtsReverse.assign(stmts.rbegin(), stmts.rend());
 
     mBFSDistance.init(mArchGraph.get());
 
     Mapping initialM, finalM;
 
-    RandomMappingFinder mappingFinder;
+    RandomMappingFinder mappingFinder(mOptions.seed);
     auto dummyDependencies = depBuilder.getDependencies();
 
     MappingAndNSwaps best(initialM, std::numeric_limits<uint32_t>::max());
 
     INF << "Starting SABRE Algorithm." << std::endl;
-    for (uint32_t i = 0; i < mIterations; ++i) {
+    // At least one iteration is needed for a valid mapping.
+    for (uint32_t i = 0; i < mIterations && (i == 0 || !isCancelled()); ++i) {
+        EFD_TRACE_SCOPE(trialTrace, "Trial", "sabre");
+        EFD_TRACE_ARG(trialTrace, "trial", i);
+
         Timer t;
         initialM = mappingFinder.find(mArchGraph.get(), dummyDependencies);
 
+        EFD_TRACE_SCOPE(roundTrace, "Round", "sabre");
+
         t.start();
-        auto resultFinal = allocateWithInitialMapping(initialM, qmod, false);
+        auto resultFinal = allocateWithInitialMapping(initialM, cGraph, stmts, qmod, false);
         t.stop();
         INF << "[" << i << "] First round: " << t.getMilliseconds() / 1000.0 << std::endl;
 
+        EFD_TRACE_ARG(roundTrace, "round", 0);
+        EFD_TRACE_ARG(roundTrace, "swaps", resultFinal.second);
+        EFD_TRACE_RESTART(roundTrace);
+
         t.start();
-        auto resultInit = allocateWithInitialMapping(resultFinal.first, qmodReverse.get(), false);
+        auto resultInit = allocateWithInitialMapping(resultFinal.first, cGraphReverse,
+                                                     stmtsReverse, qmod, false);
         t.stop();
         INF << "[" << i << "] Second round: " << t.getMilliseconds() / 1000.0 << std::endl;
 
+        EFD_TRACE_ARG(roundTrace, "round", 1);
+        EFD_TRACE_ARG(roundTrace, "swaps", resultInit.second);
+        EFD_TRACE_RESTART(roundTrace);
+
         t.start();
-        resultFinal = allocateWithInitialMapping(resultInit.first, qmod, false);
+        resultFinal = allocateWithInitialMapping(resultInit.first, cGraph, stmts, qmod, false);
         t.stop();
         INF << "[" << i << "] Third round: " << t.getMilliseconds() / 1000.0 << std::endl;
 
+        EFD_TRACE_ARG(roundTrace, "round", 2);
+        EFD_TRACE_ARG(roundTrace, "swaps", resultFinal.second);
+        EFD_TRACE_ARG(trialTrace, "swaps", resultFinal.second);
+
         if (resultFinal.second < best.second) {
             best = MappingAndNSwaps(resultInit.first, resultFinal.second);
         }
     }
 
-    auto r = allocateWithInitialMapping(best.first, qmod, true);
-    Swaps = r.second;
+    auto r = allocateWithInitialMapping(best.first, cGraph, stmts, qmod, true);
+    mSwaps = r.second;
+    Swaps = mSwaps;
 
     return best.first;
 }
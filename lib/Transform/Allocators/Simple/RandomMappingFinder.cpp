@@ -1,19 +1,21 @@
 #include "enfield/Transform/Allocators/Simple/RandomMappingFinder.h"
 
-#include <ctime>
 #include <algorithm>
-#include <chrono>
-#include <random>
 
-efd::Opt<uint32_t> Seed ("seed", "Seed to be used in random algorithms.",
-std::chrono::system_clock::now().time_since_epoch().count(), false);
-efd::Stat<uint32_t> SeedStat
+static efd::Stat<uint32_t> SeedStat
 ("seed", "Seed used in the random allocator.");
 
-int rnd(int i) {
-    static std::default_random_engine generator(Seed.getVal());
-    static std::uniform_int_distribution<int> distribution(0, i - 1);
-    return distribution(generator);
+efd::RandomMappingFinder::RandomMappingFinder(uint32_t seed) {
+    setSeed(seed);
+}
+
+void efd::RandomMappingFinder::setSeed(uint32_t seed) {
+    mSeed = seed;
+    mGenerator.seed(seed);
+}
+
+uint32_t efd::RandomMappingFinder::getSeed() const {
+    return mSeed;
 }
 
 efd::Mapping
@@ -26,12 +28,12 @@ efd::RandomMappingFinder::find(ArchGraph::Ref g, DepsVector& deps) {
     }
 
     // "Generating" the initial mapping.
-    SeedStat = Seed.getVal();
-    std::random_shuffle(mapping.begin(), mapping.end(), rnd);
+    SeedStat = mSeed;
+    std::shuffle(mapping.begin(), mapping.end(), mGenerator);
 
     return mapping;
 }
 
-efd::RandomMappingFinder::uRef efd::RandomMappingFinder::Create() {
-    return uRef(new RandomMappingFinder());
+efd::RandomMappingFinder::uRef efd::RandomMappingFinder::Create(uint32_t seed) {
+    return uRef(new RandomMappingFinder(seed));
 }
@@ -10,6 +10,7 @@ efd::StdSolution efd::SimpleQAllocator::buildStdSolution(QModule::Ref qmod) {
         ->getData()
         .getDependencies();
 
+    mMapFinder->setSeed(mOptions.seed);
     auto initial = mMapFinder->find(mArchGraph.get(), deps);
     return mSolBuilder->build(initial, deps, mArchGraph.get());
 }
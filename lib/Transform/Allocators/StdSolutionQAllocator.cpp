@@ -135,11 +135,15 @@ bool efd::StdSolutionImplPass::run(QModule::Ref qmod) {
         (*it)->apply(this);
     }
 
+    QModule::ReplacementMap repMap;
+
     for (auto& pair : mReplVector) {
         if (!pair.second.empty())
-            qmod->replaceStatement(pair.first, std::move(pair.second));
+            repMap[pair.first] = std::move(pair.second);
     }
 
+    qmod->replaceStatements(std::move(repMap));
+
     return true;
 }
 
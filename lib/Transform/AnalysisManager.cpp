@@ -0,0 +1,53 @@
+#include "enfield/Transform/AnalysisManager.h"
+#include "enfield/Support/TimingReport.h"
+#include "enfield/Support/Trace.h"
+
+efd::AnalysisManager::AnalysisManager(QModule* qmod) : mQMod(qmod) {
+}
+
+efd::Pass::Ref efd::AnalysisManager::find(uint8_t* id) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mPasses.find(id);
+    if (it == mPasses.end()) return nullptr;
+    return it->second.get();
+}
+
+efd::Pass::Ref efd::AnalysisManager::insert(uint8_t* id, Pass::sRef pass) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // If two threads computed the same analysis, the first one is kept, so
+    // that the pointers already returned remain valid.
+    auto it = mPasses.find(id);
+    if (it == mPasses.end()) it = mPasses.insert(std::make_pair(id, pass)).first;
+    return it->second.get();
+}
+
+void efd::AnalysisManager::replace(uint8_t* id, Pass::sRef pass) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPasses[id] = pass;
+}
+
+bool efd::AnalysisManager::runPass(Pass::Ref pass) {
+    // Avoids building the name when nothing is recorded.
+    if (!TimingReport::IsEnabled() && !Trace::IsEnabled()) return pass->run(mQMod);
+
+    auto name = pass->getName();
+    TimingScope scope(name);
+    EFD_TRACE_SCOPE(trace, name, "pass");
+    return pass->run(mQMod);
+}
+
+void efd::AnalysisManager::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPasses.clear();
+}
+
+void efd::AnalysisManager::invalidate(Pass::Ref pass) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto it = mPasses.begin(); it != mPasses.end();) {
+        if (pass->preserves(it->first)) ++it;
+        else it = mPasses.erase(it);
+    }
+}
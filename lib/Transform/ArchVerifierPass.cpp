@@ -1,134 +1,107 @@
 #include "enfield/Transform/ArchVerifierPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/Utils.h"
-#include "enfield/Analysis/NodeVisitor.h"
-
 
 using namespace efd;
 
 namespace efd {
-    class ArchVerifierVisitor : public NodeVisitor {
-        private:
-            struct SemanticCNOT { uint32_t u, v; };
+    extern const std::string StdLibCX;
+}
 
-            ArchGraph::sRef mArch;
+namespace {
+    /// \brief Checks the gates of a stream against the edges of an architecture,
+    /// using the (physical) qubit uids of its operands.
+    class StreamArchVerifier {
+        private:
+            const GateStream& mStream;
+            const ArchGraph& mArch;
+            // The vertex of \em mArch of each qubit of \em mStream.
+            std::vector<uint32_t> mUIds;
 
-            bool checkCNOT(SemanticCNOT cnot);
-            bool visitNDQOp(NDQOp::Ref qop);
+            bool hasEdge(uint32_t u, uint32_t v);
+            bool hasAnyEdge(uint32_t u, uint32_t v);
+            bool check(uint32_t i);
 
         public:
-            ArchVerifierVisitor(ArchGraph::sRef ag);
-
-            void visit(NDQOpMeasure::Ref ref) override;
-            void visit(NDQOpReset::Ref ref) override;
-            void visit(NDQOpU::Ref ref) override;
-            void visit(NDQOpBarrier::Ref ref) override;
-            void visit(NDQOpCX::Ref ref) override;
-            void visit(NDQOpGen::Ref ref) override;
-            void visit(NDIfStmt::Ref ref) override;
+            StreamArchVerifier(const GateStream& stream,
+                               const ArchGraph& arch,
+                               std::vector<uint32_t> uids);
 
-            bool mSuccess;
+            /// \brief Returns true if every gate respects the architecture.
+            bool run();
     };
 }
 
-ArchVerifierVisitor::ArchVerifierVisitor(ArchGraph::sRef ag) : mArch(ag), mSuccess(true) {}
+StreamArchVerifier::StreamArchVerifier(const GateStream& stream,
+                                       const ArchGraph& arch,
+                                       std::vector<uint32_t> uids)
+    : mStream(stream), mArch(arch), mUIds(std::move(uids)) {}
 
-bool ArchVerifierVisitor::checkCNOT(SemanticCNOT cnot) {
-    return mArch->hasEdge(cnot.u, cnot.v);
+bool StreamArchVerifier::hasEdge(uint32_t u, uint32_t v) {
+    return mArch.hasEdge(mUIds[u], mUIds[v]);
 }
 
-bool ArchVerifierVisitor::visitNDQOp(NDQOp::Ref qop) {
-    bool success;
+bool StreamArchVerifier::hasAnyEdge(uint32_t u, uint32_t v) {
+    return hasEdge(u, v) || hasEdge(v, u);
+}
 
-    std::vector<uint32_t> qUIds;
-    for (auto& qarg : *qop->getQArgs()) {
-        auto qargStr = qarg->toString(false);
+bool StreamArchVerifier::check(uint32_t i) {
+    auto qargs = mStream.getQArgs(i);
 
-        if (mArch->hasSId(qargStr)) {
-            qUIds.push_back(mArch->getUId(qargStr));
-        } else {
-            // If there is some quantum operation that uses an inexistent qubit, we already
-            // may return false!
-            return false;
-        }
+    // If there is some quantum operation that uses an inexistent qubit, we already
+    // may return false!
+    for (auto q : qargs) {
+        if (mUIds[q] == _undef) return false;
     }
 
-    if (IsCNOTGateCall(qop)) {
-        EfdAbortIf(qUIds.size() != 2,
-                   "CNOT call must have 2 quantum qubits. Actual: `"
-                   << qop->toString(false) << "`.");
+    switch (mStream.getKind(i)) {
+        case GateStream::Kind::GEN:
+            if (mStream.getGateName(i) != StdLibCX) return true;
+            // Fall through: it is also a CNOT.
 
-        success = checkCNOT({ qUIds[0], qUIds[1] });
+        case GateStream::Kind::CX:
+            EfdAbortIf(qargs.size() != 2,
+                       "CNOT call must have 2 quantum qubits. Actual: `"
+                       << mStream.getNode(i)->toString(false) << "`.");
 
-    } else if (IsIntrinsicGateCall(qop)) {
-        auto gen = dynCast<NDQOpGen>(qop);
+            return hasEdge(qargs[0], qargs[1]);
 
-        EfdAbortIf(gen == nullptr,
-                   "Intrinsic call not generic operation!? Actual: `"
-                   << qop->toString(false) << "`.");
+        case GateStream::Kind::INTRINSIC_SWAP:
+            EfdAbortIf(qargs.size() != 2,
+                       "SWAP call must have 2 quantum qubits. Actual: `"
+                       << qargs.size() << "`.");
 
-        EfdAbortIf(!gen->isIntrinsic(),
-                   "Intrinsic call not marked as intrinsic!? Actual: `"
-                   << qop->toString(false) << "`.");
+            return hasAnyEdge(qargs[0], qargs[1]);
 
-        switch (gen->getIntrinsicKind()) {
-            case NDQOpGen::K_INTRINSIC_SWAP:
-                EfdAbortIf(qUIds.size() != 2,
-                           "SWAP call must have 2 quantum qubits. Actual: `"
-                           << qUIds.size() << "`.");
+        case GateStream::Kind::INTRINSIC_LCX:
+            EfdAbortIf(qargs.size() != 3,
+                       "LCX call must have 3 quantum qubits. Actual: `"
+                       << qargs.size() << "`.");
 
-                success = checkCNOT({ qUIds[0], qUIds[1] }) || checkCNOT({ qUIds[1], qUIds[0] });
-                break;
+            return hasAnyEdge(qargs[0], qargs[1]) && hasAnyEdge(qargs[1], qargs[2]);
 
-            case NDQOpGen::K_INTRINSIC_LCX:
-                EfdAbortIf(qUIds.size() != 3,
-                           "LCX call must have 3 quantum qubits. Actual: `"
-                           << qUIds.size() << "`.");
+        case GateStream::Kind::INTRINSIC_REV_CX:
+            EfdAbortIf(qargs.size() != 2,
+                       "Reversal call must have 2 quantum qubits. Actual: `"
+                       << qargs.size() << "`.");
 
-                success = (checkCNOT({ qUIds[0], qUIds[1] }) || checkCNOT({ qUIds[1], qUIds[0] })) &&
-                          (checkCNOT({ qUIds[1], qUIds[2] }) || checkCNOT({ qUIds[2], qUIds[1] }));
-                break;
+            return hasEdge(qargs[1], qargs[0]);
 
-            case NDQOpGen::K_INTRINSIC_REV_CX:
-                EfdAbortIf(qUIds.size() != 2,
-                           "Reversal call must have 2 quantum qubits. Actual: `"
-                           << qUIds.size() << "`.");
-
-                success = checkCNOT({ qUIds[1], qUIds[0] });
-                break;
-        }
-    } else {
-        success = true;
+        default:
+            break;
     }
 
-    return success;
-}
-
-void ArchVerifierVisitor::visit(NDQOpMeasure::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
-}
-
-void ArchVerifierVisitor::visit(NDQOpReset::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
+    return true;
 }
 
-void ArchVerifierVisitor::visit(NDQOpU::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
-}
-
-void ArchVerifierVisitor::visit(NDQOpBarrier::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
-}
-
-void ArchVerifierVisitor::visit(NDQOpCX::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
-}
-
-void ArchVerifierVisitor::visit(NDQOpGen::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref);
-}
+bool StreamArchVerifier::run() {
+    for (uint32_t i = 0, e = mStream.size(); i < e; ++i) {
+        if (!check(i)) return false;
+    }
 
-void ArchVerifierVisitor::visit(NDIfStmt::Ref ref) {
-    mSuccess = mSuccess && visitNDQOp(ref->getQOp());
+    return true;
 }
 
 // ----------------------------------------------------------------
@@ -140,15 +113,23 @@ ArchVerifierPass::ArchVerifierPass(ArchGraph::sRef ag) : mArch(ag) {
 }
 
 bool ArchVerifierPass::run(QModule* qmod) {
-    mData = true;
-    ArchVerifierVisitor visitor(mArch);
-
-    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end();
-            it != end && mData; ++it) {
-        (*it)->apply(&visitor);
-        mData = mData && visitor.mSuccess;
+    // As the semantic verifier does, the stream is always built again, so that
+    // what is checked is the module as it is.
+    auto streamPass = GateStreamBuilderPass::Create();
+    streamPass->run(qmod);
+
+    auto& stream = streamPass->getData();
+    auto& xton = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+
+    // Operations over whole registers have no vertex in the architecture.
+    if (!stream.isFlat()) {
+        mData = false;
+        return false;
     }
 
+    StreamArchVerifier verifier(stream, *mArch, GetArchQUIds(xton, *mArch));
+    mData = verifier.run();
+
     return false;
 }
 
@@ -2,108 +2,90 @@
 #include "enfield/Transform/QModule.h"
 #include "enfield/Support/RTTI.h"
 
+#include <algorithm>
+
 uint8_t efd::CNOTLBOWrapperPass::ID = 0;
 
 efd::Ordering efd::CNOTLBOWrapperPass::generate(CircuitGraph& graph) {
     auto& layers = mData.layers;
+    layers = Layers();
 
-    auto xbitNumber = graph.size();
-    auto qubitNumber = graph.getQSize();
-    auto cbitNumber = graph.getCSize();
+    uint32_t xbitNumber = graph.size();
+    uint32_t qubitNumber = graph.getQSize();
 
-    bool stop, ugate;
-    auto marked = std::vector<bool>(xbitNumber, false);
-    auto reached = std::unordered_map<Node::Ref, uint32_t>();
     auto order = Ordering();
     auto it = graph.build_iterator();
 
-    std::set<Node::Ref> processed;
-    std::vector<Xbit> xbits;
-
-    for (uint32_t i = 0; i < qubitNumber; ++i) {
-        it.next(i);
-        xbits.push_back(Xbit::Q(i));
-    }
+    // Number of xbits that already reached each gate.
+    std::vector<uint32_t> arrived(graph.getNumberOfGates(), 0);
+    // Qubits whose current gate is a one-qubit gate.
+    std::vector<uint32_t> singles, nextSingles;
+    // Gates (with more than one xbit) that all of their xbits reached,
+    // with the first of their xbits (they are emitted in this order).
+    std::vector<std::pair<uint32_t, uint32_t>> ready, nextReady;
+    std::vector<Node::Ref> layer;
+
+    auto advance = [&](uint32_t x,
+                       std::vector<uint32_t>& singlesOut,
+                       std::vector<std::pair<uint32_t, uint32_t>>& readyOut) {
+        it.next(x);
+        auto cnode = it[x];
+
+        if (!cnode.isGateNode()) return;
+
+        if (x < qubitNumber && cnode.numberOfXbits() == 1) {
+            singlesOut.push_back(x);
+        } else if (++arrived[cnode.id()] == cnode.numberOfXbits()) {
+            auto xbits = cnode.getXbitsId();
+            readyOut.push_back(std::make_pair(*std::min_element(xbits.begin(), xbits.end()),
+                                              cnode.id()));
+        }
+    };
 
-    for (uint32_t i = 0; i < cbitNumber; ++i) {
-        it.next(i + qubitNumber);
-        xbits.push_back(Xbit::C(i));
+    for (uint32_t i = 0; i < xbitNumber; ++i) {
+        advance(i, singles, ready);
     }
 
-    do {
-        stop = true;
-
+    while (!singles.empty() || !ready.empty()) {
         // Emit U-gates that may be executed in parallel.
         // However, we want to schedule the controlled gates only, as they
         // are the only gates that affects qubit allocation.
-        do {
-            Layer layer;
-            ugate = false;
-
-            for (uint32_t i = 0; i < qubitNumber; ++i) {
-                auto qubit = xbits[i];
+        std::sort(singles.begin(), singles.end());
 
-                if (it[qubit]->isGateNode() && it[qubit]->numberOfXbits() == 1) {
-                    auto node = it[qubit]->node();
-                    layer.push_back(node);
-                    processed.insert(node);
-
-                    it.next(qubit);
-                    ugate = true;
-                }
-            }
+        while (!singles.empty()) {
+            layer.clear();
+            nextSingles.clear();
 
-            if (!layer.empty()) {
-                for (auto node : layer)
-                    order.push_back(getNodeId(node));
-                layers.push_back(layer);
+            for (auto qubit : singles) {
+                layer.push_back(it.get(qubit));
+                order.push_back(it[qubit].id());
+                advance(qubit, nextSingles, ready);
             }
-        } while (ugate);
 
-        Layer layer;
-        // Reach gates with non-marked xbits and mark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto bit = xbits[i];
-
-            if (it[bit]->isGateNode() && !marked[i]) {
-                marked[i] = true;
-
-                auto node = it[bit]->node();
-
-                if (reached.find(node) == reached.end())
-                    reached[node] = it[bit]->numberOfXbits();
-                --reached[node];
-            }
+            layers.append(layer);
+            std::swap(singles, nextSingles);
         }
 
-        // Advance the xbits and unmark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto bit = xbits[i];
-            auto node = it[bit]->node();
+        // Emit the gates that all of their xbits reached, and advance them.
+        // The gates reached by now wait for the next round.
+        std::sort(ready.begin(), ready.end());
 
-            if (it[bit]->isGateNode() && !reached[node]) {
+        layer.clear();
+        nextReady.clear();
 
-                if (processed.find(node) == processed.end()) {
-                    layer.push_back(node);
-                    processed.insert(node);
-                }
+        for (auto& pair : ready) {
+            auto cnode = graph.getGate(pair.second);
+            layer.push_back(cnode.node());
+            order.push_back(pair.second);
 
-                marked[i] = false;
-                it.next(bit);
+            for (auto x : cnode.getXbitsId()) {
+                advance(x, singles, nextReady);
             }
-
-            // If the xbits in the processed nodes haven't reached the end (output nodes)
-            // we keep going.
-            if (!it[bit]->isOutputNode()) stop = false;
         }
 
-
-        if (!layer.empty()) {
-            for (auto node : layer)
-                order.push_back(getNodeId(node));
-            layers.push_back(layer);
-        }
-    } while (!stop);
+        if (!layer.empty()) layers.append(layer);
+        std::swap(ready, nextReady);
+    }
 
     return order;
 }
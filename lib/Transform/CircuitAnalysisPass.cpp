@@ -0,0 +1,75 @@
+#include "enfield/Transform/CircuitAnalysisPass.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/LayersBuilderPass.h"
+#include "enfield/Transform/PassCache.h"
+
+using namespace efd;
+
+uint8_t CircuitAnalysisPass::ID = 0;
+
+CircuitAnalysisPass::CircuitAnalysisPass() {
+    preserve<XbitToNumberWrapperPass>();
+    preserve<GateStreamBuilderPass>();
+    preserve<DependencyBuilderWrapperPass>();
+    preserve<CircuitGraphBuilderPass>();
+    preserve<LayersBuilderPass>();
+}
+
+bool CircuitAnalysisPass::run(QModule::Ref qmod) {
+    // Flattening does not change the xbits. So, they are numbered before
+    // the statements are walked (only the declarations are needed).
+    std::shared_ptr<XbitToNumberWrapperPass> xtonPass = XbitToNumberWrapperPass::Create();
+    xtonPass->run(qmod);
+    auto& xton = xtonPass->getData();
+
+    std::shared_ptr<GateStreamBuilderPass> gsPass = GateStreamBuilderPass::Create();
+    auto& stream = gsPass->getData();
+    stream.init(xton);
+
+    QModule::ReplacementMap repMap;
+    std::vector<Node::uRef> flattened;
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        if (FlattenStatement(qmod, it->get(), flattened)) {
+            // The new statements are added to the stream before being moved
+            // into the module. Moving them keeps the nodes it refers to.
+            for (auto& stmt : flattened) stream.append(stmt.get(), xton);
+
+            repMap[it->get()] = std::move(flattened);
+            flattened.clear();
+        } else {
+            stream.append(it->get(), xton);
+        }
+    }
+
+    bool changed = !repMap.empty();
+    if (changed) qmod->replaceStatements(std::move(repMap));
+
+    // The other analyses only need the resolved operands. Each one is built
+    // by its own loop over the stream, which is faster than building them
+    // all in the loop above (their nodes would be interleaved in memory).
+    std::shared_ptr<DependencyBuilderWrapperPass> depPass = DependencyBuilderWrapperPass::Create();
+    depPass->getData().build(qmod, xton, stream);
+
+    std::shared_ptr<CircuitGraphBuilderPass> cgPass = CircuitGraphBuilderPass::Create();
+    cgPass->getData() = BuildCircuitGraph(stream);
+
+    std::shared_ptr<LayersBuilderPass> layersPass = LayersBuilderPass::Create();
+    layersPass->getData() = BuildLayers(stream);
+
+    PassCache::Publish(qmod, xtonPass);
+    PassCache::Publish(qmod, gsPass);
+    PassCache::Publish(qmod, depPass);
+    PassCache::Publish(qmod, cgPass);
+    PassCache::Publish(qmod, layersPass);
+
+    return changed;
+}
+
+CircuitAnalysisPass::uRef CircuitAnalysisPass::Create() {
+    return uRef(new CircuitAnalysisPass());
+}
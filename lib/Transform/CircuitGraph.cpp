@@ -60,96 +60,121 @@ Xbit Xbit::C(uint32_t id) {
 // --------------------- CircuitNode Class ------------------------
 // ----------------------------------------------------------------
 
-CircuitGraph::CircuitNode::CircuitNode(Type type) : mType(type), mNode(nullptr) {}
+const uint32_t CircuitGraph::CircuitNode::Input = _undef - 1;
+const uint32_t CircuitGraph::CircuitNode::Output = _undef;
 
-Node::Ref CircuitGraph::CircuitNode::node() {
-    return mNode;
+CircuitGraph::CircuitNode::CircuitNode(const CircuitGraph* graph, uint32_t id)
+    : mGraph(graph), mId(id) {}
+
+CircuitGraph::CircuitNode::CircuitNode() : mGraph(nullptr), mId(Output) {}
+
+Node::Ref CircuitGraph::CircuitNode::node() const {
+    if (!isGateNode()) return nullptr;
+    return mGraph->mGateNode[mId];
+}
+
+uint32_t CircuitGraph::CircuitNode::id() const {
+    EfdAbortIf(!isGateNode(), "Only gate nodes have an id.");
+    return mId;
 }
 
-uint32_t CircuitGraph::CircuitNode::numberOfXbits() {
-    return mStepMap.size();
+uint32_t CircuitGraph::CircuitNode::numberOfXbits() const {
+    return getXbitsId().size();
 }
 
-bool CircuitGraph::CircuitNode::isOutputNode() {
-    return mType == CircuitNode::Type::OUTPUT;
+bool CircuitGraph::CircuitNode::isOutputNode() const {
+    return mId == Output;
 }
 
-bool CircuitGraph::CircuitNode::isInputNode() {
-    return mType == CircuitNode::Type::INPUT;
+bool CircuitGraph::CircuitNode::isInputNode() const {
+    return mId == Input;
 }
 
-bool CircuitGraph::CircuitNode::isGateNode() {
+bool CircuitGraph::CircuitNode::isGateNode() const {
     return !isInputNode() && !isOutputNode();
 }
 
-std::vector<Xbit> CircuitGraph::CircuitNode::getXbits(uint32_t qubits, uint32_t cbits) {
+std::vector<Xbit> CircuitGraph::CircuitNode::getXbits(uint32_t qubits, uint32_t cbits) const {
     std::vector<Xbit> xbits;
-    for (auto& pair : mStepMap) {
-        xbits.push_back(Xbit(pair.first, qubits, cbits));
+    for (auto id : getXbitsId()) {
+        xbits.push_back(Xbit(id, qubits, cbits));
     }
 
     return xbits;
 }
 
-std::vector<uint32_t> CircuitGraph::CircuitNode::getXbitsId() {
-    std::vector<uint32_t> xbitsId;
-    for (auto& pair : mStepMap) {
-        xbitsId.push_back(pair.first);
-    }
+Slice<uint32_t> CircuitGraph::CircuitNode::getXbitsId() const {
+    if (!isGateNode()) return Slice<uint32_t>(nullptr, nullptr);
+
+    auto slots = mGraph->mSlotXbit.data();
+    return Slice<uint32_t>(slots + mGraph->mGateSlotsBegin[mId],
+                           slots + mGraph->mGateSlotsBegin[mId + 1]);
+}
 
-    return xbitsId;
+bool CircuitGraph::CircuitNode::operator==(const CircuitNode& rhs) const {
+    return mId == rhs.mId;
+}
+
+bool CircuitGraph::CircuitNode::operator!=(const CircuitNode& rhs) const {
+    return mId != rhs.mId;
+}
+
+bool CircuitGraph::CircuitNode::operator<(const CircuitNode& rhs) const {
+    return mId < rhs.mId;
 }
 
 // ----------------------------------------------------------------
 // ----------------- CircuitGraph::Iterator Class -----------------
 // ----------------------------------------------------------------
 
-CircuitGraph::Iterator::Iterator(uint32_t qubits,
-                                 uint32_t cbits,
-                                 std::vector<CircuitNode::sRef> ptr) :
-                                 mQubits(qubits),
-                                 mCbits(cbits),
-                                 mPtr(ptr) {}
+CircuitGraph::Iterator::Iterator(const CircuitGraph* graph) : mGraph(graph), mSlot(graph->size()) {
+    // The input slots are the first ones.
+    for (uint32_t i = 0, e = mSlot.size(); i < e; ++i) {
+        mSlot[i] = i;
+    }
+}
 
-CircuitGraph::Iterator::Iterator() : mQubits(0), mCbits(0), mPtr(0) {}
+CircuitGraph::Iterator::Iterator() : mGraph(nullptr) {}
 
 bool CircuitGraph::Iterator::next(uint32_t id) {
-    if (mPtr[id]->isOutputNode()) return false;
-    mPtr[id] = mPtr[id]->mStepMap[id].second;
+    uint32_t next = mGraph->mSlotNext[mSlot[id]];
+    if (next == _undef) return false;
+    mSlot[id] = next;
     return true;
 }
 
 bool CircuitGraph::Iterator::next(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return next(id);
 }
 
 bool CircuitGraph::Iterator::back(uint32_t id) {
-    if (mPtr[id]->isInputNode()) return false;
-    mPtr[id] = mPtr[id]->mStepMap[id].first;
+    uint32_t prev = mGraph->mSlotPrev[mSlot[id]];
+    if (prev == _undef) return false;
+    mSlot[id] = prev;
     return true;
 }
 
 bool CircuitGraph::Iterator::back(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return back(id);
 }
 
-Node::Ref CircuitGraph::Iterator::get(uint32_t id) {
-    return mPtr[id]->mNode;
+Node::Ref CircuitGraph::Iterator::get(uint32_t id) const {
+    return (*this)[id].node();
 }
 
-Node::Ref CircuitGraph::Iterator::get(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+Node::Ref CircuitGraph::Iterator::get(Xbit xbit) const {
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return get(id);
 }
 
-CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](uint32_t id) {
-    return mPtr[id];
+CircuitGraph::CircuitNode CircuitGraph::Iterator::operator[](uint32_t id) const {
+    return CircuitNode(mGraph, mGraph->mSlotGate[mSlot[id]]);
 }
 
-CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+CircuitGraph::CircuitNode CircuitGraph::Iterator::operator[](Xbit xbit) const {
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return (*this)[id];
 }
 
@@ -157,7 +182,7 @@ CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](Xbit xbit) {
 // -------------------- CircuitGraph Class ------------------------
 // ----------------------------------------------------------------
 
-CircuitGraph::CircuitGraph() : mInit(false) {}
+CircuitGraph::CircuitGraph() : mInit(false), mQubits(0), mCbits(0) {}
 
 CircuitGraph::CircuitGraph(uint32_t qubits, uint32_t cbits) {
     init(qubits, cbits);
@@ -168,19 +193,32 @@ void CircuitGraph::init(uint32_t qubits, uint32_t cbits) {
     mQubits = qubits;
     mCbits = cbits;
 
-    mGraphHead.assign(mQubits + mCbits,
-                      CircuitNode::sRef(new CircuitNode(CircuitNode::Type::INPUT)));
-    mGraphTail.assign(mQubits + mCbits,
-                      CircuitNode::sRef(new CircuitNode(CircuitNode::Type::OUTPUT)));
-
-    // Initializing the head to point to the tail, and the tail to the head.
-    for (uint32_t i = 0, e = mQubits + mCbits; i < e; ++i) {
-        mGraphHead[i]->mStepMap[i] = std::make_pair(nullptr, mGraphTail[i]);
-        mGraphTail[i]->mStepMap[i] = std::make_pair(mGraphHead[i], nullptr);
+    uint32_t xbits = mQubits + mCbits;
+
+    // The input slots come first, followed by the output slots.
+    // Initially, each input slot points to the output slot, and vice versa.
+    mSlotXbit.resize(2 * xbits);
+    mSlotGate.resize(2 * xbits);
+    mSlotPrev.resize(2 * xbits);
+    mSlotNext.resize(2 * xbits);
+
+    for (uint32_t i = 0; i < xbits; ++i) {
+        mSlotXbit[i] = i;
+        mSlotGate[i] = CircuitNode::Input;
+        mSlotPrev[i] = _undef;
+        mSlotNext[i] = xbits + i;
+
+        mSlotXbit[xbits + i] = i;
+        mSlotGate[xbits + i] = CircuitNode::Output;
+        mSlotPrev[xbits + i] = i;
+        mSlotNext[xbits + i] = _undef;
     }
+
+    mGateNode.clear();
+    mGateSlotsBegin.assign(1, 2 * xbits);
 }
 
-void CircuitGraph::checkInitialized() {
+void CircuitGraph::checkInitialized() const {
     EfdAbortIf(!mInit, "Trying to append a node to an uninitialized CircuitGraph.");
 }
 
@@ -196,25 +234,51 @@ uint32_t CircuitGraph::size() const {
     return mQubits + mCbits;
 }
 
-void CircuitGraph::append(std::vector<Xbit> xbits, Node::Ref node) {
+uint32_t CircuitGraph::getNumberOfGates() const {
+    return mGateNode.size();
+}
+
+CircuitGraph::CircuitNode CircuitGraph::getGate(uint32_t id) const {
+    EfdAbortIf(id >= mGateNode.size(),
+               "Gate `" << id << "` out of bounds (`" << mGateNode.size() << "` gates).");
+    return CircuitNode(this, id);
+}
+
+void CircuitGraph::append(const std::vector<Xbit>& xbits, Node::Ref node) {
     checkInitialized();
 
-    CircuitNode::sRef newNode(new CircuitNode(CircuitNode::Type::GATE));
-    newNode->mNode = node;
+    uint32_t gate = mGateNode.size();
+    uint32_t begin = mSlotXbit.size();
+    uint32_t outputBegin = size();
 
     for (auto xbit : xbits) {
         uint32_t id = xbit.getRealId(mQubits, mCbits);
 
-        auto lastNode = mGraphTail[id]->mStepMap[id].first;
-        lastNode->mStepMap[id].second = newNode;
-        newNode->mStepMap[id] = std::make_pair(lastNode, mGraphTail[id]);
-        mGraphTail[id]->mStepMap[id].first = newNode;
+        bool repeated = false;
+        for (uint32_t i = begin, e = mSlotXbit.size(); i < e && !repeated; ++i) {
+            repeated = mSlotXbit[i] == id;
+        }
+
+        if (repeated) continue;
+
+        uint32_t slot = mSlotXbit.size();
+        uint32_t output = outputBegin + id;
+        uint32_t last = mSlotPrev[output];
+
+        mSlotXbit.push_back(id);
+        mSlotGate.push_back(gate);
+        mSlotPrev.push_back(last);
+        mSlotNext.push_back(output);
+
+        mSlotNext[last] = slot;
+        mSlotPrev[output] = slot;
     }
+
+    mGateNode.push_back(node);
+    mGateSlotsBegin.push_back(mSlotXbit.size());
 }
 
-CircuitGraph::Iterator CircuitGraph::build_iterator() {
+CircuitGraph::Iterator CircuitGraph::build_iterator() const {
     checkInitialized();
-
-    Iterator iterator(mQubits, mCbits, mGraphHead);
-    return iterator;
+    return Iterator(this);
 }
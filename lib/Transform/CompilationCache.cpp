@@ -0,0 +1,235 @@
+#include "enfield/Transform/CompilationCache.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Support/Defs.h"
+#include "enfield/Support/Stats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+using namespace efd;
+
+static const char* EntryMagic = "EFDC2";
+static const char* TmpSuffix = ".tmp";
+
+static Stat<uint32_t> CacheHits
+("CacheHits", "Number of compilations found in the compilation cache.");
+static Stat<uint32_t> CacheMisses
+("CacheMisses", "Number of compilations not found in the compilation cache.");
+
+namespace {
+    /// \brief 128-bit FNV-1a.
+    class Hasher {
+        private:
+            typedef unsigned __int128 UInt128;
+            UInt128 mHash;
+
+        public:
+            Hasher() {
+                mHash = ((UInt128) 0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+            }
+
+            void update(const std::string& str) {
+                static const UInt128 Prime = ((UInt128) 0x0000000001000000ULL << 64) |
+                                             0x000000000000013BULL;
+
+                for (unsigned char c : str) {
+                    mHash ^= c;
+                    mHash *= Prime;
+                }
+
+                // Separates consecutive strings.
+                mHash ^= 0xff;
+                mHash *= Prime;
+            }
+
+            std::string hex() const {
+                static const char* Digits = "0123456789abcdef";
+                std::string str(32, '0');
+
+                UInt128 hash = mHash;
+                for (int32_t i = 31; i >= 0; --i, hash >>= 4) {
+                    str[i] = Digits[(uint32_t) (hash & 0xf)];
+                }
+
+                return str;
+            }
+    };
+}
+
+CompilationCache::CompilationCache(std::string dir, uint64_t maxBytes)
+    : mDir(dir), mMaxBytes(maxBytes) {
+    if (mDir.empty() || mDir.back() != '/') mDir += '/';
+    ::mkdir(mDir.c_str(), 0755);
+}
+
+std::string CompilationCache::getPath(const std::string& key) const {
+    return mDir + key;
+}
+
+/// \brief Reads the entry stored in \p path.
+static bool ReadEntry(const std::string& path, CompilationCache::Entry& entry) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    std::string magic;
+    uint64_t length;
+    uint32_t statsSize;
+    in >> magic >> entry.quality.mDepth >> entry.quality.mGates
+       >> entry.quality.mWeightedCost >> length >> statsSize;
+
+    if (!in || magic != EntryMagic || in.get() != '\n') return false;
+
+    entry.stats.clear();
+    for (uint32_t i = 0; i < statsSize; ++i) {
+        StatRecord record;
+        in >> record.mName >> record.mValue;
+        if (!in || in.get() != '\n') return false;
+        entry.stats.push_back(record);
+    }
+
+    entry.output.assign(length, '\0');
+    in.read(&entry.output[0], length);
+    return (uint64_t) in.gcount() == length;
+}
+
+bool CompilationCache::lookup(const std::string& key, Entry& entry) {
+    auto path = getPath(key);
+
+    if (!ReadEntry(path, entry)) {
+        CacheMisses += 1;
+        return false;
+    }
+
+    // Marks it as recently used.
+    ::utime(path.c_str(), nullptr);
+    CacheHits += 1;
+    return true;
+}
+
+void CompilationCache::store(const std::string& key, const Entry& entry) {
+    auto path = getPath(key);
+
+    std::ostringstream tmpName;
+    tmpName << path << "." << ::getpid() << "." << std::this_thread::get_id() << TmpSuffix;
+    auto tmpPath = tmpName.str();
+
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        if (!out.is_open()) {
+            WAR << "Could not write to the cache: `" << tmpPath << "`." << std::endl;
+            return;
+        }
+
+        out << EntryMagic << " " << entry.quality.mDepth << " " << entry.quality.mGates
+            << " " << entry.quality.mWeightedCost << " " << entry.output.size()
+            << " " << entry.stats.size() << "\n";
+
+        // Only the name and the value are needed for restoring a stat.
+        for (auto& record : entry.stats) {
+            out << record.mName << " " << record.mValue << "\n";
+        }
+
+        out << entry.output;
+    }
+
+    // Readers either see the whole entry or none.
+    ::rename(tmpPath.c_str(), path.c_str());
+    evict(path);
+}
+
+void CompilationCache::evict(const std::string& keep) {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    struct FileInfo {
+        std::string path;
+        uint64_t mtime;
+        uint64_t size;
+    };
+
+    std::vector<FileInfo> files;
+    uint64_t total = 0;
+
+    if (auto dir = ::opendir(mDir.c_str())) {
+        while (auto dirEntry = ::readdir(dir)) {
+            std::string name = dirEntry->d_name;
+            std::string path = mDir + name;
+            struct stat st;
+
+            bool isTmp = name.size() >= 4 && name.compare(name.size() - 4, 4, TmpSuffix) == 0;
+
+            if (name[0] == '.' || isTmp ||
+                ::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+                continue;
+            }
+
+            uint64_t mtime = (uint64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+            files.push_back(FileInfo { path, mtime, (uint64_t) st.st_size });
+            total += st.st_size;
+        }
+
+        ::closedir(dir);
+    }
+
+    if (total <= mMaxBytes) return;
+
+    std::sort(files.begin(), files.end(), [](const FileInfo& lhs, const FileInfo& rhs) {
+        return lhs.mtime < rhs.mtime;
+    });
+
+    for (auto& file : files) {
+        if (total <= mMaxBytes) break;
+        if (file.path == keep) continue;
+        if (::unlink(file.path.c_str()) == 0) total -= file.size;
+    }
+}
+
+std::string CompilationCache::ComputeKey(QModule::Ref qmod,
+                                         const CompilationSettings& settings,
+                                         const std::string& extra) {
+    PassCache::Run<FlattenPass>(qmod);
+
+    Hasher hasher;
+    hasher.update(EntryMagic);
+    hasher.update(qmod->toString(false));
+
+    auto archGraph = settings.archGraph;
+    hasher.update(archGraph->dotify());
+    for (auto it = archGraph->reg_begin(), end = archGraph->reg_end(); it != end; ++it) {
+        hasher.update(it->first + "[" + std::to_string(it->second) + "]");
+    }
+
+    hasher.update(settings.allocator.getStringValue());
+    for (auto& pair : settings.gWeightMap) {
+        hasher.update(pair.first + ":" + std::to_string(pair.second));
+    }
+
+    auto& options = settings.allocatorOptions;
+    hasher.update(std::to_string(options.seed));
+    hasher.update(std::to_string(options.trials));
+    hasher.update(std::to_string(options.bmtMaxChildren));
+    hasher.update(std::to_string(options.bmtMaxPartial));
+    hasher.update(std::to_string(options.bmtMaxMapSeq));
+    hasher.update(std::to_string(options.sabreLookAhead));
+    hasher.update(std::to_string(options.sabreIterations));
+    for (auto& name : options.portfolio) hasher.update(name);
+    hasher.update(std::to_string(options.portfolioThreshold));
+    hasher.update(std::to_string(options.portfolioDeadline));
+
+    hasher.update(std::to_string(settings.reorder) + std::to_string(settings.verify) +
+                  std::to_string(settings.force));
+    hasher.update(extra);
+
+    return hasher.hex();
+}
+
+CompilationCache::uRef CompilationCache::Create(std::string dir, uint64_t maxBytes) {
+    return uRef(new CompilationCache(dir, maxBytes));
+}
@@ -0,0 +1,521 @@
+#include "enfield/Transform/CompileServer.h"
+#include "enfield/Support/JsonParser.h"
+#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/Defs.h"
+
+#include <sstream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace efd;
+
+namespace {
+    /// \brief Buffered stream over a connected socket.
+    class SocketStreamBuf : public std::streambuf {
+        private:
+            static const std::size_t BufferSize = 1 << 14;
+
+            int mFd;
+            char mIn[BufferSize];
+            char mOut[BufferSize];
+
+        public:
+            SocketStreamBuf(int fd) : mFd(fd) {
+                setg(mIn, mIn, mIn);
+                setp(mOut, mOut + BufferSize);
+            }
+
+            ~SocketStreamBuf() {
+                sync();
+            }
+
+        protected:
+            int_type underflow() override {
+                ssize_t n;
+
+                do {
+                    n = ::recv(mFd, mIn, BufferSize, 0);
+                } while (n < 0 && errno == EINTR);
+
+                if (n <= 0) return traits_type::eof();
+
+                setg(mIn, mIn, mIn + n);
+                return traits_type::to_int_type(*gptr());
+            }
+
+            int_type overflow(int_type c) override {
+                if (sync() != 0) return traits_type::eof();
+
+                if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                    *pptr() = traits_type::to_char_type(c);
+                    pbump(1);
+                }
+
+                return traits_type::not_eof(c);
+            }
+
+            int sync() override {
+                char* begin = pbase();
+
+                while (begin < pptr()) {
+                    ssize_t n = ::send(mFd, begin, pptr() - begin, MSG_NOSIGNAL);
+
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        return -1;
+                    }
+
+                    begin += n;
+                }
+
+                setp(mOut, mOut + BufferSize);
+                return 0;
+            }
+    };
+}
+
+static bool ParseUInt(const std::string& str, uint32_t& val) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(str.c_str(), &end, 10);
+
+    if (str.empty() || *end != '\0' || errno != 0 ||
+        parsed > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    val = parsed;
+    return true;
+}
+
+static bool ParseDouble(const std::string& str, double& val) {
+    char* end = nullptr;
+    errno = 0;
+    val = std::strtod(str.c_str(), &end);
+    return !str.empty() && *end == '\0' && errno == 0;
+}
+
+static bool ParseBool(const std::string& str, bool& val) {
+    if (str == "1" || str == "true") val = true;
+    else if (str == "0" || str == "false") val = false;
+    else return false;
+    return true;
+}
+
+/// \brief Parses a list of `<gate>:<weight>` separated by spaces.
+static bool ParseGateWeights(const std::string& str, GateWeightMap& weights) {
+    std::istringstream iss(str);
+    GateWeightMap parsed;
+
+    for (std::string entry; iss >> entry;) {
+        auto colon = entry.find(':');
+        uint32_t weight;
+
+        if (colon == std::string::npos || colon == 0 ||
+            !ParseUInt(entry.substr(colon + 1), weight)) {
+            return false;
+        }
+
+        parsed[entry.substr(0, colon)] = weight;
+    }
+
+    if (parsed.empty()) return false;
+
+    weights = parsed;
+    return true;
+}
+
+static std::vector<std::string> SplitList(const std::string& str) {
+    std::vector<std::string> list;
+    std::istringstream iss(str);
+
+    for (std::string item; std::getline(iss, item, ',');) {
+        if (!item.empty()) list.push_back(item);
+    }
+
+    return list;
+}
+
+static void WriteResponse(std::ostream& out,
+                          const std::vector<std::pair<std::string, std::string>>& header,
+                          const std::string& body) {
+    for (auto& entry : header) {
+        out << entry.first << "=" << entry.second << "\n";
+    }
+
+    out << "length=" << body.size() << "\n\n" << body;
+    out.flush();
+}
+
+static void WriteError(std::ostream& out, const std::string& message) {
+    WriteResponse(out, { { "status", "error" }, { "message", message } }, "");
+}
+
+/// \brief The socket being listened on, shut down by the signal handler.
+static std::atomic<int> SignalledListenFd(-1);
+static volatile std::sig_atomic_t Signalled = 0;
+
+static void StopOnSignal(int) {
+    Signalled = 1;
+
+    int fd = SignalledListenFd.load();
+    if (fd >= 0) ::shutdown(fd, SHUT_RDWR);
+}
+
+/// \brief Builds the distances of \p archGraph, so that they are ready for
+/// the allocators of every request.
+static void WarmUp(ArchGraph::sRef archGraph) {
+    if (archGraph.get() != nullptr) {
+        BFSCachedDistance::GetDistanceMatrix(archGraph.get());
+    }
+}
+
+CompileServer::CompileServer(CompilationSettings defaults)
+    : mDefaults(defaults), mCache(nullptr), mStopped(false), mListenFd(-1) {
+    WarmUp(mDefaults.archGraph);
+}
+
+void CompileServer::setCache(CompilationCache::Ref cache) {
+    mCache = cache;
+}
+
+ArchGraph::sRef CompileServer::getArchitecture(const std::string& name, bool isFile) {
+    std::string key = (isFile ? "file:" : "") + name;
+
+    std::unique_lock<std::mutex> lock(mArchsMutex);
+    auto it = mArchs.find(key);
+    if (it != mArchs.end()) return it->second;
+
+    ArchGraph::sRef archGraph;
+
+    if (isFile) {
+        archGraph = JsonParser<ArchGraph>::ParseFile(name);
+    } else if (EnumArchitecture::Has(name) && HasArchitecture(EnumArchitecture(name))) {
+        archGraph = CreateArchitecture(EnumArchitecture(name));
+    }
+
+    if (archGraph.get() != nullptr) {
+        WarmUp(archGraph);
+        mArchs[key] = archGraph;
+    }
+
+    return archGraph;
+}
+
+std::string CompileServer::applyHeader(const Header& header,
+                                       CompilationSettings& settings,
+                                       bool& pretty,
+                                       bool& stats) {
+    auto& options = settings.allocatorOptions;
+
+    for (auto& entry : header) {
+        const std::string& key = entry.first;
+        const std::string& val = entry.second;
+        bool ok = true;
+
+        if (key == "length") {
+            continue;
+        } else if (key == "arch" || key == "arch-file") {
+            settings.archGraph = getArchitecture(val, key == "arch-file");
+            ok = settings.archGraph.get() != nullptr;
+        } else if (key == "alloc") {
+            ok = EnumAllocator::Has(val) && HasAllocator(EnumAllocator(val));
+            if (ok) settings.allocator = EnumAllocator(val);
+        } else if (key == "gate-w") {
+            ok = ParseGateWeights(val, settings.gWeightMap);
+        } else if (key == "seed") {
+            ok = ParseUInt(val, options.seed);
+        } else if (key == "trials") {
+            ok = ParseUInt(val, options.trials);
+        } else if (key == "bmt-max-children") {
+            ok = ParseUInt(val, options.bmtMaxChildren);
+        } else if (key == "bmt-max-partial") {
+            ok = ParseUInt(val, options.bmtMaxPartial);
+        } else if (key == "bmt-max-mapseq") {
+            ok = ParseUInt(val, options.bmtMaxMapSeq);
+        } else if (key == "sabre-lookahead") {
+            ok = ParseUInt(val, options.sabreLookAhead);
+        } else if (key == "sabre-iterations") {
+            ok = ParseUInt(val, options.sabreIterations);
+        } else if (key == "portfolio") {
+            options.portfolio = SplitList(val);
+        } else if (key == "portfolio-threshold") {
+            ok = ParseDouble(val, options.portfolioThreshold);
+        } else if (key == "portfolio-deadline") {
+            ok = ParseUInt(val, options.portfolioDeadline);
+        } else if (key == "reorder") {
+            ok = ParseBool(val, settings.reorder);
+        } else if (key == "verify") {
+            ok = ParseBool(val, settings.verify);
+        } else if (key == "force") {
+            ok = ParseBool(val, settings.force);
+        } else if (key == "pretty") {
+            ok = ParseBool(val, pretty);
+        } else if (key == "stats") {
+            ok = ParseBool(val, stats);
+        } else {
+            return "Unknown key: `" + key + "`.";
+        }
+
+        if (!ok) return "Invalid value for `" + key + "`: `" + val + "`.";
+    }
+
+    return "";
+}
+
+bool CompileServer::serveOne(std::istream& in, std::ostream& out) {
+    Header header;
+    std::string line;
+
+    // Skipping the empty lines before the header.
+    while (std::getline(in, line) && line.empty());
+    if (!in) return false;
+
+    do {
+        auto eq = line.find('=');
+
+        if (eq == std::string::npos) {
+            WriteError(out, "Malformed header line: `" + line + "`.");
+            return false;
+        }
+
+        header[line.substr(0, eq)] = line.substr(eq + 1);
+    } while (std::getline(in, line) && !line.empty());
+
+    if (header.find("quit") != header.end()) {
+        WriteResponse(out, { { "status", "ok" } }, "");
+        stop();
+        return false;
+    }
+
+    uint32_t length;
+    auto it = header.find("length");
+
+    if (it == header.end() || !ParseUInt(it->second, length)) {
+        // The body can't be skipped without its length.
+        WriteError(out, "Missing or invalid `length`.");
+        return false;
+    }
+
+    if (length > MaxBodyLength) {
+        // Nor is it worth reading, only to be skipped.
+        WriteError(out, "Body too long (max " + std::to_string(MaxBodyLength) + " bytes).");
+        return false;
+    }
+
+    std::string body(length, '\0');
+    in.read(&body[0], length);
+    if ((uint32_t) in.gcount() != length) return false;
+
+    auto settings = mDefaults;
+    bool pretty = true;
+    bool stats = false;
+
+    auto error = applyHeader(header, settings, pretty, stats);
+    if (!error.empty()) {
+        WriteError(out, error);
+        return true;
+    }
+
+    if (settings.archGraph.get() == nullptr) {
+        WriteError(out, "No architecture.");
+        return true;
+    }
+
+    auto qmod = QModule::ParseString(body);
+    if (qmod.get() == nullptr) {
+        WriteError(out, "Could not parse the program.");
+        return true;
+    }
+
+    StatScope scope;
+    StatScope::Binding binding(&scope);
+
+    CompilationCache::Entry entry;
+    std::string key;
+    bool cached = false;
+
+    if (mCache != nullptr) {
+        // Same module and settings printed differently must not share an entry.
+        key = CompilationCache::ComputeKey(qmod.get(), settings,
+                                           "server:" + std::to_string(pretty));
+        cached = mCache->lookup(key, entry);
+    }
+
+    if (cached) {
+        RestoreStats(entry.stats);
+    } else {
+        // Collects the stats of the compilation alone, so that they can be cached.
+        StatScope compileScope;
+
+        {
+            StatScope::Binding compileBinding(&compileScope);
+
+            qmod = Compile(std::move(qmod), settings);
+
+            if (qmod.get() != nullptr) {
+                std::ostringstream compiled;
+                qmod->print(compiled, pretty);
+
+                entry.output = compiled.str();
+                entry.quality = EvaluateQuality(qmod.get(), settings.archGraph,
+                                                settings.gWeightMap);
+                if (mCache != nullptr) entry.stats = CollectStats();
+            }
+        }
+
+        compileScope.mergeIntoCurrent();
+
+        if (qmod.get() == nullptr) {
+            WriteError(out, "Compilation failed.");
+            return true;
+        }
+
+        if (mCache != nullptr) mCache->store(key, entry);
+    }
+
+    auto& quality = entry.quality;
+
+    std::vector<std::pair<std::string, std::string>> response {
+        { "status", "ok" },
+        { "Depth", std::to_string(quality.mDepth) },
+        { "Gates", std::to_string(quality.mGates) },
+        { "WeightedCost", std::to_string(quality.mWeightedCost) }
+    };
+
+    if (stats) {
+        std::ostringstream json;
+        PrintStatsJson(CollectStats(), json);
+        response.push_back(std::make_pair("stats", json.str()));
+    }
+
+    WriteResponse(out, response, entry.output);
+
+    return true;
+}
+
+void CompileServer::serve(std::istream& in, std::ostream& out) {
+    while (!mStopped && serveOne(in, out));
+}
+
+void CompileServer::serveStdio() {
+    auto stdoutBuf = std::cout.rdbuf(std::cerr.rdbuf());
+    std::ostream out(stdoutBuf);
+
+    serve(std::cin, out);
+
+    std::cout.rdbuf(stdoutBuf);
+}
+
+bool CompileServer::serveUnixSocket(const std::string& path, uint32_t threads) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(addr.sun_path)) {
+        ERR << "Socket path too long: `" << path << "`." << std::endl;
+        return false;
+    }
+
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str());
+
+    if (sock < 0 ||
+        ::bind(sock, (sockaddr*) &addr, sizeof(addr)) < 0 ||
+        ::listen(sock, SOMAXCONN) < 0) {
+        ERR << "Could not listen on `" << path << "`: " << std::strerror(errno) << std::endl;
+        if (sock >= 0) ::close(sock);
+        return false;
+    }
+
+    INF << "Listening on `" << path << "`." << std::endl;
+
+    struct sigaction action, oldInt, oldTerm;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = StopOnSignal;
+    sigemptyset(&action.sa_mask);
+
+    mListenFd = sock;
+    SignalledListenFd = sock;
+    Signalled = 0;
+    ::sigaction(SIGINT, &action, &oldInt);
+    ::sigaction(SIGTERM, &action, &oldTerm);
+
+    bool success = true;
+
+    {
+        ThreadPool pool(threads);
+
+        while (!mStopped && !Signalled) {
+            int conn = ::accept(sock, nullptr, nullptr);
+
+            if (conn < 0) {
+                if (mStopped || Signalled) break;
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                ERR << "Could not accept a connection: " << std::strerror(errno) << std::endl;
+                success = false;
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mConnectionsMutex);
+                mConnections.insert(conn);
+            }
+
+            pool.enqueue([this, conn]() {
+                {
+                    SocketStreamBuf buf(conn);
+                    std::istream in(&buf);
+                    std::ostream out(&buf);
+                    serve(in, out);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mConnectionsMutex);
+                    mConnections.erase(conn);
+                }
+
+                ::close(conn);
+            });
+        }
+
+        // The pending connections must end before the pool is joined.
+        stop();
+    }
+
+    ::sigaction(SIGINT, &oldInt, nullptr);
+    ::sigaction(SIGTERM, &oldTerm, nullptr);
+    SignalledListenFd = -1;
+    mListenFd = -1;
+
+    INF << "Stopped listening on `" << path << "`." << std::endl;
+
+    ::close(sock);
+    ::unlink(path.c_str());
+    return success;
+}
+
+void CompileServer::stop() {
+    mStopped = true;
+
+    int fd = mListenFd.load();
+    if (fd >= 0) ::shutdown(fd, SHUT_RDWR);
+
+    std::lock_guard<std::mutex> lock(mConnectionsMutex);
+    for (int conn : mConnections) ::shutdown(conn, SHUT_RD);
+}
+
+CompileServer::uRef CompileServer::Create(CompilationSettings defaults) {
+    return uRef(new CompileServer(defaults));
+}
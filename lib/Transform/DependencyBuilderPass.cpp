@@ -1,5 +1,7 @@
 #include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
 #include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/Utils.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/Defs.h"
@@ -127,6 +129,34 @@ namespace efd {
     };
 }
 
+static efd::Dependencies ComposeCallDeps(efd::QModule& qmod,
+                                         efd::DependencyBuilder& depBuilder,
+                                         efd::NDQOp::Ref call,
+                                         const std::vector<uint32_t>& uidVector) {
+    using namespace efd;
+
+    // Getting the gate declaration node.
+    Node::Ref node = qmod.getQGate(call->getId()->getVal());
+    NDGateDecl::Ref gRef = dynCast<NDGateDecl>(node);
+
+    EfdAbortIf(gRef == nullptr,
+               "There is no quantum gate with this id: `" << node->toString(false) << "`.");
+
+    auto& gDeps = depBuilder.mLDeps[gRef];
+    Dependencies thisDeps { {}, call };
+    // For every qarg uint32_t representation
+    for (auto parallelDeps : gDeps) {
+        for (auto dep : parallelDeps) {
+            // Getting the uid's of the qubit interaction (u, v)
+            uint32_t u = uidVector[dep.mFrom];
+            uint32_t v = uidVector[dep.mTo];
+            thisDeps.mDeps.push_back(Dep { u, v });
+        }
+    }
+
+    return thisDeps;
+}
+
 efd::NDGateDecl::Ref efd::DependencyBuilderVisitor::getParentGate(Node::Ref ref) {
     NDGOpList::Ref goplist = nullptr;
 
@@ -176,24 +206,7 @@ void efd::DependencyBuilderVisitor::visit(NDQOpGen::Ref ref) {
     for (auto& childRef : *ref->getQArgs())
         uidVector.push_back(mDepBuilder.getUId(childRef.get(), gate));
 
-    // Getting the gate declaration node.
-    Node::Ref node = mMod.getQGate(ref->getId()->getVal());
-    NDGateDecl::Ref gRef = dynCast<NDGateDecl>(node);
-
-    EfdAbortIf(gRef == nullptr,
-               "There is no quantum gate with this id: `" << node->toString(false) << "`.");
-
-    auto& gDeps = mDepBuilder.mLDeps[gRef];
-    Dependencies thisDeps { {}, ref };
-    // For every qarg uint32_t representation
-    for (auto parallelDeps : gDeps) {
-        for (auto dep : parallelDeps) {
-            // Getting the uid's of the qubit interaction (u, v)
-            uint32_t u = uidVector[dep.mFrom];
-            uint32_t v = uidVector[dep.mTo];
-            thisDeps.mDeps.push_back(Dep { u, v });
-        }
-    }
+    auto thisDeps = ComposeCallDeps(mMod, mDepBuilder, ref, uidVector);
 
     if (!thisDeps.empty())
         deps->push_back(thisDeps);
@@ -209,24 +222,72 @@ void efd::DependencyBuilderVisitor::visit(NDGOpList::Ref ref) {
     visitChildren(ref);
 }
 
-bool efd::DependencyBuilderWrapperPass::run(QModule::Ref qmod) {
-    mData.mLDeps.clear();
-    mData.mGDeps.clear();
-    mData.mIDeps.clear();
+void efd::DependencyBuilder::build(QModule::Ref qmod, const XbitToNumber& xtn,
+                                   const GateStream& stream) {
+    mLDeps.clear();
+    mGDeps.clear();
+    mIDeps.clear();
 
-    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto data = xtn->getData();
-    mData.setXbitToNumber(data);
+    mXbitToNumber = xtn;
 
-    DependencyBuilderVisitor visitor(*qmod, mData);
+    // The dependencies inside the gate declarations are still computed from
+    // the AST, since they are local to each gate.
+    DependencyBuilderVisitor visitor(*qmod, *this);
     for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
         (*it)->apply(&visitor);
     }
 
-    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
-        (*it)->apply(&visitor);
+    // The global statements use the already resolved operands.
+    for (uint32_t i = 0, e = stream.size(); i < e; ++i) {
+        auto pair = GetStatementPair(stream.getNode(i));
+        auto ifstmt = pair.first;
+        auto qop = pair.second;
+        auto qargs = stream.getQArgs(i);
+
+        if (ifstmt != nullptr) {
+            mIDeps[ifstmt] = Dependencies();
+        }
+
+        switch (stream.getKind(i)) {
+            case GateStream::Kind::U:
+            case GateStream::Kind::MEASURE:
+            case GateStream::Kind::RESET:
+            case GateStream::Kind::BARRIER:
+                continue;
+
+            default:
+                break;
+        }
+
+        uint32_t nofQArgs = qop->getQArgs()->getChildNumber();
+
+        // Single qbit gate.
+        if (stream.getKind(i) != GateStream::Kind::CX && nofQArgs == 1) continue;
+
+        EfdAbortIf(qargs.size() != nofQArgs,
+                   "Can't compute dependencies of call with register operands: `"
+                   << qop->toString(false) << "`.");
+
+        if (stream.getKind(i) == GateStream::Kind::CX) {
+            // CX controlQ, invertQ;
+            Dependencies depV { { Dep { qargs[0], qargs[1] } }, qop };
+            mGDeps.push_back(depV);
+            mIDeps[qop] = depV;
+        } else {
+            std::vector<uint32_t> uidVector(qargs.begin(), qargs.end());
+            auto thisDeps = ComposeCallDeps(*qmod, *this, qop, uidVector);
+
+            if (!thisDeps.empty())
+                mGDeps.push_back(thisDeps);
+            mIDeps[qop] = thisDeps;
+        }
     }
+}
 
+bool efd::DependencyBuilderWrapperPass::run(QModule::Ref qmod) {
+    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod);
+    auto gsPass = PassCache::Get<GateStreamBuilderPass>(qmod);
+    mData.build(qmod, xtn->getData(), gsPass->getData());
     return false;
 }
 
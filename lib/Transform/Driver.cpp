@@ -5,11 +5,13 @@
 #include "enfield/Transform/ArchVerifierPass.h"
 #include "enfield/Transform/CNOTLBOWrapperPass.h"
 #include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/Allocators/Allocators.h"
 #include "enfield/Transform/DependencyGraphBuilderPass.h"
 #include "enfield/Arch/Architectures.h"
 #include "enfield/Support/Stats.h"
+#include "enfield/Support/TimingReport.h"
 #include "enfield/Support/Defs.h"
 
 using namespace efd;
@@ -22,15 +24,19 @@ static Stat<double> StatDepGraphDensity
 ("DGDensity", "Density of the dependency graph.");
 
 QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
+    TimingScope scope("Compile");
+
     bool success = true;
     QModule::uRef qmodCopy;
 
+    PassCache::Run<FlattenPass>(qmod.get());
+
     if (settings.verify) {
-        qmodCopy = qmod->clone();
+        // The statements are only copied if they are modified in place. The
+        // allocators usually replace the whole list, so it is never copied.
+        qmodCopy = qmod->cloneShared();
     }
 
-    PassCache::Run<FlattenPass>(qmod.get());
-
     if (settings.reorder) {
         PassCache::Run<CNOTLBOWrapperPass>(qmod.get());
     }
@@ -38,13 +44,17 @@ QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
     auto xbitPass = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
     auto xbitToNumber = xbitPass->getData(); 
 
-    EfdAbortIf(xbitToNumber.getQSize() > settings.archGraph->size(),
-               "Using more qbits than the maximum permitted by the architecture (max `"
-               << settings.archGraph->size() << "`): `"
-               << xbitToNumber.getQSize() << "`.");
+    // Not aborting, so that a batch of compilations may go on.
+    if (xbitToNumber.getQSize() > settings.archGraph->size()) {
+        ERR << "Using more qbits than the maximum permitted by the architecture (max `"
+            << settings.archGraph->size() << "`): `"
+            << xbitToNumber.getQSize() << "`." << std::endl;
+        return QModule::uRef(nullptr);
+    }
 
     auto allocPass = CreateQbitAllocator(settings.allocator, settings.archGraph);
     allocPass->setGateWeightMap(settings.gWeightMap);
+    allocPass->setOptions(settings.allocatorOptions);
     PassCache::Run(qmod.get(), allocPass.get());
 
     auto revPass = ReverseEdgesPass::Create(settings.archGraph);
@@ -81,6 +91,26 @@ QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
     return qmod;
 }
 
+QModuleQuality efd::EvaluateQuality(QModule::Ref qmod,
+                                    ArchGraph::sRef archGraph,
+                                    const GateWeightMap& weights) {
+    TimingScope scope("EvaluateQuality");
+
+    auto inlinePass = InlineAllPass::Create(ExtractGateNames(weights));
+    auto reversePass = ReverseEdgesPass::Create(archGraph);
+    auto qualityPass = QModuleQualityEvalPass::Create(weights);
+    PassCache::Run(qmod, inlinePass.get());
+
+    // From here on, only the gates created by the reversal are left to be
+    // inlined. So, they are inlined as they are created, instead of running
+    // the inline pass over the whole module again.
+    reversePass->setInlineAll(ExtractGateNames(weights));
+    PassCache::Run(qmod, reversePass.get());
+
+    PassCache::Run(qmod, qualityPass.get());
+    return qualityPass->getData();
+}
+
 QModule::uRef efd::ParseFile(std::string filepath) {
     QModule::uRef qmod(nullptr);
     std::string path;
@@ -98,6 +128,7 @@ QModule::uRef efd::ParseFile(std::string filepath) {
             filename = filepath;
         }
 
+        TimingScope scope("Parse");
         qmod.reset(QModule::Parse(filename, path).release());
     }
 
@@ -105,6 +136,7 @@ QModule::uRef efd::ParseFile(std::string filepath) {
 }
 
 void efd::PrintToStream(QModule::Ref qmod, std::ostream& o, bool pretty) {
+    TimingScope scope("Print");
     qmod->print(o, pretty);
 }
 
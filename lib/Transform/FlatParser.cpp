@@ -0,0 +1,482 @@
+#include "enfield/Transform/FlatParser.h"
+#include "enfield/Transform/Utils.h"
+#include "enfield/Analysis/Driver.h"
+#include "enfield/Support/uRefCast.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+using namespace efd;
+
+/// \brief Integers with more digits than this are left to the full parser.
+static const uint32_t MaxSafeIntDigits = 18;
+
+/// \brief Returns the names of every gate declared by the standard library.
+static const std::unordered_set<std::string>& GetStdLibGateNames() {
+    static const std::unordered_set<std::string> Names = [] {
+        std::unordered_set<std::string> names;
+
+        for (auto& filename : GetStdLibFilenames()) {
+            for (auto& gate : *GetStdLibGates(filename)) {
+                names.insert(gate->getId()->getVal());
+            }
+        }
+
+        return names;
+    }();
+
+    return Names;
+}
+
+static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool IsLower(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+static bool IsIdChar(char c) {
+    return IsLower(c) || (c >= 'A' && c <= 'Z') || IsDigit(c) || c == '_';
+}
+
+namespace {
+    /// \brief Recursive descent parser for the flat subset of the language.
+    ///
+    /// It reads the same tokens as \em EfdScanner, and creates the same nodes
+    /// as the full parser would.
+    class FlatParser {
+        private:
+            const char* mCur;
+            const char* mEnd;
+            QModule::uRef mQMod;
+            std::vector<Node::uRef> mStmts;
+            bool mHasInclude;
+
+            /// \brief Skips spaces, line breaks and comments.
+            void skipSpaces();
+            /// \brief Returns true if there is nothing but spaces left.
+            bool atEnd();
+            /// \brief Returns the next character (after the spaces), or
+            /// '\\0' if there is none.
+            char peek();
+            /// \brief Consumes \p c, if it is the next character.
+            bool accept(char c);
+            /// \brief Consumes `->`, if it is next.
+            bool acceptArrow();
+            /// \brief Consumes an identifier (or keyword), if it is next.
+            bool acceptWord(std::string& word);
+            /// \brief Consumes \p prefix, if it is next.
+            bool acceptPrefix(const char* prefix, uint32_t length);
+
+            Node::uRef parseNumber(bool intOnly);
+            NDInt::uRef parseInt();
+            NDId::uRef parseId();
+            Node::uRef parseArg();
+            NDList::uRef parseArgs();
+            NDList::uRef parseQArgs();
+            Node::uRef parseUnary();
+            Node::uRef parseExp(uint32_t minPrecedence);
+
+            bool parseVersion();
+            bool parseInclude();
+            bool parseRegDecl(bool isQuantum);
+            bool parseStatement();
+
+            void insertInclude(const std::string& filename);
+
+        public:
+            FlatParser(const char* begin, const char* end, QModule::uRef qmod);
+
+            /// \brief Parses the whole input, returning nullptr if it is not
+            /// in the flat subset.
+            QModule::uRef parse();
+    };
+}
+
+FlatParser::FlatParser(const char* begin, const char* end, QModule::uRef qmod)
+    : mCur(begin), mEnd(end), mQMod(std::move(qmod)), mHasInclude(false) {}
+
+void FlatParser::skipSpaces() {
+    while (mCur != mEnd) {
+        char c = *mCur;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            ++mCur;
+        } else if (c == '/' && mCur + 1 != mEnd && mCur[1] == '/') {
+            while (mCur != mEnd && *mCur != '\n') ++mCur;
+        } else {
+            break;
+        }
+    }
+}
+
+bool FlatParser::atEnd() {
+    skipSpaces();
+    return mCur == mEnd;
+}
+
+char FlatParser::peek() {
+    skipSpaces();
+    return (mCur == mEnd) ? '\0' : *mCur;
+}
+
+bool FlatParser::accept(char c) {
+    if (peek() != c) return false;
+    ++mCur;
+    return true;
+}
+
+bool FlatParser::acceptArrow() {
+    return acceptPrefix("->", 2);
+}
+
+bool FlatParser::acceptWord(std::string& word) {
+    if (!IsLower(peek())) return false;
+
+    const char* begin = mCur;
+    while (mCur != mEnd && IsIdChar(*mCur)) ++mCur;
+
+    word.assign(begin, mCur);
+    return true;
+}
+
+bool FlatParser::acceptPrefix(const char* prefix, uint32_t length) {
+    skipSpaces();
+
+    if ((uint32_t) (mEnd - mCur) < length || std::memcmp(mCur, prefix, length) != 0) {
+        return false;
+    }
+
+    mCur += length;
+    return true;
+}
+
+Node::uRef FlatParser::parseNumber(bool intOnly) {
+    char c = peek();
+    if (!IsDigit(c) && c != '.') return nullptr;
+
+    // Same rules as the scanner: an integer is either `0` or has no
+    // leading zeros.
+    const char* begin = mCur;
+    bool isReal = false;
+
+    if (c == '0') ++mCur;
+    else while (mCur != mEnd && IsDigit(*mCur)) ++mCur;
+
+    if (mCur != mEnd && *mCur == '.') {
+        isReal = true;
+        for (++mCur; mCur != mEnd && IsDigit(*mCur); ++mCur);
+    }
+
+    if (mCur != mEnd && (*mCur == 'e' || *mCur == 'E')) {
+        const char* exp = mCur + 1;
+        if (exp != mEnd && (*exp == '+' || *exp == '-')) ++exp;
+
+        if (exp != mEnd && IsDigit(*exp)) {
+            isReal = true;
+            for (mCur = exp; mCur != mEnd && IsDigit(*mCur); ++mCur);
+        }
+    }
+
+    std::string str(begin, mCur);
+
+    if (isReal) {
+        if (intOnly) return nullptr;
+        return NDReal::Create(RealVal(std::strtod(str.c_str(), nullptr), str));
+    }
+
+    if (str.length() > MaxSafeIntDigits) return nullptr;
+
+    long long val = 0;
+    for (char digit : str) val = val * 10 + (digit - '0');
+    return NDInt::Create(IntVal(val, str));
+}
+
+NDInt::uRef FlatParser::parseInt() {
+    auto number = parseNumber(true);
+    if (number.get() == nullptr) return nullptr;
+    return uniqueCastForward<NDInt>(std::move(number));
+}
+
+NDId::uRef FlatParser::parseId() {
+    std::string word;
+    if (!acceptWord(word)) return nullptr;
+
+    // Keywords are not identifiers.
+    static const std::unordered_set<std::string> Keywords = {
+        "include", "opaque", "if", "barrier", "qreg", "creg", "gate", "measure",
+        "reset", "sin", "cos", "tan", "exp", "ln", "sqrt"
+    };
+
+    if (Keywords.count(word)) return nullptr;
+    return NDId::Create(std::move(word));
+}
+
+Node::uRef FlatParser::parseArg() {
+    // Whole registers are left to the full parser (and to FlattenPass).
+    auto id = parseId();
+    if (id.get() == nullptr || !accept('[')) return nullptr;
+
+    auto index = parseInt();
+    if (index.get() == nullptr || !accept(']')) return nullptr;
+
+    return NDIdRef::Create(std::move(id), std::move(index));
+}
+
+NDList::uRef FlatParser::parseArgs() {
+    auto args = NDList::Create();
+    if (!accept('(') || accept(')')) return args;
+
+    do {
+        auto exp = parseExp(0);
+        if (exp.get() == nullptr) return nullptr;
+        args->addChild(std::move(exp));
+    } while (accept(','));
+
+    if (!accept(')')) return nullptr;
+    return args;
+}
+
+NDList::uRef FlatParser::parseQArgs() {
+    auto qargs = NDList::Create();
+
+    do {
+        auto arg = parseArg();
+        if (arg.get() == nullptr) return nullptr;
+        qargs->addChild(std::move(arg));
+    } while (accept(','));
+
+    return qargs;
+}
+
+Node::uRef FlatParser::parseUnary() {
+    char c = peek();
+
+    // The full parser gives the unary `-` the precedence of the binary one.
+    // So, its operand goes up to the next `+` or `-`.
+    if (c == '-') {
+        if (acceptArrow()) return nullptr;
+        ++mCur;
+
+        auto operand = parseExp(2);
+        if (operand.get() == nullptr) return nullptr;
+        return NDUnaryOp::CreateNeg(std::move(operand));
+    }
+
+    if (c == '(') {
+        ++mCur;
+
+        auto exp = parseExp(0);
+        if (exp.get() == nullptr || !accept(')')) return nullptr;
+        return exp;
+    }
+
+    if (IsDigit(c) || c == '.') {
+        return parseNumber(false);
+    }
+
+    static const std::pair<const char*, NDUnaryOp::UOpType> Functions[] = {
+        { "sin", NDUnaryOp::UOP_SIN },
+        { "cos", NDUnaryOp::UOP_COS },
+        { "tan", NDUnaryOp::UOP_TAN },
+        { "exp", NDUnaryOp::UOP_EXP },
+        { "ln", NDUnaryOp::UOP_LN },
+        { "sqrt", NDUnaryOp::UOP_SQRT }
+    };
+
+    const char* begin = mCur;
+    std::string word;
+
+    if (acceptWord(word)) {
+        for (auto& function : Functions) {
+            if (word == function.first) {
+                if (!accept('(')) return nullptr;
+
+                auto exp = parseExp(0);
+                if (exp.get() == nullptr || !accept(')')) return nullptr;
+                return NDUnaryOp::Create(function.second, std::move(exp));
+            }
+        }
+
+        mCur = begin;
+        return parseId();
+    }
+
+    return nullptr;
+}
+
+Node::uRef FlatParser::parseExp(uint32_t minPrecedence) {
+    auto lhs = parseUnary();
+
+    while (lhs.get() != nullptr) {
+        NDBinOp::OpType op;
+        uint32_t precedence;
+
+        // Every binary operator is left associative.
+        switch (peek()) {
+            case '+': op = NDBinOp::OP_ADD; precedence = 1; break;
+            case '-': op = NDBinOp::OP_SUB; precedence = 1; break;
+            case '*': op = NDBinOp::OP_MUL; precedence = 2; break;
+            case '/': op = NDBinOp::OP_DIV; precedence = 2; break;
+            case '^': op = NDBinOp::OP_POW; precedence = 3; break;
+            default: return lhs;
+        }
+
+        if (precedence < minPrecedence) break;
+        if (op == NDBinOp::OP_SUB && mCur + 1 != mEnd && mCur[1] == '>') return nullptr;
+        ++mCur;
+
+        auto rhs = parseExp(precedence + 1);
+        if (rhs.get() == nullptr) return nullptr;
+        lhs = NDBinOp::Create(op, std::move(lhs), std::move(rhs));
+    }
+
+    return lhs;
+}
+
+bool FlatParser::parseVersion() {
+    auto version = parseNumber(false);
+
+    // Like \em ProcessAST, the version is not kept in the module.
+    return instanceOf<NDReal>(version.get()) && accept(';');
+}
+
+bool FlatParser::parseInclude() {
+    // Strings go up to the last quote of the line, as in the scanner.
+    if (peek() != '"') return false;
+
+    const char* last = nullptr;
+    for (const char* it = mCur + 1; it != mEnd && *it != '\n'; ++it) {
+        if (*it == '"') last = it;
+    }
+
+    if (last == nullptr) return false;
+
+    std::string filename(mCur + 1, last);
+    mCur = last + 1;
+
+    // Other files may declare gates, so they are left to the full parser.
+    if (!accept(';') || mHasInclude || GetStdLibGates(filename) == nullptr) {
+        return false;
+    }
+
+    insertInclude(filename);
+    mHasInclude = true;
+    return true;
+}
+
+bool FlatParser::parseRegDecl(bool isQuantum) {
+    auto id = parseId();
+    if (id.get() == nullptr || !accept('[')) return false;
+
+    auto size = parseInt();
+    if (size.get() == nullptr || !accept(']') || !accept(';')) return false;
+
+    if (isQuantum) mQMod->insertReg(NDRegDecl::CreateQ(std::move(id), std::move(size)));
+    else mQMod->insertReg(NDRegDecl::CreateC(std::move(id), std::move(size)));
+    return true;
+}
+
+bool FlatParser::parseStatement() {
+    Node::uRef stmt;
+
+    if (acceptPrefix("CX", 2)) {
+        auto lhs = parseArg();
+        if (lhs.get() == nullptr || !accept(',')) return false;
+
+        auto rhs = parseArg();
+        if (rhs.get() == nullptr) return false;
+
+        stmt = NDQOpCX::Create(std::move(lhs), std::move(rhs));
+    } else if (accept('U')) {
+        auto args = parseArgs();
+        if (args.get() == nullptr) return false;
+
+        auto arg = parseArg();
+        if (arg.get() == nullptr) return false;
+
+        stmt = NDQOpU::Create(std::move(args), std::move(arg));
+    } else {
+        std::string word;
+        if (!acceptWord(word)) return false;
+
+        if (word == "include") return parseInclude();
+        if (word == "qreg") return parseRegDecl(true);
+        if (word == "creg") return parseRegDecl(false);
+
+        if (word == "measure") {
+            auto qarg = parseArg();
+            if (qarg.get() == nullptr || !acceptArrow()) return false;
+
+            auto carg = parseArg();
+            if (carg.get() == nullptr) return false;
+
+            stmt = NDQOpMeasure::Create(std::move(qarg), std::move(carg));
+        } else if (word == "reset") {
+            auto arg = parseArg();
+            if (arg.get() == nullptr) return false;
+
+            stmt = NDQOpReset::Create(std::move(arg));
+        } else if (word == "barrier") {
+            auto qargs = parseQArgs();
+            if (qargs.get() == nullptr) return false;
+
+            stmt = NDQOpBarrier::Create(std::move(qargs));
+        } else if (GetStdLibGateNames().count(word)) {
+            auto args = parseArgs();
+            if (args.get() == nullptr) return false;
+
+            auto qargs = parseQArgs();
+            if (qargs.get() == nullptr) return false;
+
+            stmt = NDQOpGen::Create(NDId::Create(std::move(word)), std::move(args), std::move(qargs));
+        } else {
+            // Gate declarations, `if` statements and calls to user gates.
+            return false;
+        }
+    }
+
+    if (!accept(';')) return false;
+
+    mStmts.push_back(std::move(stmt));
+    return true;
+}
+
+void FlatParser::insertInclude(const std::string& filename) {
+    mQMod->insertInclude(NDInclude::Create
+            (NDString::Create(filename), uniqueCastBackward<Node>(NDStmtList::Create())));
+
+    for (auto& gate : *GetStdLibGates(filename)) {
+        mQMod->insertSharedGate(gate);
+    }
+}
+
+QModule::uRef FlatParser::parse() {
+    if (acceptPrefix("OPENQASM", 8) && !parseVersion()) return nullptr;
+
+    while (!atEnd()) {
+        if (!parseStatement()) return nullptr;
+    }
+
+    // The full parser inserts each of them at the front of the program.
+    if (!mHasInclude) {
+        auto filenames = GetStdLibFilenames();
+        for (auto it = filenames.rbegin(), e = filenames.rend(); it != e; ++it) {
+            insertInclude(*it);
+        }
+    }
+
+    for (auto& gate : GetIntrinsicGates()) {
+        mQMod->insertSharedGate(gate);
+    }
+
+    mQMod->insertStatementLast(std::move(mStmts));
+    return std::move(mQMod);
+}
+
+QModule::uRef efd::ParseFlatProgram(const char* begin, const char* end) {
+    FlatParser parser(begin, end, QModule::uRef(new QModule()));
+    return parser.parse();
+}
@@ -1,8 +1,11 @@
 #include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/GateTemplate.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace efd;
@@ -11,17 +14,13 @@ namespace efd {
     class FlattenVisitor;
 }
 
-static bool IsIdRef(Node::Ref ref);
 static bool IsId(Node::Ref ref);
-static bool HasAnyNDIdChild(Node::Ref ref);
 
 static NDRegDecl::Ref GetDeclFromId(const QModule::Ref qmod, Node::Ref ref);
 static uint32_t GetIdDeclSize(const QModule::Ref qmod, Node::Ref ref);
-static std::vector<NDIdRef::uRef> ToIdRef(const QModule::Ref qmod, Node::Ref ref, uint32_t max);
-static std::vector<std::vector<NDIdRef::uRef>>
-GetFlattenedOpsArgs(const QModule::Ref qmod, std::vector<Node::Ref> qcargs);
 
-static Node::uRef WrapWithIfStmt(Node::Ref ifnode, Node::uRef node);
+static void FlattenVisitQOperation(FlattenVisitor* visitor, Node::Ref ifstmt, NDQOp::Ref ref,
+                                   const std::vector<Node::Ref>& operands);
 static void FlattenVisitQOperation(FlattenVisitor* visitor, Node::Ref ifstmt, NDQOp::Ref ref);
 
 uint8_t efd::FlattenPass::ID = 0;
@@ -33,9 +32,11 @@ namespace efd {
             Node::Ref mIf;
 
         public:
-            std::unordered_map<Node::Ref, std::vector<Node::uRef>> mRepMap;
+            std::vector<Node::uRef>& mFlattened;
+            bool mChanged;
 
-            FlattenVisitor(QModule& qmod) : mMod(qmod), mIf(nullptr) {}
+            FlattenVisitor(QModule& qmod, std::vector<Node::uRef>& flattened)
+                : mMod(qmod), mIf(nullptr), mFlattened(flattened), mChanged(false) {}
 
             QModule::Ref getQMod() const;
 
@@ -58,23 +59,7 @@ void efd::FlattenVisitor::visit(NDQOpBarrier::Ref ref) {
 }
 
 void efd::FlattenVisitor::visit(NDQOpMeasure::Ref ref) {
-    if (HasAnyNDIdChild(ref))
-        return;
-
-    Node::Ref key = (mIf == nullptr) ? (Node::Ref) ref : mIf;
-
-    std::vector<Node::uRef> newNodes;
-    auto flatArgs = GetFlattenedOpsArgs(&mMod, { ref->getQBit(), ref->getCBit() });
-
-    if (!flatArgs.empty()) {
-
-        for (uint32_t i = 0, e = flatArgs[0].size(); i < e; ++i) {
-            auto qop = NDQOpMeasure::Create(std::move(flatArgs[0][i]), std::move(flatArgs[1][i]));
-            newNodes.push_back(WrapWithIfStmt(mIf, std::move(qop)));
-        }
-
-        mRepMap[key] = std::move(newNodes);;
-    }
+    FlattenVisitQOperation(this, mIf, (NDQOp::Ref) ref, { ref->getQBit(), ref->getCBit() });
 }
 
 void efd::FlattenVisitor::visit(NDQOpReset::Ref ref) {
@@ -100,19 +85,23 @@ void efd::FlattenVisitor::visit(NDIfStmt::Ref ref) {
 }
 
 efd::FlattenPass::FlattenPass() {
+    preserve<XbitToNumberWrapperPass>();
 }
 
 bool efd::FlattenPass::run(QModule::Ref qmod) {
-    FlattenVisitor visitor(*qmod);
+    QModule::ReplacementMap repMap;
+    std::vector<Node::uRef> flattened;
 
     for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
-        (*it)->apply(&visitor);
+        if (FlattenStatement(qmod, it->get(), flattened)) {
+            repMap[it->get()] = std::move(flattened);
+            flattened.clear();
+        }
     }
 
-    for (auto& pair : visitor.mRepMap) {
-        qmod->replaceStatement(pair.first, std::move(pair.second));
-    }
+    if (repMap.empty()) return false;
 
+    qmod->replaceStatements(std::move(repMap));
     return true;
 }
 
@@ -120,24 +109,21 @@ FlattenPass::uRef efd::FlattenPass::Create() {
     return uRef(new FlattenPass());
 }
 
+bool efd::FlattenStatement(QModule::Ref qmod, Node::Ref stmt,
+                           std::vector<Node::uRef>& flattened) {
+    FlattenVisitor visitor(*qmod, flattened);
+    stmt->apply(&visitor);
+    return visitor.mChanged;
+}
+
 // ----------------------------------------------------------------
 // --------------------- Static Functions -------------------------
 // ----------------------------------------------------------------
 
-static bool IsIdRef(Node::Ref ref) {
-    return instanceOf<NDIdRef>(ref);
-}
-
 static bool IsId(Node::Ref ref) {
     return instanceOf<NDId>(ref);
 }
 
-static bool HasAnyNDIdChild(Node::Ref ref) {
-    for (auto& child : *ref)
-        if (IsId(child.get())) return false;
-    return true;
-}
-
 static NDRegDecl::Ref GetDeclFromId(const QModule::Ref qmod, Node::Ref ref) {
     NDId::Ref refId = dynCast<NDId>(ref);
     EfdAbortIf(refId == nullptr, "Not an Id: `" << ref->toString(false) << "`.");
@@ -155,89 +141,55 @@ static uint32_t GetIdDeclSize(const QModule::Ref qmod, Node::Ref ref) {
     return GetDeclFromId(qmod, ref)->getSize()->getVal().mV;
 }
 
-static std::vector<NDIdRef::uRef> ToIdRef(const QModule::Ref qmod, Node::Ref ref, uint32_t max) {
-    std::vector<NDIdRef::uRef> idRefV;
-
-    if (IsIdRef(ref)) {
-        for (uint32_t i = 0; i < max; ++i)
-            idRefV.push_back(uniqueCastForward<NDIdRef>(ref->clone()));
-        return idRefV;
-    }
+static void FlattenVisitQOperation(FlattenVisitor* visitor, Node::Ref ifstmt, NDQOp::Ref ref,
+                                   const std::vector<Node::Ref>& operands) {
+    QModule::Ref qmod = visitor->getQMod();
 
-    NDRegDecl::Ref refDecl = GetDeclFromId(qmod, ref);
-    uint32_t i = 0, e = refDecl->getSize()->getVal().mV;
+    // The whole registers used are the slots of the template. It is
+    // expanded once for each bit of the smallest one.
+    std::vector<Node::Ref> registers;
+    uint32_t bits = std::numeric_limits<uint32_t>::max();
 
-    if (max != 0) e = std::max(max, e);
-    for (; i < e; ++i) {
-        std::string strVal = std::to_string(i);
-        idRefV.push_back(NDIdRef::Create
-                (uniqueCastForward<NDId>(ref->clone()), NDInt::Create(strVal)));
+    for (auto operand : operands) {
+        if (IsId(operand)) {
+            registers.push_back(operand);
+            bits = std::min(bits, GetIdDeclSize(qmod, operand));
+        }
     }
 
-    return idRefV;
-}
+    if (registers.empty()) return;
 
-static std::vector<std::vector<NDIdRef::uRef>>
-GetFlattenedOpsArgs(const QModule::Ref qmod, std::vector<Node::Ref> qcargs) {
-    std::vector<std::vector<NDIdRef::uRef>> newNodesArgs;
-    const uint32_t uint32max = std::numeric_limits<uint32_t>::max();
+    auto tmpl = GateTemplate::Create(ref, registers);
+    auto& newNodes = visitor->mFlattened;
+    std::vector<Node::uRef> bitRefs(registers.size());
+    std::vector<Node::Ref> slots(registers.size());
 
-    uint32_t min = uint32max;
+    for (uint32_t i = 0; i < bits; ++i) {
+        std::string strVal = std::to_string(i);
 
-    for (auto child : qcargs) {
-        if (IsId(child)) {
-            auto declsize = GetIdDeclSize(qmod, child);
-            if (declsize < min) min = declsize;
+        for (uint32_t j = 0, e = registers.size(); j < e; ++j) {
+            bitRefs[j] = NDIdRef::Create
+                (uniqueCastForward<NDId>(registers[j]->clone()), NDInt::Create(strVal));
+            slots[j] = bitRefs[j].get();
         }
-    }
 
-    if (min != uint32max) {
-        for (auto child : qcargs) {
-            newNodesArgs.push_back(ToIdRef(qmod, child, min));
-        }
+        tmpl->expand(slots, newNodes, dynCast<NDIfStmt>(ifstmt));
     }
 
-    return newNodesArgs;
-}
-
-static Node::uRef WrapWithIfStmt(Node::Ref ifnode, Node::uRef node) {
-    auto wrapped = std::move(node);
-
-    if (ifnode != nullptr) {
-        auto ifstmt = uniqueCastForward<NDIfStmt>(ifnode->clone());
-        ifstmt->setQOp(uniqueCastForward<NDQOp>(std::move(wrapped)));
-        wrapped = std::move(ifstmt);
-    }
-
-    return wrapped;
+    visitor->mChanged = true;
 }
 
 static void FlattenVisitQOperation(FlattenVisitor* visitor, Node::Ref ifstmt, NDQOp::Ref ref) {
-    if (HasAnyNDIdChild(ref->getQArgs()))
-        return;
-
-    std::vector<Node::uRef> newNodes;
+    auto list = ref->getQArgs();
 
-    QModule::Ref qmod = visitor->getQMod();
-    Node::Ref key = (ifstmt == nullptr) ? (Node::Ref) ref : ifstmt;
-
-    std::vector<Node::Ref> qcargs;
-    for (auto& child : *ref->getQArgs()) qcargs.push_back(child.get());
-
-    auto flatArgs = GetFlattenedOpsArgs(qmod, qcargs);
-
-    if (!flatArgs.empty()) {
-        for (uint32_t i = 0, e = flatArgs[0].size(); i < e; ++i) {
-            auto qaList = NDList::Create();
-
-            for (auto& qarg : flatArgs)
-                qaList->addChild(std::move(qarg[i]));
-
-            auto clone = uniqueCastForward<NDQOp>(ref->clone());
-            clone->setQArgs(std::move(qaList));
-            newNodes.push_back(WrapWithIfStmt(ifstmt, std::move(clone)));
-        }
-
-        visitor->mRepMap[key] = std::move(newNodes);;
+    // Most of the operations are already flat. So, the operands are only
+    // collected if one of them is a whole register.
+    if (std::none_of(list->begin(), list->end(),
+                     [](const Node::uRef& child) { return IsId(child.get()); })) {
+        return;
     }
+
+    std::vector<Node::Ref> qargs;
+    for (auto& child : *list) qargs.push_back(child.get());
+    FlattenVisitQOperation(visitor, ifstmt, ref, qargs);
 }
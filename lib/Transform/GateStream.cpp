@@ -0,0 +1,324 @@
+#include "enfield/Transform/GateStream.h"
+#include "enfield/Transform/Utils.h"
+#include "enfield/Support/RTTI.h"
+#include "enfield/Support/uRefCast.h"
+#include "enfield/Support/Defs.h"
+
+using namespace efd;
+
+static void AppendXbitUIds(Node::Ref ref,
+                           const XbitToNumber& xton,
+                           std::vector<uint32_t>& uids,
+                           bool& isFlat) {
+    if (auto idref = dynCast<NDIdRef>(ref)) {
+        auto regname = idref->getId()->getVal();
+        auto idx = idref->getN()->getVal().mV;
+
+        auto it = xton.gidRegMap.find(regname);
+        EfdAbortIf(it == xton.gidRegMap.end() || idx < 0 || idx >= (long long) it->second.size(),
+                   "Xbit not found: `" << ref->toString(false) << "`.");
+
+        uids.push_back(it->second[idx]);
+    } else if (auto id = dynCast<NDId>(ref)) {
+        // The whole register is being used.
+        auto regUIds = xton.getRegUIds(id->getVal());
+        uids.insert(uids.end(), regUIds.begin(), regUIds.end());
+        isFlat = false;
+    } else {
+        EfdAbortIf(true, "Unknown xbit operand: `" << ref->toString(false) << "`.");
+    }
+}
+
+static GateStream::Kind GetGateStreamKind(NDQOp::Ref qop) {
+    if (qop->isCX()) return GateStream::Kind::CX;
+    if (qop->isU()) return GateStream::Kind::U;
+    if (qop->isMeasure()) return GateStream::Kind::MEASURE;
+    if (qop->isReset()) return GateStream::Kind::RESET;
+    if (qop->isBarrier()) return GateStream::Kind::BARRIER;
+
+    if (IsIntrinsicGateCall(qop)) {
+        switch (GetIntrinsicKind(qop)) {
+            case NDQOpGen::K_INTRINSIC_SWAP: return GateStream::Kind::INTRINSIC_SWAP;
+            case NDQOpGen::K_INTRINSIC_REV_CX: return GateStream::Kind::INTRINSIC_REV_CX;
+            case NDQOpGen::K_INTRINSIC_LCX: return GateStream::Kind::INTRINSIC_LCX;
+        }
+    }
+
+    return GateStream::Kind::GEN;
+}
+
+GateStream::GateStream() : mQubits(0), mCbits(0), mIsFlat(true) {}
+
+uint32_t GateStream::internGateName(const std::string& name) {
+    auto it = mGateNameId.find(name);
+    if (it != mGateNameId.end()) return it->second;
+
+    uint32_t id = mGateNames.size();
+    mGateNames.push_back(name);
+    mGateNameId[name] = id;
+    return id;
+}
+
+uint32_t GateStream::internCRegName(const std::string& name) {
+    auto it = mCRegNameId.find(name);
+    if (it != mCRegNameId.end()) return it->second;
+
+    uint32_t id = mCRegNames.size();
+    mCRegNames.push_back(name);
+    mCRegNameId[name] = id;
+    return id;
+}
+
+void GateStream::checkGateId(uint32_t i) const {
+    EfdAbortIf(i >= mKind.size(),
+               "Gate id out of bounds (of `" << mKind.size() << "`): `" << i << "`.");
+}
+
+void GateStream::init(const XbitToNumber& xton) {
+    mQubits = xton.getQSize();
+    mCbits = xton.getCSize();
+    mIsFlat = true;
+
+    mKind.clear();
+    mGateName.clear();
+    mQArgsBegin.assign(1, 0);
+    mQArgs.clear();
+    mCArgsBegin.assign(1, 0);
+    mCArgs.clear();
+    mArgsBegin.assign(1, 0);
+    mArgs.clear();
+    mCondReg.clear();
+    mCondVal.clear();
+    mNode.clear();
+
+    mGateNames.clear();
+    mGateNameId.clear();
+    mCRegNames.clear();
+    mCRegNameId.clear();
+    mNodeId.clear();
+
+    mQNodes.assign(mQubits, nullptr);
+    mCNodes.assign(mCbits, nullptr);
+
+    for (auto& pair : xton.gidQMap) mQNodes[pair.second.key] = pair.second.node;
+    for (auto& pair : xton.gidCMap) mCNodes[pair.second.key] = pair.second.node;
+}
+
+uint32_t GateStream::append(Node::Ref stmt, const XbitToNumber& xton) {
+    EfdAbortIf(mQArgsBegin.empty(), "`GateStream` not initialized.");
+
+    auto pair = GetStatementPair(stmt);
+    auto ifstmt = pair.first;
+    auto qop = pair.second;
+
+    EfdAbortIf(qop == nullptr,
+               "Statement is not a quantum operation: `" << stmt->toString(false) << "`.");
+
+    uint32_t id = mKind.size();
+    auto kind = GetGateStreamKind(qop);
+
+    mKind.push_back(kind);
+    mGateName.push_back(internGateName(qop->getId()->getVal()));
+
+    for (auto& qarg : *qop->getQArgs()) {
+        AppendXbitUIds(qarg.get(), xton, mQArgs, mIsFlat);
+    }
+
+    if (auto measure = dynCast<NDQOpMeasure>(qop)) {
+        AppendXbitUIds(measure->getCBit(), xton, mCArgs, mIsFlat);
+    }
+
+    if (ifstmt != nullptr) {
+        auto cregname = ifstmt->getCondId()->getVal();
+        auto cregUIds = xton.getRegUIds(cregname);
+        mCArgs.insert(mCArgs.end(), cregUIds.begin(), cregUIds.end());
+        mCondReg.push_back(internCRegName(cregname));
+        mCondVal.push_back(ifstmt->getCondN()->getVal().mV);
+    } else {
+        mCondReg.push_back(_undef);
+        mCondVal.push_back(0);
+    }
+
+    for (auto& arg : *qop->getArgs()) {
+        mArgs.push_back(arg.get());
+    }
+
+    mQArgsBegin.push_back(mQArgs.size());
+    mCArgsBegin.push_back(mCArgs.size());
+    mArgsBegin.push_back(mArgs.size());
+
+    mNode.push_back(stmt);
+    mNodeId[stmt] = id;
+
+    return id;
+}
+
+uint32_t GateStream::size() const {
+    return mKind.size();
+}
+
+uint32_t GateStream::getQSize() const {
+    return mQubits;
+}
+
+uint32_t GateStream::getCSize() const {
+    return mCbits;
+}
+
+bool GateStream::isFlat() const {
+    return mIsFlat;
+}
+
+GateStream::Kind GateStream::getKind(uint32_t i) const {
+    checkGateId(i);
+    return mKind[i];
+}
+
+const std::string& GateStream::getGateName(uint32_t i) const {
+    checkGateId(i);
+    return mGateNames[mGateName[i]];
+}
+
+uint32_t GateStream::getGateNameId(uint32_t i) const {
+    checkGateId(i);
+    return mGateName[i];
+}
+
+GateStream::IdSlice GateStream::getQArgs(uint32_t i) const {
+    checkGateId(i);
+    return IdSlice(mQArgs.data() + mQArgsBegin[i], mQArgs.data() + mQArgsBegin[i + 1]);
+}
+
+GateStream::IdSlice GateStream::getCArgs(uint32_t i) const {
+    checkGateId(i);
+    return IdSlice(mCArgs.data() + mCArgsBegin[i], mCArgs.data() + mCArgsBegin[i + 1]);
+}
+
+GateStream::ArgSlice GateStream::getArgs(uint32_t i) const {
+    checkGateId(i);
+    return ArgSlice(mArgs.data() + mArgsBegin[i], mArgs.data() + mArgsBegin[i + 1]);
+}
+
+bool GateStream::isConditional(uint32_t i) const {
+    checkGateId(i);
+    return mCondReg[i] != _undef;
+}
+
+const std::string& GateStream::getCondRegName(uint32_t i) const {
+    EfdAbortIf(!isConditional(i), "Gate `" << i << "` is not conditional.");
+    return mCRegNames[mCondReg[i]];
+}
+
+long long GateStream::getCondVal(uint32_t i) const {
+    EfdAbortIf(!isConditional(i), "Gate `" << i << "` is not conditional.");
+    return mCondVal[i];
+}
+
+std::vector<uint32_t> GateStream::getXbits(uint32_t i) const {
+    auto qargs = getQArgs(i);
+    auto cargs = getCArgs(i);
+
+    std::vector<uint32_t> xbits(qargs.begin(), qargs.end());
+    for (uint32_t c : cargs) xbits.push_back(mQubits + c);
+
+    return xbits;
+}
+
+Node::Ref GateStream::getNode(uint32_t i) const {
+    checkGateId(i);
+    return mNode[i];
+}
+
+bool GateStream::hasNode(Node::Ref stmt) const {
+    return mNodeId.find(stmt) != mNodeId.end();
+}
+
+uint32_t GateStream::getGateId(Node::Ref stmt) const {
+    auto it = mNodeId.find(stmt);
+    EfdAbortIf(it == mNodeId.end(),
+               "Statement not in the gate stream: `"
+               << ((stmt == nullptr) ? "nullptr" : stmt->toString(false)) << "`.");
+    return it->second;
+}
+
+Node::uRef GateStream::lower(uint32_t i) const {
+    EfdAbortIf(!mIsFlat, "Can't lower a `GateStream` built from a non-flattened module.");
+
+    auto qargs = getQArgs(i);
+    auto cargs = getCArgs(i);
+    auto args = getArgs(i);
+
+    std::vector<Node::uRef> qargsV;
+    for (uint32_t q : qargs) qargsV.push_back(mQNodes[q]->clone());
+
+    auto argsList = NDList::Create();
+    for (auto arg : args) argsList->addChild(arg->clone());
+
+    NDQOp::uRef qop;
+
+    switch (mKind[i]) {
+        case Kind::CX:
+            qop = NDQOpCX::Create(std::move(qargsV[0]), std::move(qargsV[1]));
+            break;
+
+        case Kind::U:
+            qop = NDQOpU::Create(std::move(argsList), std::move(qargsV[0]));
+            break;
+
+        case Kind::MEASURE:
+            qop = NDQOpMeasure::Create(std::move(qargsV[0]), mCNodes[cargs[0]]->clone());
+            break;
+
+        case Kind::RESET:
+            qop = NDQOpReset::Create(std::move(qargsV[0]));
+            break;
+
+        case Kind::BARRIER:
+            {
+                auto qargsList = NDList::Create();
+                qargsList->addChildren(std::move(qargsV));
+                qop = NDQOpBarrier::Create(std::move(qargsList));
+            }
+            break;
+
+        case Kind::GEN:
+            {
+                auto qargsList = NDList::Create();
+                qargsList->addChildren(std::move(qargsV));
+                qop = NDQOpGen::Create(NDId::Create(getGateName(i)),
+                                       std::move(argsList),
+                                       std::move(qargsList));
+            }
+            break;
+
+        case Kind::INTRINSIC_SWAP:
+            qop = CreateIntrinsicGate(NDQOpGen::K_INTRINSIC_SWAP, std::move(qargsV));
+            break;
+
+        case Kind::INTRINSIC_REV_CX:
+            qop = CreateIntrinsicGate(NDQOpGen::K_INTRINSIC_REV_CX, std::move(qargsV));
+            break;
+
+        case Kind::INTRINSIC_LCX:
+            qop = CreateIntrinsicGate(NDQOpGen::K_INTRINSIC_LCX, std::move(qargsV));
+            break;
+    }
+
+    if (isConditional(i)) {
+        return NDIfStmt::Create(NDId::Create(getCondRegName(i)),
+                                NDInt::Create(std::to_string(mCondVal[i])),
+                                std::move(qop));
+    }
+
+    return std::move(qop);
+}
+
+std::vector<Node::uRef> GateStream::lower() const {
+    std::vector<Node::uRef> stmts;
+
+    for (uint32_t i = 0, e = size(); i < e; ++i) {
+        stmts.push_back(lower(i));
+    }
+
+    return stmts;
+}
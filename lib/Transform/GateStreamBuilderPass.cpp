@@ -0,0 +1,24 @@
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/PassCache.h"
+
+using namespace efd;
+
+uint8_t GateStreamBuilderPass::ID = 0;
+
+bool GateStreamBuilderPass::run(QModule* qmod) {
+    auto xtonpass = PassCache::Get<XbitToNumberWrapperPass>(qmod);
+    auto& xton = xtonpass->getData();
+
+    mData.init(xton);
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        mData.append(it->get(), xton);
+    }
+
+    return false;
+}
+
+GateStreamBuilderPass::uRef GateStreamBuilderPass::Create() {
+    return uRef(new GateStreamBuilderPass());
+}
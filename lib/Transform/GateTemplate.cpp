@@ -0,0 +1,162 @@
+#include "enfield/Transform/GateTemplate.h"
+#include "enfield/Support/RTTI.h"
+#include "enfield/Support/uRefCast.h"
+#include "enfield/Support/Defs.h"
+
+#include <algorithm>
+
+using namespace efd;
+
+/// \brief Returns the index of \p child in the children of \p parent.
+static uint32_t GetChildIndex(Node::Ref parent, Node::Ref child) {
+    for (uint32_t i = 0, e = parent->getChildNumber(); i < e; ++i) {
+        if (parent->getChild(i) == child) return i;
+    }
+
+    EfdAbortIf(true, "`" << child->toString(false) << "` is not a child of `"
+               << parent->toString(false) << "`.");
+}
+
+GateTemplate::GateTemplate(uint32_t slots, std::vector<Node::uRef> stmts)
+    : mSlots(slots), mStmts(std::move(stmts)) {}
+
+void GateTemplate::addHole(uint32_t stmt, const std::vector<uint32_t>& path, uint32_t slot) {
+    uint32_t begin = mPaths.size();
+    mPaths.insert(mPaths.end(), path.begin(), path.end());
+    mHoles.push_back(Hole { stmt, begin, (uint32_t) mPaths.size(), slot });
+}
+
+void GateTemplate::collectHoles(Node::Ref node, uint32_t stmt, std::vector<uint32_t>& path,
+                                const std::unordered_map<std::string, uint32_t>& slots) {
+    // Only the arguments of the operations (and the expressions in them)
+    // may refer to the slots. Not their names.
+    if (auto qop = dynCast<NDQOp>(node)) {
+        if (instanceOf<NDQOpMeasure>(node) || instanceOf<NDQOpReset>(node)) return;
+
+        for (auto list : { (Node::Ref) qop->getArgs(), (Node::Ref) qop->getQArgs() }) {
+            path.push_back(GetChildIndex(node, list));
+            collectHoles(list, stmt, path, slots);
+            path.pop_back();
+        }
+
+        return;
+    }
+
+    if (!instanceOf<NDList>(node) && !instanceOf<NDBinOp>(node) && !instanceOf<NDUnaryOp>(node)) {
+        return;
+    }
+
+    for (uint32_t i = 0, e = node->getChildNumber(); i < e; ++i) {
+        auto child = node->getChild(i);
+        path.push_back(i);
+
+        auto id = dynCast<NDId>(child);
+        auto slot = (id == nullptr) ? slots.end() : slots.find(id->getVal());
+
+        if (slot != slots.end()) addHole(stmt, path, slot->second);
+        else collectHoles(child, stmt, path, slots);
+
+        path.pop_back();
+    }
+}
+
+uint32_t GateTemplate::getNumberOfSlots() const {
+    return mSlots;
+}
+
+uint32_t GateTemplate::getNumberOfStmts() const {
+    return mStmts.size();
+}
+
+void GateTemplate::expand(const std::vector<Node::Ref>& operands,
+                          std::vector<Node::uRef>& out,
+                          NDIfStmt::Ref ifstmt) const {
+    EfdAbortIf(operands.size() != mSlots,
+               "Expanding template of `" << mSlots << "` slots with `"
+               << operands.size() << "` operands.");
+
+    out.reserve(out.size() + mStmts.size());
+    auto hole = mHoles.begin(), holesEnd = mHoles.end();
+
+    for (uint32_t i = 0, e = mStmts.size(); i < e; ++i) {
+        auto stmt = mStmts[i]->clone();
+
+        for (; hole != holesEnd && hole->mStmt == i; ++hole) {
+            Node::Ref parent = stmt.get();
+
+            for (uint32_t k = hole->mPathBegin; k + 1 < hole->mPathEnd; ++k) {
+                parent = parent->getChild(mPaths[k]);
+            }
+
+            parent->setChild(mPaths[hole->mPathEnd - 1], operands[hole->mSlot]->clone());
+        }
+
+        if (ifstmt != nullptr) {
+            auto ifclone = uniqueCastForward<NDIfStmt>(ifstmt->clone());
+            ifclone->setQOp(uniqueCastForward<NDQOp>(std::move(stmt)));
+            stmt = std::move(ifclone);
+        }
+
+        out.push_back(std::move(stmt));
+    }
+}
+
+void GateTemplate::expand(NDQOp::Ref call, std::vector<Node::uRef>& out,
+                          NDIfStmt::Ref ifstmt) const {
+    std::vector<Node::Ref> operands;
+    operands.reserve(mSlots);
+
+    for (auto& qarg : *call->getQArgs()) operands.push_back(qarg.get());
+    for (auto& arg : *call->getArgs()) operands.push_back(arg.get());
+
+    expand(operands, out, ifstmt);
+}
+
+GateTemplate::uRef GateTemplate::Create(NDGateDecl::Ref gate, std::vector<Node::uRef> body) {
+    auto qargs = gate->getQArgs();
+    auto args = gate->getArgs();
+    uint32_t nqargs = qargs->getChildNumber();
+
+    // A parameter hides a quantum argument with the same name.
+    std::unordered_map<std::string, uint32_t> slots;
+    for (uint32_t i = 0; i < nqargs; ++i) {
+        slots[qargs->getChild(i)->toString()] = i;
+    }
+
+    for (uint32_t i = 0, e = args->getChildNumber(); i < e; ++i) {
+        slots[args->getChild(i)->toString()] = nqargs + i;
+    }
+
+    uRef tmpl(new GateTemplate(nqargs + args->getChildNumber(), std::move(body)));
+    std::vector<uint32_t> path;
+
+    for (uint32_t i = 0, e = tmpl->mStmts.size(); i < e; ++i) {
+        tmpl->collectHoles(tmpl->mStmts[i].get(), i, path, slots);
+    }
+
+    return tmpl;
+}
+
+GateTemplate::uRef GateTemplate::Create(Node::Ref stmt, const std::vector<Node::Ref>& holes) {
+    std::vector<Node::uRef> stmts;
+    stmts.push_back(stmt->clone());
+
+    uRef tmpl(new GateTemplate(holes.size(), std::move(stmts)));
+    std::vector<uint32_t> path;
+
+    for (uint32_t i = 0, e = holes.size(); i < e; ++i) {
+        path.clear();
+
+        for (auto node = holes[i]; node != stmt; node = node->getParent()) {
+            auto parent = node->getParent();
+            EfdAbortIf(parent == nullptr, "`" << holes[i]->toString(false)
+                       << "` is not inside `" << stmt->toString(false) << "`.");
+            path.push_back(GetChildIndex(parent, node));
+        }
+
+        std::reverse(path.begin(), path.end());
+        tmpl->addHole(0, path, i);
+    }
+
+    return tmpl;
+}
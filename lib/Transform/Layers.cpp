@@ -0,0 +1,92 @@
+#include "enfield/Transform/Layers.h"
+#include "enfield/Support/Defs.h"
+
+using namespace efd;
+
+// ----------------------------------------------------------------
+// --------------------- Layers::Iterator Class -------------------
+// ----------------------------------------------------------------
+
+Layers::Iterator::Iterator(const Layers* layers, uint32_t i) : mLayers(layers), mI(i) {}
+
+Layer Layers::Iterator::operator*() const {
+    return (*mLayers)[mI];
+}
+
+Layers::Iterator& Layers::Iterator::operator++() {
+    ++mI;
+    return *this;
+}
+
+bool Layers::Iterator::operator==(const Iterator& rhs) const {
+    return mLayers == rhs.mLayers && mI == rhs.mI;
+}
+
+bool Layers::Iterator::operator!=(const Iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+// ----------------------------------------------------------------
+// ------------------------- Layers Class -------------------------
+// ----------------------------------------------------------------
+
+Layers::Layers() : mBegin(1, 0) {}
+
+Layers::Layers(const std::vector<Node::Ref>& nodes, const std::vector<uint32_t>& layerOf) {
+    EfdAbortIf(nodes.size() != layerOf.size(),
+               "Expected the layer of each of the `" << nodes.size()
+               << "` statements. Got `" << layerOf.size() << "`.");
+
+    uint32_t layers = 0;
+    for (auto layer : layerOf) {
+        if (layer >= layers) layers = layer + 1;
+    }
+
+    // Counting the statements of each layer, and then placing them
+    // right after the ones that came before in the same layer.
+    mBegin.assign(layers + 1, 0);
+    for (auto layer : layerOf) {
+        ++mBegin[layer + 1];
+    }
+
+    for (uint32_t i = 0; i < layers; ++i) {
+        mBegin[i + 1] += mBegin[i];
+    }
+
+    std::vector<uint32_t> next(mBegin.begin(), mBegin.end() - 1);
+    mNodes.resize(nodes.size());
+
+    for (uint32_t i = 0, e = nodes.size(); i < e; ++i) {
+        mNodes[next[layerOf[i]]++] = nodes[i];
+    }
+}
+
+uint32_t Layers::size() const {
+    return mBegin.size() - 1;
+}
+
+bool Layers::empty() const {
+    return size() == 0;
+}
+
+uint32_t Layers::getNumberOfNodes() const {
+    return mNodes.size();
+}
+
+void Layers::append(const std::vector<Node::Ref>& layer) {
+    mNodes.insert(mNodes.end(), layer.begin(), layer.end());
+    mBegin.push_back(mNodes.size());
+}
+
+Layer Layers::operator[](uint32_t i) const {
+    EfdAbortIf(i >= size(), "Layer `" << i << "` out of bounds (`" << size() << "` layers).");
+    return Layer(mNodes.data() + mBegin[i], mNodes.data() + mBegin[i + 1]);
+}
+
+Layers::Iterator Layers::begin() const {
+    return Iterator(this, 0);
+}
+
+Layers::Iterator Layers::end() const {
+    return Iterator(this, size());
+}
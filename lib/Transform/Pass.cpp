@@ -1,5 +1,11 @@
 #include "enfield/Transform/Pass.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <typeinfo>
+
+#include <cxxabi.h>
+
 efd::Pass::Pass(Kind k) : mK(k) {
 }
 
@@ -7,6 +13,23 @@ efd::Pass::Kind efd::Pass::getKind() const {
     return mK;
 }
 
+std::string efd::Pass::getName() const {
+    const char* mangled = typeid(*this).name();
+    int status = 0;
+
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    std::string name = (status == 0) ? demangled : mangled;
+    std::free(demangled);
+
+    // Omitting the namespace.
+    if (name.compare(0, 5, "efd::") == 0) name = name.substr(5);
+    return name;
+}
+
+bool efd::Pass::preserves(uint8_t* id) const {
+    return std::find(mPreserved.begin(), mPreserved.end(), id) != mPreserved.end();
+}
+
 efd::PassT<void>::PassT() : Pass(K_VOID) {
 }
 
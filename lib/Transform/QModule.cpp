@@ -1,20 +1,32 @@
 #include "enfield/Analysis/Driver.h"
+#include "enfield/Analysis/QASMEmitter.h"
 #include "enfield/Transform/QModule.h"
 #include "enfield/Transform/Utils.h"
-#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/FlatParser.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/MappedFile.h"
 #include "enfield/Support/Defs.h"
 
 #include <unordered_set>
 #include <iterator>
+#include <algorithm>
+#include <sstream>
 
-efd::QModule::QModule() : mVersion(nullptr) {
-    mStatements = NDStmtList::Create();
+efd::QModule::QModule() : mVersion(nullptr), mAnalyses(new AnalysisManager(this)) {
+    mStatements = std::make_shared<SharedStmtList>();
+    mStatements->mList = NDStmtList::Create();
+    mStatements->mOwners.push_back(this);
 }
 
 efd::QModule::~QModule() {
-    PassCache::Clear(this);
+    releaseStatements();
+}
+
+void efd::QModule::releaseStatements() {
+    std::lock_guard<std::mutex> lock(mStatements->mMutex);
+    auto& owners = mStatements->mOwners;
+    owners.erase(std::find(owners.begin(), owners.end(), this));
 }
 
 efd::NDQasmVersion::Ref efd::QModule::getVersion() {
@@ -50,10 +62,63 @@ void efd::QModule::removeAllQRegs() {
     }
 }
 
+efd::QModule::Iterator efd::QModule::lookupStatement(Node::Ref ref) {
+    auto& list = mStatements->mList;
+    auto& index = mStatements->mIndex;
+
+    if (!index.mValid) {
+        index.mEntries.clear();
+        index.mShifts.clear();
+        index.mValid = true;
+        indexStatements(0, list->getChildNumber());
+    }
+
+    auto it = index.mEntries.find(ref);
+    if (it == index.mEntries.end()) return list->end();
+
+    auto& entry = it->second;
+    for (uint32_t e = index.mShifts.size(); entry.mShifts < e; ++entry.mShifts) {
+        auto& shift = index.mShifts[entry.mShifts];
+        if (entry.mPosition >= shift.mFrom) entry.mPosition += shift.mDelta;
+    }
+
+    EfdAbortIf(entry.mPosition >= list->getChildNumber() ||
+               list->getChild(entry.mPosition) != ref,
+               "Statement index out of date for: `" << ref->toString(false) << "`.");
+
+    return list->begin() + entry.mPosition;
+}
+
+void efd::QModule::invalidateStatementIndex() {
+    mStatements->mIndex.mValid = false;
+}
+
+void efd::QModule::shiftStatementIndex(uint32_t from, int32_t delta) {
+    auto& index = mStatements->mIndex;
+    if (!index.mValid || delta == 0) return;
+
+    if (index.mShifts.size() >= StatementIndex::MaxShifts) {
+        // Cheaper to rebuild it than to keep walking the shifts.
+        invalidateStatementIndex();
+    } else {
+        index.mShifts.push_back(StatementIndex::Shift { from, delta });
+    }
+}
+
+void efd::QModule::indexStatements(uint32_t from, uint32_t n) {
+    auto& index = mStatements->mIndex;
+    if (!index.mValid) return;
+
+    uint32_t shifts = index.mShifts.size();
+    for (uint32_t i = from; i < from + n; ++i) {
+        index.mEntries[mStatements->mList->getChild(i)] = StatementIndex::Entry { i, shifts };
+    }
+}
+
 efd::QModule::Iterator efd::QModule::findStatement(Node::Ref ref) {
-    auto it = mStatements->findChild(ref);
+    auto it = lookupStatement(ref);
 
-    EfdAbortIf(it == mStatements->end(),
+    EfdAbortIf(it == mStatements->mList->end(),
                "Node not in the main statement list: `"
                << ((ref == nullptr) ? "nullptr" : ref->toString(false))
                << "`.");
@@ -62,7 +127,13 @@ efd::QModule::Iterator efd::QModule::findStatement(Node::Ref ref) {
 }
 
 void efd::QModule::removeStatement(Iterator it) {
-    mStatements->removeChild(it);
+    detachStatements();
+
+    uint32_t position = std::distance(mStatements->mList->begin(), it);
+    mStatements->mIndex.mEntries.erase(it->get());
+    shiftStatementIndex(position + 1, -1);
+
+    mStatements->mList->removeChild(it);
 }
 
 efd::QModule::Iterator efd::QModule::inlineCall(NDQOp::Ref call) {
@@ -77,7 +148,10 @@ efd::QModule::Iterator efd::QModule::inlineCall(NDQOp::Ref call) {
         parent = stmt->getParent();
     }
 
-    Iterator it = parent->findChild(stmt);
+    detachStatements();
+
+    Iterator it = (parent == mStatements->mList.get()) ?
+        lookupStatement(stmt) : parent->findChild(stmt);
     uint32_t dist = std::distance(parent->begin(), it);
 
     InlineGate(this, call);
@@ -85,63 +159,186 @@ efd::QModule::Iterator efd::QModule::inlineCall(NDQOp::Ref call) {
 }
 
 efd::QModule::Iterator efd::QModule::insertStatementAfter(Iterator it, Node::uRef ref) {
-    mStatements->addChild(++it, std::move(ref));
-    return it;
+    return insertStatementBefore(++it, std::move(ref));
 }
 
 efd::QModule::Iterator efd::QModule::insertStatementBefore(Iterator it, Node::uRef ref) {
-    mStatements->addChild(it, std::move(ref));
-    return it;
+    detachStatements();
+
+    uint32_t position = std::distance(mStatements->mList->begin(), it);
+    mStatements->mList->addChild(it, std::move(ref));
+
+    shiftStatementIndex(position, 1);
+    indexStatements(position, 1);
+    return mStatements->mList->begin() + position;
 }
 
 efd::QModule::Iterator efd::QModule::insertStatementFront(Node::uRef ref) {
-    auto it = mStatements->begin();
-    mStatements->addChild(it, std::move(ref));
-    return mStatements->begin();
+    detachStatements();
+    return insertStatementBefore(mStatements->mList->begin(), std::move(ref));
 }
 
 efd::QModule::Iterator efd::QModule::insertStatementLast(Node::uRef ref) {
-    auto oldChildNumber = mStatements->getChildNumber();
-    mStatements->addChild(std::move(ref));
-    return mStatements->begin() + oldChildNumber;
+    detachStatements();
+    auto oldChildNumber = mStatements->mList->getChildNumber();
+    mStatements->mList->addChild(std::move(ref));
+
+    // Appending doesn't change the position of the other statements.
+    indexStatements(oldChildNumber, 1);
+    return mStatements->mList->begin() + oldChildNumber;
 }
 
 efd::QModule::Iterator efd::QModule::insertStatementLast(std::vector<Node::uRef> stmts) {
-    auto oldChildNumber = mStatements->getChildNumber();
-    mStatements->addChildren(std::move(stmts));
-    return mStatements->begin() + oldChildNumber;
+    detachStatements();
+    auto oldChildNumber = mStatements->mList->getChildNumber();
+    uint32_t n = stmts.size();
+    mStatements->mList->addChildren(std::move(stmts));
+
+    indexStatements(oldChildNumber, n);
+    return mStatements->mList->begin() + oldChildNumber;
 }
 
 efd::QModule::Iterator efd::QModule::replaceStatement
 (Node::Ref stmt, std::vector<Node::uRef> stmts) {
-    auto it = mStatements->findChild(stmt);
+    detachStatements();
+    auto it = lookupStatement(stmt);
 
-    EfdAbortIf(it == mStatements->end(),
+    EfdAbortIf(it == mStatements->mList->end(),
                "Trying to replace a non-existing statement: `"
                << ((stmt == nullptr) ? "nullptr" : stmt->toString(false))
                << "`.");
 
+    uint32_t position = std::distance(mStatements->mList->begin(), it);
     uint32_t stmtsSize = stmts.size();
+
+    mStatements->mIndex.mEntries.erase(stmt);
+    shiftStatementIndex(position + 1, (int32_t) stmtsSize - 1);
+
     if (!stmts.empty()) {
-        it = mStatements->addChildren(it, std::move(stmts));
+        it = mStatements->mList->addChildren(it, std::move(stmts));
     }
 
-    it = mStatements->removeChild(it + stmtsSize);
+    it = mStatements->mList->removeChild(it + stmtsSize);
+    indexStatements(position, stmtsSize);
     return it - stmtsSize;
 }
 
+void efd::QModule::replaceStatements(ReplacementMap repMap) {
+    if (repMap.empty()) return;
+
+    detachStatements();
+    invalidateStatementIndex();
+
+    auto& list = mStatements->mList;
+    std::vector<Node::uRef> newStatements;
+    uint32_t replaced = 0;
+
+    newStatements.reserve(list->getChildNumber());
+
+    for (auto& stmt : *list) {
+        auto it = repMap.find(stmt.get());
+
+        if (it == repMap.end()) {
+            newStatements.push_back(std::move(stmt));
+        } else {
+            for (auto& newStmt : it->second) {
+                newStatements.push_back(std::move(newStmt));
+            }
+
+            ++replaced;
+        }
+    }
+
+    EfdAbortIf(replaced != repMap.size(),
+               "Trying to replace `" << repMap.size() - replaced
+               << "` non-existing statement(s).");
+
+    // The replaced statements are only destroyed here.
+    list->clear();
+    list->addChildren(std::move(newStatements));
+}
+
 void efd::QModule::clearStatements() {
-    mStatements->clear();
+    if (hasSharedStatements()) {
+        // No need to copy anything, since they would be removed anyway.
+        releaseStatements();
+        mStatements = std::make_shared<SharedStmtList>();
+        mStatements->mList = NDStmtList::Create();
+        mStatements->mOwners.push_back(this);
+    } else {
+        mStatements->mList->clear();
+        invalidateStatementIndex();
+    }
+}
+
+std::vector<efd::Node::uRef> efd::QModule::takeStatements() {
+    detachStatements();
+    invalidateStatementIndex();
+
+    auto& list = mStatements->mList;
+    std::vector<Node::uRef> stmts;
+    stmts.reserve(list->getChildNumber());
+
+    for (auto& stmt : *list) {
+        stmts.push_back(std::move(stmt));
+    }
+
+    list->clear();
+    return stmts;
+}
+
+void efd::QModule::detachStatements() {
+    // Keeps the shared list alive while its mutex is held.
+    auto shared = mStatements;
+    std::lock_guard<std::mutex> lock(shared->mMutex);
+
+    auto& owners = shared->mOwners;
+    if (owners.size() <= 1) return;
+
+    owners.erase(std::find(owners.begin(), owners.end(), this));
+
+    auto detached = std::make_shared<SharedStmtList>();
+    detached->mList = std::move(mStatements->mList);
+    detached->mOwners.push_back(this);
+    detached->mIndex = std::move(mStatements->mIndex);
+    mStatements->mIndex = StatementIndex();
+
+    mStatements->mList = uniqueCastForward<NDStmtList>(detached->mList->clone());
+
+    // The remaining owners have new statement nodes. So, whatever was computed
+    // over the old ones is no longer valid.
+    for (auto owner : owners) {
+        owner->mAnalyses->clear();
+    }
+
+    mStatements = detached;
+}
+
+bool efd::QModule::hasSharedStatements() const {
+    std::lock_guard<std::mutex> lock(mStatements->mMutex);
+    return mStatements->mOwners.size() > 1;
 }
 
 efd::Node::Ref efd::QModule::getStatement(uint32_t i) {
-    EfdAbortIf(i >= mStatements->getChildNumber(),
-               "Out of bounds access (of `" << mStatements->getChildNumber()
+    EfdAbortIf(i >= mStatements->mList->getChildNumber(),
+               "Out of bounds access (of `" << mStatements->mList->getChildNumber()
                << "`): `" << i << "`.");
-    return mStatements->getChild(i);
+    return mStatements->mList->getChild(i);
 }
 
 void efd::QModule::insertGate(NDGateSign::uRef gate) {
+    insertGate(NDGateSign::sRef(std::move(gate)), false);
+}
+
+void efd::QModule::insertSharedGate(NDGateSign::sRef gate) {
+    insertGate(gate, true);
+}
+
+bool efd::QModule::isSharedGate(NDGateSign::Ref gate) const {
+    return mSharedGates.find(gate) != mSharedGates.end();
+}
+
+void efd::QModule::insertGate(NDGateSign::sRef gate, bool shared) {
     EfdAbortIf(gate.get() == nullptr, "Trying to insert a 'nullptr' gate.");
     EfdAbortIf(gate->getId() == nullptr, "Trying to insert a gate with 'nullptr' id.");
 
@@ -157,11 +354,24 @@ void efd::QModule::insertGate(NDGateSign::uRef gate) {
             }
         }
 
-        mGatesMap.erase(mGatesMap.find(id));
+        auto it = mGatesMap.find(id);
+        mSharedGates.erase(it->second.get());
+        mGatesMap.erase(it);
     }
 
+    if (shared) mSharedGates.insert(gate.get());
+    mGates.push_back(gate.get());
     mGatesMap[id] = std::move(gate);
-    mGates.push_back(mGatesMap[id].get());
+}
+
+void efd::QModule::copyGatesTo(QModule::Ref qmod) const {
+    for (auto gate : mGates) {
+        if (isSharedGate(gate)) {
+            qmod->insertSharedGate(mGatesMap.at(gate->getId()->getVal()));
+        } else {
+            qmod->insertGate(uniqueCastForward<NDGateSign>(gate->clone()));
+        }
+    }
 }
 
 uint32_t efd::QModule::getNumberOfRegs() const {
@@ -173,7 +383,7 @@ uint32_t efd::QModule::getNumberOfGates() const {
 }
 
 uint32_t efd::QModule::getNumberOfStmts() const {
-    return mStatements->getChildNumber();
+    return mStatements->mList->getChildNumber();
 }
 
 efd::QModule::RegIterator efd::QModule::reg_begin() {
@@ -209,51 +419,50 @@ efd::QModule::GateConstIterator efd::QModule::gates_end() const {
 }
 
 efd::QModule::Iterator efd::QModule::stmt_begin() {
-    return mStatements->begin();
+    return mStatements->mList->begin();
 }
 
 efd::QModule::ConstIterator efd::QModule::stmt_begin() const {
-    return mStatements->begin();
+    return mStatements->mList->begin();
 }
 
 efd::QModule::Iterator efd::QModule::stmt_end() {
-    return mStatements->end();
+    return mStatements->mList->end();
 }
 
 efd::QModule::ConstIterator efd::QModule::stmt_end() const {
-    return mStatements->end();
+    return mStatements->mList->end();
 }
 
 void efd::QModule::orderby(std::vector<uint32_t> order) {
+    detachStatements();
+    invalidateStatementIndex();
+
     std::vector<Node::uRef> newstmts;
     for (uint32_t i : order)
-        newstmts.push_back(std::move(mStatements->mChild[i]));
-    mStatements->mChild.clear();
-    mStatements->mChild = std::move(newstmts);
+        newstmts.push_back(std::move(mStatements->mList->mChild[i]));
+    mStatements->mList->mChild.clear();
+    mStatements->mList->mChild = std::move(newstmts);
 }
 
 void efd::QModule::print(std::ostream& O, bool pretty, bool printGates) const {
-    O << toString(pretty, printGates);
-}
-
-std::string efd::QModule::toString(bool pretty, bool printGates) const {
-    std::string str;
+    QASMEmitter emitter(O, pretty);
 
     if (mVersion.get() != nullptr)
-        str += mVersion->toString(pretty);
+        emitter.emit(mVersion.get());
 
     for (auto& incl : mIncludes)
-        str += incl->toString(pretty);
+        emitter.emit(incl.get());
 
     if (printGates) {
         // Print all quantum gates.
         for (auto gate : mGates)
-            str += gate->toString(pretty);
+            emitter.emit(gate);
     } else {
         // Print those gates that are being used.
         std::unordered_set<std::string> doPrint;
 
-        for (auto& stmt : *mStatements) {
+        for (auto& stmt : *mStatements->mList) {
             NDQOp::Ref qcall = nullptr;
 
             if (auto ifstmt = dynCast<NDIfStmt>(stmt.get())) {
@@ -266,7 +475,7 @@ std::string efd::QModule::toString(bool pretty, bool printGates) const {
             }
 
             if (qcall != nullptr) {
-                std::string gateId = qcall->getId()->getVal();
+                const std::string& gateId = qcall->getId()->getValRef();
 
                 // Print if it was not yet printed.
                 if (doPrint.find(gateId) == doPrint.end()) {
@@ -276,18 +485,23 @@ std::string efd::QModule::toString(bool pretty, bool printGates) const {
         }
 
         for (auto gate : mGates) {
-            if (doPrint.find(gate->getId()->getVal()) != doPrint.end() &&
+            if (doPrint.find(gate->getId()->getValRef()) != doPrint.end() &&
                     !gate->isInInclude()) {
-                str += gate->toString(pretty);
+                emitter.emit(gate);
             }
         }
     }
 
     for (auto& reg : mRegs)
-        str += reg->toString(pretty);
+        emitter.emit(reg);
 
-    str += mStatements->toString(pretty);
-    return str;
+    emitter.emit(mStatements->mList.get());
+}
+
+std::string efd::QModule::toString(bool pretty, bool printGates) const {
+    std::ostringstream out;
+    print(out, pretty, printGates);
+    return out.str();
 }
 
 efd::Node::Ref efd::QModule::getQVar(std::string id, NDGateDecl::Ref gate) const {
@@ -332,6 +546,10 @@ bool efd::QModule::hasQGate(std::string id) const {
     return true;
 }
 
+efd::AnalysisManager::Ref efd::QModule::getAnalysisManager() {
+    return mAnalyses.get();
+}
+
 efd::QModule::uRef efd::QModule::clone() const {
     auto qmod = new QModule();
 
@@ -344,10 +562,31 @@ efd::QModule::uRef efd::QModule::clone() const {
     for (auto reg : mRegs)
         qmod->insertReg(uniqueCastForward<NDRegDecl>(reg->clone()));
 
-    for (auto gate : mGates)
-        qmod->insertGate(uniqueCastForward<NDGateSign>(gate->clone()));
+    copyGatesTo(qmod);
+
+    qmod->mStatements->mList = uniqueCastForward<NDStmtList>(mStatements->mList->clone());
+    return uRef(qmod);
+}
+
+efd::QModule::uRef efd::QModule::cloneShared() const {
+    auto qmod = new QModule();
+
+    if (mVersion.get() != nullptr)
+        qmod->mVersion = uniqueCastForward<NDQasmVersion>(mVersion->clone());
+
+    for (auto& incl : mIncludes)
+        qmod->insertInclude(uniqueCastForward<NDInclude>(incl->clone()));
+
+    for (auto reg : mRegs)
+        qmod->insertReg(uniqueCastForward<NDRegDecl>(reg->clone()));
+
+    copyGatesTo(qmod);
 
-    qmod->mStatements = uniqueCastForward<NDStmtList>(mStatements->clone());
+    qmod->releaseStatements();
+    qmod->mStatements = mStatements;
+
+    std::lock_guard<std::mutex> lock(mStatements->mMutex);
+    mStatements->mOwners.push_back(qmod);
     return uRef(qmod);
 }
 
@@ -366,14 +605,21 @@ efd::QModule::uRef efd::QModule::GetFromAST(Node::uRef ref) {
     uRef qmod(new QModule());
     efd::ProcessAST(qmod.get(), ref.get());
 
-    auto gates = efd::GetIntrinsicGates();
-    for (auto& gate : gates)
-        qmod->insertGate(std::move(gate));
+    for (auto& gate : efd::GetIntrinsicGates())
+        qmod->insertSharedGate(gate);
 
     return qmod;
 }
 
 efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path) {
+    // Flat programs skip the full parser. Anything else (including errors)
+    // goes through it.
+    if (auto mapped = MappedFile::Open(path + filename)) {
+        if (auto qmod = ParseFlatProgram(mapped->begin(), mapped->end())) {
+            return qmod;
+        }
+    }
+
     auto ast = efd::ParseFile(filename, path, true);
 
     if (ast.get() != nullptr)
@@ -383,6 +629,10 @@ efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path) {
 }
 
 efd::QModule::uRef efd::QModule::ParseString(std::string program) {
+    if (auto qmod = ParseFlatProgram(program.data(), program.data() + program.size())) {
+        return qmod;
+    }
+
     auto ast = efd::ParseString(program, true);
 
     if (ast != nullptr)
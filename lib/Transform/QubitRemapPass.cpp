@@ -1,5 +1,6 @@
 #include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/LayersBuilderPass.h"
 
 using namespace efd;
 
@@ -63,12 +64,19 @@ void QubitRemapVisitor::visit(NDIfStmt::Ref ref) {
 }
 
 // ==--------------- QubitRemapPass ---------------==
-QubitRemapPass::QubitRemapPass(const Mapping& m) : mMap(m) {}
+QubitRemapPass::QubitRemapPass(const Mapping& m) : mMap(m) {
+    preserve<XbitToNumberWrapperPass>();
+    // The nodes are modified in place, and renaming the qubits (injectively)
+    // does not change which statements depend on which.
+    preserve<LayersBuilderPass>();
+}
 
 bool QubitRemapPass::run(QModule* qmod) {
     auto xbitToN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
     QubitRemapVisitor visitor(mMap, xbitToN);
 
+    qmod->detachStatements();
+
     for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
         (*it)->apply(&visitor);
     }
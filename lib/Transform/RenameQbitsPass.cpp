@@ -71,6 +71,8 @@ efd::RenameQbitPass::RenameQbitPass(ArchMap map) : mAMap(map) {
 bool efd::RenameQbitPass::run(QModule::Ref qmod) {
     RenameQbitVisitor visitor(mAMap);
 
+    qmod->detachStatements();
+
     for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
         (*it)->apply(&visitor);
     }
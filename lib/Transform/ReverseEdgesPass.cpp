@@ -1,95 +1,88 @@
 #include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/Utils.h"
-#include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
 
+namespace efd {
+    extern const std::string StdLibCX;
+}
 
 uint8_t efd::ReverseEdgesPass::ID = 0;
 
-namespace efd {
-    class ReverseEdgesVisitor : public NodeVisitor {
-        private:
-            ArchGraph::sRef mG;
-
-            /// \brief Inserts this triple into \em mRevVector.
-            ///
-            /// This also checks if it is inside an if statement.
-            void insertIntoRevVector(Node::Ref ref, Node::Ref lhs, Node::Ref rhs);
-
-        public:
-            std::vector<std::pair<Node::Ref, Node::uRef>> mRevVector;
-            ReverseEdgesVisitor(ArchGraph::sRef g) : mG(g) {}
-
-            void visit(NDQOpCX::Ref ref) override;
-            void visit(NDQOpGen::Ref ref) override;
-            void visit(NDIfStmt::Ref ref) override;
-    };
-}
+/// \brief Creates the reversal of the CNOT \p qop, wrapped by a copy of
+/// \p ifstmt if it is not null.
+static efd::Node::uRef CreateRevCall(efd::NDIfStmt::Ref ifstmt, efd::NDQOp::Ref qop) {
+    using namespace efd;
 
-void efd::ReverseEdgesVisitor::insertIntoRevVector
-(Node::Ref ref, Node::Ref lhs, Node::Ref rhs) {
-    Node::uRef revcall = efd::CreateIRevCX(lhs->clone(), rhs->clone());
+    auto qargs = qop->getQArgs();
+    Node::uRef revcall = CreateIRevCX(qargs->getChild(0)->clone(),
+                                      qargs->getChild(1)->clone());
 
-    auto parent = dynCast<NDIfStmt>(ref->getParent());
-    if (parent != nullptr) {
-        auto ifrevcall = uniqueCastForward<NDIfStmt>(parent->clone());
+    if (ifstmt != nullptr) {
+        auto ifrevcall = uniqueCastForward<NDIfStmt>(ifstmt->clone());
         ifrevcall->setQOp(uniqueCastForward<NDQOp>(std::move(revcall)));
-
         revcall.reset(ifrevcall.release());
-        ref = parent;
     }
 
-    mRevVector.push_back(std::make_pair(ref, std::move(revcall)));
+    return revcall;
 }
 
-void efd::ReverseEdgesVisitor::visit(NDQOpCX::Ref ref) {
-    uint32_t uidLhs = mG->getUId(ref->getLhs()->toString());
-    uint32_t uidRhs = mG->getUId(ref->getRhs()->toString());
-
-    if (!mG->hasEdge(uidLhs, uidRhs)) {
-        insertIntoRevVector(ref, ref->getLhs(), ref->getRhs());
-    }
+efd::ReverseEdgesPass::ReverseEdgesPass(ArchGraph::sRef graph) : mG(graph) {
+    preserve<XbitToNumberWrapperPass>();
 }
 
-void efd::ReverseEdgesVisitor::visit(NDQOpGen::Ref ref) {
-    if (ref->getId()->getVal() == "cx") {
-        // Have to come up a way to overcome this.
-        EfdAbortIf(ref->getQArgs()->getChildNumber() != 2,
-                   "CNot gate malformed: `" << ref->toString(false) << "`.");
+bool efd::ReverseEdgesPass::run(QModule::Ref qmod) {
+    // Built again (instead of taken from the cache), since this pass may be
+    // run on a module whose cached stream is out of date.
+    auto streamPass = GateStreamBuilderPass::Create();
+    streamPass->run(qmod);
 
-        NDList* qargs = ref->getQArgs();
-        uint32_t uidLhs = mG->getUId(qargs->getChild(0)->toString());
-        uint32_t uidRhs = mG->getUId(qargs->getChild(1)->toString());
+    auto& stream = streamPass->getData();
+    auto& xton = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+    auto uids = GetArchQUIds(xton, *mG);
 
-        if (!mG->hasEdge(uidLhs, uidRhs)) {
-            insertIntoRevVector(ref, qargs->getChild(0), qargs->getChild(1));
+    QModule::ReplacementMap repMap;
+
+    for (uint32_t i = 0, e = stream.size(); i < e; ++i) {
+        auto kind = stream.getKind(i);
+
+        if (kind != GateStream::Kind::CX &&
+                (kind != GateStream::Kind::GEN || stream.getGateName(i) != StdLibCX)) {
+            continue;
         }
-    }
-}
 
-void efd::ReverseEdgesVisitor::visit(NDIfStmt::Ref ref) {
-    ref->getQOp()->apply(this);
-}
+        auto qargs = stream.getQArgs(i);
+        auto stmt = stream.getNode(i);
 
-efd::ReverseEdgesPass::ReverseEdgesPass(ArchGraph::sRef graph) : mG(graph) {
-}
+        // Have to come up a way to overcome this.
+        EfdAbortIf(qargs.size() != 2,
+                   "CNot gate malformed: `" << stmt->toString(false) << "`.");
 
-bool efd::ReverseEdgesPass::run(QModule::Ref qmod) {
-    ReverseEdgesVisitor visitor(mG);
+        uint32_t uidLhs = uids[qargs[0]], uidRhs = uids[qargs[1]];
+        EfdAbortIf(uidLhs == _undef || uidRhs == _undef,
+                   "No such vertex in the architecture: `" << stmt->toString(false) << "`.");
 
-    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
-        (*it)->apply(&visitor);
+        if (!mG->hasEdge(uidLhs, uidRhs)) {
+            auto pair = GetStatementPair(stmt);
+            repMap[stmt].push_back(CreateRevCall(pair.first, pair.second));
+        }
     }
 
-    for (auto& pair : visitor.mRevVector) {
-        std::vector<Node::uRef> repl;
-        repl.push_back(std::move(pair.second));
-        qmod->replaceStatement(pair.first, std::move(repl));
+    if (repMap.empty()) return false;
+
+    if (mInliner.get() != nullptr) {
+        mInliner->inlineReplacements(qmod, repMap);
     }
 
-    if (visitor.mRevVector.empty()) return false;
-    else return true;
+    qmod->replaceStatements(std::move(repMap));
+    return true;
+}
+
+void efd::ReverseEdgesPass::setInlineAll(std::vector<std::string> basis) {
+    mInliner = InlineAllPass::Create(basis);
 }
 
 efd::ReverseEdgesPass::uRef efd::ReverseEdgesPass::Create(ArchGraph::sRef graph) {
@@ -1,20 +1,20 @@
 #include "enfield/Transform/SemanticVerifierPass.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
 #include "enfield/Transform/FlattenPass.h"
 #include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Transform/Utils.h"
-#include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/Defs.h"
-#include "enfield/Support/RTTI.h"
 
-#include <unordered_map>
 #include <vector>
 #include <algorithm>
 
 using namespace efd;
 
+namespace efd {
+    extern const std::string StdLibCX;
+}
+
 namespace {
     struct SemanticCNOT {
         uint32_t u, v;
@@ -27,386 +27,213 @@ namespace {
             return !(*this == rhs);
         }
     };
-}
 
-namespace efd {
-    class SemanticVerifierVisitor : public NodeVisitor {
+    /// \brief Checks each gate of the target stream, in order, against the
+    /// frontier of the source circuit graph.
+    ///
+    /// Only the (integer) operands of the streams are looked at. The swaps
+    /// are replayed on the mapping, so that the target qubits may be translated
+    /// back to the source ones.
+    class StreamVerifier {
         private:
-            uint32_t mQubitsSrc;
-            uint32_t mQubitsTgt;
-            uint32_t mXbitsSrc;
-            XbitToNumber& mXtoNSrc;
-            XbitToNumber& mXtoNTgt;
-            CircuitGraph::Iterator& mIt;
+            const GateStream& mSrc;
+            const GateStream& mTgt;
+            const CircuitGraph& mGraph;
+            CircuitGraph::Iterator mIt;
+
             Mapping mMap;
             InverseMap mInverseMap;
+            // Number of xbits that already reached each source gate.
+            std::vector<uint32_t> mArrived;
 
-            std::map<Node::Ref, uint32_t> mReached;
-            std::vector<bool> mMarked;
-
-            inline uint32_t getTgtUId(uint32_t srcUId);
-            inline uint32_t getSrcUId(uint32_t tgtUId);
-            inline uint32_t getRealTgtCUId(uint32_t baseUId);
-            inline uint32_t getRealSrcCUId(uint32_t baseUId);
+            ResultMsg& mResult;
 
-            void updatedReachedCktNodes();
-            void advanceCktNodes(std::vector<uint32_t> xbitsToUpdate);
-            void postprocessing(std::vector<uint32_t> xbitsToUpdate);
-            void visitNDQOp(NDQOp::Ref qop, NDIfStmt::Ref ifstmt = nullptr);
+            void advance(uint32_t xbit);
+            bool error(const std::string& msg);
+            bool isCNOT(const GateStream& stream, uint32_t i);
+            bool sameGate(uint32_t src, uint32_t tgt);
+            bool check(uint32_t tgt);
 
         public:
-            ResultMsg& mResult;
-
-            SemanticVerifierVisitor(ResultMsg& result,
-                                    XbitToNumber& xtonsrc,
-                                    XbitToNumber& xtontgt,
-                                    CircuitGraph::Iterator& it,
-                                    Mapping initial);
-
-            void visit(NDQOpMeasure::Ref ref) override;
-            void visit(NDQOpReset::Ref ref) override;
-            void visit(NDQOpU::Ref ref) override;
-            void visit(NDQOpCX::Ref ref) override;
-            void visit(NDQOpBarrier::Ref ref) override;
-            void visit(NDQOpGen::Ref ref) override;
-            void visit(NDIfStmt::Ref ref) override;
+            StreamVerifier(ResultMsg& result,
+                           const GateStream& src,
+                           const GateStream& tgt,
+                           const CircuitGraph& graph,
+                           Mapping initial);
+
+            /// \brief Returns true if the whole target stream was verified.
+            bool run();
     };
 }
 
-SemanticVerifierVisitor::SemanticVerifierVisitor(ResultMsg& result,
-                                                 XbitToNumber& xtonsrc,
-                                                 XbitToNumber& xtontgt,
-                                                 CircuitGraph::Iterator& iterator,
-                                                 Mapping initial) :
-    mQubitsSrc(xtonsrc.getQSize()),
-    mQubitsTgt(xtontgt.getQSize()),
-    mXbitsSrc(xtonsrc.getQSize() + xtonsrc.getCSize()),
-    mXtoNSrc(xtonsrc),
-    mXtoNTgt(xtontgt),
-    mIt(iterator),
+StreamVerifier::StreamVerifier(ResultMsg& result,
+                               const GateStream& src,
+                               const GateStream& tgt,
+                               const CircuitGraph& graph,
+                               Mapping initial) :
+    mSrc(src),
+    mTgt(tgt),
+    mGraph(graph),
+    mIt(graph.build_iterator()),
     mMap(initial),
-    mMarked(mXbitsSrc, false),
+    mArrived(graph.getNumberOfGates(), 0),
     mResult(result) {
-    
 
-    mInverseMap.assign(mQubitsTgt, 0);
-    for (uint32_t i = 0; i < mQubitsTgt; ++i) {
+    uint32_t qubitsTgt = tgt.getQSize();
+
+    mInverseMap.assign(qubitsTgt, 0);
+    for (uint32_t i = 0; i < qubitsTgt; ++i) {
         mInverseMap[mMap[i]] = i;
     }
 
-    for (uint32_t i = 0; i < mXbitsSrc; ++i) {
-        mIt.next(i);
+    for (uint32_t i = 0, e = mGraph.size(); i < e; ++i) {
+        advance(i);
     }
-
-    postprocessing({});
 }
 
-uint32_t SemanticVerifierVisitor::getRealTgtCUId(uint32_t baseUId) {
-    return mQubitsTgt + baseUId;
+void StreamVerifier::advance(uint32_t xbit) {
+    mIt.next(xbit);
+    auto cnode = mIt[xbit];
+    if (cnode.isGateNode()) ++mArrived[cnode.id()];
 }
 
-uint32_t SemanticVerifierVisitor::getRealSrcCUId(uint32_t baseUId) {
-    return mQubitsSrc + baseUId;
+bool StreamVerifier::error(const std::string& msg) {
+    mResult = ResultMsg::Error(msg);
+    return false;
 }
 
-uint32_t SemanticVerifierVisitor::getTgtUId(uint32_t srcUId) {
-    if (srcUId < mQubitsSrc) return mMap[srcUId];
-    return (srcUId - mQubitsSrc) + mQubitsTgt;
+bool StreamVerifier::isCNOT(const GateStream& stream, uint32_t i) {
+    auto kind = stream.getKind(i);
+    return kind == GateStream::Kind::CX ||
+        (kind == GateStream::Kind::GEN && stream.getGateName(i) == StdLibCX);
 }
 
-uint32_t SemanticVerifierVisitor::getSrcUId(uint32_t tgtUId) {
-    if (tgtUId < mQubitsTgt) return mInverseMap[tgtUId];
-    return (tgtUId - mQubitsTgt) + mQubitsSrc;
-}
+bool StreamVerifier::sameGate(uint32_t src, uint32_t tgt) {
+    if (mSrc.getKind(src) != mTgt.getKind(tgt)) return false;
 
-void SemanticVerifierVisitor::updatedReachedCktNodes() {
-    for (uint32_t i = 0; i < mXbitsSrc; ++i) {
-        auto circuitNode = mIt[i];
-        auto node = circuitNode->node();
+    if (mSrc.getKind(src) == GateStream::Kind::GEN &&
+            mSrc.getGateName(src) != mTgt.getGateName(tgt)) {
+        return false;
+    }
 
-        if (circuitNode->isGateNode() && !mMarked[i]) {
-            mMarked[i] = true;
+    auto srcArgs = mSrc.getArgs(src);
+    auto tgtArgs = mTgt.getArgs(tgt);
 
-            if (mReached.find(node) == mReached.end())
-                mReached[node] = circuitNode->numberOfXbits();
-            --mReached[node];
-        }
-    }
-}
+    if (srcArgs.size() != tgtArgs.size()) return false;
 
-void SemanticVerifierVisitor::advanceCktNodes(std::vector<uint32_t> xbitsToUpdate) {
-    for (uint32_t x : xbitsToUpdate) {
-        mIt.next(x);
-        mMarked[x] = false;
+    for (uint32_t i = 0, e = srcArgs.size(); i < e; ++i) {
+        if (!srcArgs[i]->equals(tgtArgs[i])) return false;
     }
-}
 
-void SemanticVerifierVisitor::postprocessing(std::vector<uint32_t> xbitsToUpdate) {
-    advanceCktNodes(xbitsToUpdate);
-    updatedReachedCktNodes();
+    return true;
 }
 
-void SemanticVerifierVisitor::visitNDQOp(NDQOp::Ref tgtQOp, NDIfStmt::Ref tgtIfStmt) {
-    // Checking all quantum arguments from the current node.
-    std::vector<uint32_t> tgtOpQubits;
-    std::vector<uint32_t> tgtOpCbits;
-
-    Node::Ref mainNode = tgtQOp;
-    if (tgtIfStmt != nullptr) mainNode = tgtIfStmt;
+bool StreamVerifier::check(uint32_t tgt) {
+    auto tgtQubits = mTgt.getQArgs(tgt);
+    auto tgtCbits = mTgt.getCArgs(tgt);
+    auto tgtNode = mTgt.getNode(tgt);
 
-    auto tgtQArgs = tgtQOp->getQArgs();
-    uint32_t tgtQArgsChildrem = tgtQArgs->getChildNumber();
+    if (mTgt.getKind(tgt) == GateStream::Kind::INTRINSIC_SWAP) {
+        uint32_t u = tgtQubits[0], v = tgtQubits[1];
+        uint32_t a = mInverseMap[u], b = mInverseMap[v];
 
-    for (uint32_t i = 0; i < tgtQArgsChildrem; ++i) {
-        auto qarg = tgtQArgs->getChild(i);
-        tgtOpQubits.push_back(mXtoNTgt.getQUId(qarg->toString(false)));
-    }
-
-    if (tgtIfStmt != nullptr) {
-        for (auto cbit : mXtoNTgt.getRegUIds(tgtIfStmt->getCondId()->getVal()))
-            tgtOpCbits.push_back(getRealTgtCUId(cbit));
+        std::swap(mMap[a], mMap[b]);
+        std::swap(mInverseMap[u], mInverseMap[v]);
+        return true;
     }
 
-    // Checking all quantum arguments from the circuit node.
-    std::vector<uint32_t> srcOpQubits;
-    std::vector<uint32_t> srcOpCbits;
-
-    auto srcCNode = mIt[getSrcUId(tgtOpQubits[0])];
-
-    if (!srcCNode->isGateNode()) {
-        mResult = ResultMsg::Error(
-                "Original program has reached the end while processing `" +
-                mainNode->toString(false) + "` of the target program.");
-        return;
+    if (tgtQubits.empty()) {
+        return error("No qubits in `" + tgtNode->toString(false) + "` of the target program.");
     }
 
-    auto srcNode = srcCNode->node();
-    NDQOp::Ref srcQOp = nullptr;
-
-    if (tgtIfStmt != nullptr) {
-        if (tgtIfStmt->getKind() != srcNode->getKind()) {
-            mResult = ResultMsg::Error(
-                    "Source instruction `" + srcNode->toString(false) + "` " +
-                    "is not an NDIfStmt: " + mainNode->toString(false) + ".");
-            return;
-        }
-
-        auto srcIfStmt = static_cast<NDIfStmt*>(srcNode);
-        srcQOp = srcIfStmt->getQOp();
+    auto cnode = mIt[mInverseMap[tgtQubits[0]]];
 
-        for (auto cbit : mXtoNSrc.getRegUIds(srcIfStmt->getCondId()->getVal()))
-            srcOpCbits.push_back(getTgtUId(getRealSrcCUId(cbit)));
-    } else {
-        srcQOp = dynCast<NDQOp>(srcNode);
+    if (!cnode.isGateNode()) {
+        return error("Original program has reached the end while processing `" +
+                     tgtNode->toString(false) + "` of the target program.");
     }
 
-    if (srcQOp == nullptr) {
-        // Either the current node \em tgtQOp is a NDIfStmt and the circuit one is not or
-        // the other way around.
-        mResult = ResultMsg::Error(
-                "Expected `" + srcNode->toString(false) +
-                "` from source program. Got `" + mainNode->toString(false) +
-                "` from target program.");
-        return;
-    }
+    uint32_t src = cnode.id();
+    auto srcNode = mSrc.getNode(src);
+    auto srcQubits = mSrc.getQArgs(src);
 
-    auto srcQArgs = srcQOp->getQArgs();
-    uint32_t srcQArgsChildrem = srcQArgs->getChildNumber();
-
-    for (uint32_t i = 0; i < srcQArgsChildrem; ++i) {
-        uint32_t qubit = mXtoNSrc.getQUId(srcQArgs->getChild(i)->toString(false));
-        srcOpQubits.push_back(getTgtUId(qubit));
+    if (mSrc.isConditional(src) != mTgt.isConditional(tgt)) {
+        return error("Expected `" + srcNode->toString(false) + "` from source program. Got `" +
+                     tgtNode->toString(false) + "` from target program.");
     }
 
-    // All qubits involved in the current circuit node must also be involved in the current node.
-    for (uint32_t q : srcOpQubits) {
-        if (std::find(tgtOpQubits.begin(), tgtOpQubits.end(), q) == tgtOpQubits.end()) {
-            mResult = ResultMsg::Error(
-                    "Qubit `" + std::to_string(getSrcUId(q)) + " => " +
-                    std::to_string(q) + "` not being used in " +
-                    "target program (" + mainNode->toString(false) +
-                    "). Expected: `" + srcNode->toString(false) + "`.");
-            return;
+    // All qubits involved in the source gate must also be involved in the target one.
+    for (uint32_t q : srcQubits) {
+        if (std::find(tgtQubits.begin(), tgtQubits.end(), mMap[q]) == tgtQubits.end()) {
+            return error("Qubit `" + std::to_string(q) + " => " + std::to_string(mMap[q]) +
+                         "` not being used in target program (" + tgtNode->toString(false) +
+                         "). Expected: `" + srcNode->toString(false) + "`.");
         }
     }
 
-    // All qubits and cbits have reached this node (and they are not null).
-    auto firstSrcCNode = mIt[getSrcUId(srcOpQubits[0])];
-    auto firstSrcNode = firstSrcCNode->node();
-
-    if (!firstSrcCNode->isGateNode()) {
-        mResult = ResultMsg::Error(
-                "Qubit `" + std::to_string(getSrcUId(srcOpQubits[0])) + " => " +
-                std::to_string(srcOpQubits[0]) + "` has already reached its end " +
-                "while processing: " + mainNode->toString(false) + ".");
-        return;
+    // All xbits have reached the source gate.
+    if (mArrived[src] != cnode.numberOfXbits()) {
+        return error("Node `" + srcNode->toString(false) + "` still lacks some dependencies.");
     }
 
-    if (mReached[firstSrcNode]) {
-        mResult = ResultMsg::Error(
-                "Node `" + firstSrcNode->toString(false) + "` still lacks some " +
-                "dependencies.");
-        return;
-    }
+    auto srcCbits = mSrc.getCArgs(src);
 
-    // All used qubits have reached the same node (there is no instruction that is dependent
-    // of others that is being executed before its dependencies) 
-    // for (uint32_t i = 1; i < srcQArgsChildrem; ++i) {
-    //     mSuccess = mSuccess && mIt[getSrcUId(srcOpQubits[i])]->node() == firstSrcNode;
-    // }
-
-    if (srcOpCbits.size() != tgtOpCbits.size()) {
-        mResult = ResultMsg::Error(
-                "Nodes `" + srcNode->toString(false) + "` (source) and " +
-                "`" + mainNode->toString(false) + "` (target) have different " +
-                "number of concrete bits.");
-        return;
+    if (srcCbits.size() != tgtCbits.size() ||
+            !std::equal(srcCbits.begin(), srcCbits.end(), tgtCbits.begin()) ||
+            (mSrc.isConditional(src) && mSrc.getCondVal(src) != mTgt.getCondVal(tgt))) {
+        return error("Nodes `" + srcNode->toString(false) + "` (source) and `" +
+                     tgtNode->toString(false) + "` (target) use different concrete bits.");
     }
 
     // If this operation deals with more than one qubit, we assume it deals with exactly two
     // qubits, and that it is a CNOT gate.
-    if (srcOpQubits.size() > 1) {
-        if (IsCNOTGateCall(srcQOp)) {
+    if (srcQubits.size() > 1) {
+        if (isCNOT(mSrc, src)) {
             // Both CNOTs and REV_CNOTS have the same semantic.
-            // The only difference is in the way they are implemented. 
-            SemanticCNOT srcCNOT { srcOpQubits[0], srcOpQubits[1] };
-            SemanticCNOT tgtCNOT { tgtOpQubits[0], tgtOpQubits[1] };
-
-            if (!IsCNOTGateCall(tgtQOp)) {
-                auto tgtQOpGen = dynCast<NDQOpGen>(tgtQOp);
-
-                // Checking for intrinsics.
-                if (tgtQOpGen && tgtQOpGen->isIntrinsic() &&
-                        tgtQOpGen->getIntrinsicKind() == NDQOpGen::K_INTRINSIC_LCX) {
-                        tgtCNOT.u = tgtOpQubits[0];
-                        tgtCNOT.v = tgtOpQubits[2];
-                }
+            // The only difference is in the way they are implemented.
+            SemanticCNOT srcCNOT { mMap[srcQubits[0]], mMap[srcQubits[1]] };
+            SemanticCNOT tgtCNOT { tgtQubits[0], tgtQubits[1] };
+
+            if (mTgt.getKind(tgt) == GateStream::Kind::INTRINSIC_LCX) {
+                tgtCNOT.v = tgtQubits[2];
             }
 
-            // Check if, semanticaly, CNOTs are applied to the same qubits in the same order.
             if (srcCNOT != tgtCNOT) {
-                mResult = ResultMsg::Error(
-                        "CNOT error. Expected (" + std::to_string(srcCNOT.u) + ", " +
-                        std::to_string(srcCNOT.v) + "). Got (" +
-                        std::to_string(tgtCNOT.u) + ", " +
-                        std::to_string(tgtCNOT.v) + ").");
-                return;
+                return error("CNOT error. Expected (" + std::to_string(srcCNOT.u) + ", " +
+                             std::to_string(srcCNOT.v) + "). Got (" +
+                             std::to_string(tgtCNOT.u) + ", " +
+                             std::to_string(tgtCNOT.v) + ").");
             }
-
-        } else if (!instanceOf<NDQOpBarrier>(srcQOp)) {
+        } else if (mSrc.getKind(src) != GateStream::Kind::BARRIER) {
             EfdAbortIf(true,
                        "Node is neither CNOT nor Barrier. Actual: `"
-                       << srcQOp->toString(false) << "`.");
-        }
-
-    } else {
-        if (firstSrcCNode->node()->getKind() != mainNode->getKind()) {
-            mResult = ResultMsg::Error(
-                    "Wrong kind between source (" + srcNode->toString(false) + ") " +
-                    "and target (" + mainNode->toString(false) + ").");
-            return;
-        }
-
-        // Checking all real arguments.
-        auto tgtArgs = tgtQOp->getArgs();
-        auto srcArgs = srcQOp->getArgs();
-
-        if (!tgtArgs->equals(srcArgs)) {
-            mResult = ResultMsg::Error(
-                    "Real arguments do not match: `" + srcArgs->toString(false) +
-                    "`(source) and `" + tgtArgs->toString(false) + "`(target).");
-            return;
+                       << srcNode->toString(false) << "`.");
         }
+    } else if (!sameGate(src, tgt)) {
+        return error("Gates do not match: `" + srcNode->toString(false) + "` (source) and `" +
+                     tgtNode->toString(false) + "` (target).");
     }
 
-    std::vector<uint32_t> all;
-    std::vector<uint32_t> toBeAdvanced;
-
-    all.insert(all.begin(), srcOpQubits.begin(), srcOpQubits.end());
-    all.insert(all.begin(), srcOpCbits.begin(), srcOpCbits.end());
-
-    for (auto q : all) {
-        toBeAdvanced.push_back(getSrcUId(q));
+    for (auto xbit : cnode.getXbitsId()) {
+        advance(xbit);
     }
 
-    postprocessing(toBeAdvanced);
+    return true;
 }
 
-void SemanticVerifierVisitor::visit(NDQOpMeasure::Ref ref) {
-    uint32_t tgtQUId = mXtoNTgt.getQUId(ref->getQBit()->toString(false));
-    uint32_t tgtCUId = getRealTgtCUId(mXtoNTgt.getCUId(ref->getCBit()->toString(false)));
-
-    auto srcCNode = mIt[getSrcUId(tgtQUId)];
-
-    if (!srcCNode->isGateNode()) {
-        mResult = ResultMsg::Error(
-                "Source has reached the end while processing: " +
-                ref->toString(false) + ".");
-        return;
+bool StreamVerifier::run() {
+    for (uint32_t i = 0, e = mTgt.size(); i < e; ++i) {
+        if (!check(i)) return false;
     }
 
-    auto srcNode = dynCast<NDQOpMeasure>(srcCNode->node());
-
-    if (srcNode != nullptr) {
-        uint32_t srcQUId = mXtoNSrc.getQUId(srcNode->getQBit()->toString(false));
-        uint32_t srcCUId = getRealSrcCUId(mXtoNSrc.getCUId(srcNode->getCBit()->toString(false)));
-
-        if (tgtQUId != getTgtUId(srcQUId) || tgtCUId != getTgtUId(srcCUId)) {
-            mResult = ResultMsg::Error(
-                    "Measure instruction does not match: `" +
-                    srcNode->toString(false) + "`(source) and `" +
-                    ref->toString(false) + "`(target).");
-            return;
-        }
-
-        if (mReached[srcNode] && mIt[srcQUId]->node() != mIt[srcCUId]->node()) {
-            mResult = ResultMsg::Error(
-                    "Node `" + ref->toString(false) + "` still lacks some " +
-                    "dependencies.");
-            return;
+    for (uint32_t i = 0, e = mGraph.size(); i < e; ++i) {
+        if (!mIt[i].isOutputNode()) {
+            return error("Stopped at `" + mIt.get(i)->toString(false) +
+                         "` on qubit `" + std::to_string(i) + "`.");
         }
-
-        postprocessing({ srcQUId, srcCUId });
     }
-}
-
-void SemanticVerifierVisitor::visit(NDQOpReset::Ref ref) {
-    visitNDQOp(ref);
-}
-
-void SemanticVerifierVisitor::visit(NDQOpU::Ref ref) {
-    visitNDQOp(ref);
-}
 
-void SemanticVerifierVisitor::visit(NDQOpCX::Ref ref) {
-    visitNDQOp(ref);
-}
-
-void SemanticVerifierVisitor::visit(NDQOpBarrier::Ref ref) {
-    visitNDQOp(ref);
-}
-
-void SemanticVerifierVisitor::visit(NDQOpGen::Ref ref) {
-    if (ref->isIntrinsic() && ref->getIntrinsicKind() == NDQOpGen::K_INTRINSIC_SWAP) {
-        auto qargs = ref->getQArgs();
-
-        uint32_t u = mXtoNTgt.getQUId(qargs->getChild(0)->toString(false));
-        uint32_t v = mXtoNTgt.getQUId(qargs->getChild(1)->toString(false));
-
-        uint32_t a = mInverseMap[u];
-        uint32_t b = mInverseMap[v];
-
-        std::swap(mMap[a], mMap[b]);
-        std::swap(mInverseMap[u], mInverseMap[v]);
-    } else {
-        visitNDQOp(ref);
-    }
-}
-
-void SemanticVerifierVisitor::visit(NDIfStmt::Ref ref) {
-    // NOTE: if, one day, we have 'swap' nodes inside if statements, we
-    // should call 'ref->getQOp()->apply()' here.
-    visitNDQOp(ref->getQOp(), ref);
+    return true;
 }
 
 SemanticVerifierPass::SemanticVerifierPass(QModule::uRef src, Mapping initial)
@@ -420,33 +247,16 @@ bool SemanticVerifierPass::run(QModule* tgt) {
     auto inlinePass = InlineAllPass::Create(mBasis);
     PassCache::Run(mSrc.get(), inlinePass.get());
 
-    auto cktpass = PassCache::Get<CircuitGraphBuilderPass>(mSrc.get());
-    auto& ckt = cktpass->getData();
-
-    auto xtonpassSrc = PassCache::Get<XbitToNumberWrapperPass>(mSrc.get());
-    auto xtonpassTgt = PassCache::Get<XbitToNumberWrapperPass>(tgt);
+    auto& ckt = PassCache::Get<CircuitGraphBuilderPass>(mSrc.get())->getData();
+    auto& srcStream = PassCache::Get<GateStreamBuilderPass>(mSrc.get())->getData();
+    // The stream of the target is always built again, instead of trusting
+    // the one cached for it.
+    auto tgtPass = GateStreamBuilderPass::Create();
+    tgtPass->run(tgt);
 
     mData = ResultMsg::Success();
-    auto it = ckt.build_iterator();
-    SemanticVerifierVisitor visitor(mData,
-                                    xtonpassSrc->getData(),
-                                    xtonpassTgt->getData(),
-                                    it,
-                                    mInitial);
-
-    for (auto it = tgt->stmt_begin(), end = tgt->stmt_end(); it != end; ++it) {
-        (*it)->apply(&visitor);
-        if (mData.isError()) return false;
-    }
-
-    for (uint32_t i = 0, e = ckt.size(); i < e; ++i) {
-        if (!it[i]->isOutputNode()) {
-            mData = ResultMsg::Error(
-                    "Stopped at `" + it.get(i)->toString(false) +
-                    "` on qubit `" + std::to_string(i) + "`.");
-            break;
-        }
-    }
+    StreamVerifier verifier(mData, srcStream, tgtPass->getData(), ckt, mInitial);
+    verifier.run();
 
     return false;
 }
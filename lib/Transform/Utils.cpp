@@ -1,4 +1,7 @@
 #include "enfield/Transform/Utils.h"
+#include "enfield/Transform/GateTemplate.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Arch/ArchGraph.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Analysis/Driver.h"
 #include "enfield/Support/RTTI.h"
@@ -7,6 +10,7 @@
 
 #include <unordered_map>
 #include <iterator>
+#include <mutex>
 #include <iostream>
 
 using namespace efd;
@@ -36,34 +40,63 @@ StatementPair efd::GetStatementPair(const Node::Ref node) {
     return pair;
 }
 
+std::vector<uint32_t> efd::GetArchQUIds(const XbitToNumber& xton, ArchGraph& arch) {
+    std::vector<uint32_t> uids(xton.getQSize(), _undef);
+
+    for (auto& pair : xton.gidQMap) {
+        if (arch.hasSId(pair.first)) {
+            uids[pair.second.key] = arch.getUId(pair.first);
+        }
+    }
+
+    return uids;
+}
+
 // ==--------------- Intrinsic Gates ---------------==
-static std::vector<NDGateSign::uRef> IntrinsicGates;
 static const std::string IntrinsicGatesStr =
 #define EFD_LIB(...) #__VA_ARGS__
 #include "enfield/StdLib/intrinsic.inc"
 #undef EFD_LIB
 ;
 
-static void ProcessIntrinsicGates() {
-    if (IntrinsicGates.empty()) {
-        auto ast = ParseString(IntrinsicGatesStr, false);
-        EfdAbortIf(!instanceOf<NDStmtList>(ast.get()), "Intrinsic gates root node of wrong type.");
+/// \brief Moves the gate declarations in \p ast to shared pointers.
+static std::vector<NDGateSign::sRef> CollectGates(Node::uRef ast, bool inInclude) {
+    EfdAbortIf(!instanceOf<NDStmtList>(ast.get()), "Library root node of wrong type.");
 
-        for (auto& gate : *ast) {
-            auto gateNode = uniqueCastForward<NDGateSign>(std::move(gate));
-            IntrinsicGates.push_back(std::move(gateNode));
-        }
+    std::vector<NDGateSign::sRef> gates;
+    for (auto& child : *ast) {
+        if (!instanceOf<NDGateSign>(child.get())) continue;
+
+        auto gate = NDGateSign::sRef(uniqueCastForward<NDGateSign>(std::move(child)));
+        if (inInclude) gate->setInInclude();
+        gates.push_back(gate);
     }
+
+    return gates;
 }
 
-std::vector<NDGateSign::uRef> efd::GetIntrinsicGates() {
-    ProcessIntrinsicGates();
+const std::vector<NDGateSign::sRef>& efd::GetIntrinsicGates() {
+    // Never destroyed: the nodes may outlive the other static objects.
+    static auto& Gates = *new std::vector<NDGateSign::sRef>(
+            CollectGates(ParseString(IntrinsicGatesStr, false), false));
+    return Gates;
+}
 
-    std::vector<NDGateSign::uRef> gates;
-    for (auto& gate : IntrinsicGates)
-        gates.push_back(uniqueCastForward<NDGateSign>(gate->clone()));
+const std::vector<NDGateSign::sRef>* efd::GetStdLibGates(const std::string& filename) {
+    static auto& Gates = *new std::unordered_map<std::string, std::vector<NDGateSign::sRef>>();
+    static std::mutex Mutex;
 
-    return gates;
+    auto ast = GetStdLibAST(filename);
+    if (ast == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    auto it = Gates.find(filename);
+    if (it == Gates.end()) {
+        it = Gates.insert(std::make_pair(filename, CollectGates(ast->clone(), true))).first;
+    }
+
+    return &it->second;
 }
 
 namespace efd {
@@ -279,6 +312,15 @@ void efd::QModulefyVisitor::visit(NDInclude::Ref ref) {
     mMod.insertInclude(NDInclude::Create
             (std::move(fileNode), uniqueCastBackward<Node>(NDStmtList::Create())));
 
+    // The standard library gates are shared, instead of cloned.
+    if (auto gates = GetStdLibGates(ref->getFilename()->getVal())) {
+        for (auto& gate : *gates) {
+            mMod.insertSharedGate(gate);
+        }
+
+        return;
+    }
+
     mCurIncl = ref;
     visitChildren(ref);
     mCurIncl = nullptr;
@@ -347,125 +389,13 @@ void efd::ProcessAST(QModule::Ref qmod, Node::Ref root) {
 }
 
 // ==--------------- Inlining ---------------==
-namespace efd {
-    class GateInlineVisitor : public NodeVisitor {
-        private:
-            const InlineArgMap& mArgMap;
-
-        public:
-            GateInlineVisitor(const InlineArgMap& argMap) : mArgMap(argMap) {}
-
-            Node::uRef replaceChild(Node::Ref ref);
-            void substituteChildrem(Node::Ref ref);
-            void visitAllQOp(NDQOp::Ref ref);
-
-            void visit(NDQOpU::Ref ref) override;
-            void visit(NDQOpCX::Ref ref) override;
-            void visit(NDList::Ref ref) override;
-            void visit(NDQOpBarrier::Ref ref) override;
-            void visit(NDQOpGen::Ref ref) override;
-            void visit(NDBinOp::Ref ref) override;
-            void visit(NDUnaryOp::Ref ref) override;
-            void visit(NDIfStmt::Ref ref) override;
-    };
-}
-
-Node::uRef efd::GateInlineVisitor::replaceChild(Node::Ref child) {
-    auto id = child->toString();
-
-    if (mArgMap.find(id) != mArgMap.end()) {
-        return mArgMap.at(id)->clone();
-    }
-
-    return Node::uRef(nullptr);
-}
-
-void efd::GateInlineVisitor::substituteChildrem(Node::Ref ref) {
-    for (uint32_t i = 0, e = ref->getChildNumber(); i < e; ++i) {
-        auto newChild = replaceChild(ref->getChild(i));
-        if (newChild.get() != nullptr) {
-            ref->setChild(i, std::move(newChild));
-        }
-    }
-}
-
-void efd::GateInlineVisitor::visitAllQOp(NDQOp::Ref ref) {
-    ref->getArgs()->apply(this);
-    ref->getQArgs()->apply(this);
-}
-
-void efd::GateInlineVisitor::visit(NDList::Ref ref) {
-    visitChildren(ref);
-    substituteChildrem(ref);
-}
-
-void efd::GateInlineVisitor::visit(NDQOpU::Ref ref) {
-    visitAllQOp((NDQOp::Ref) ref);
-}
-
-void efd::GateInlineVisitor::visit(NDQOpCX::Ref ref) {
-    visitAllQOp((NDQOp::Ref) ref);
-}
-
-void efd::GateInlineVisitor::visit(NDQOpBarrier::Ref ref) {
-    visitAllQOp((NDQOp::Ref) ref);
-}
-
-void efd::GateInlineVisitor::visit(NDQOpGen::Ref ref) {
-    visitAllQOp((NDQOp::Ref) ref);
-}
-
-void efd::GateInlineVisitor::visit(NDBinOp::Ref ref) {
-    ref->getLhs()->apply(this);
-    ref->getRhs()->apply(this);
-    substituteChildrem(ref);
-}
-
-void efd::GateInlineVisitor::visit(NDUnaryOp::Ref ref) {
-    visitChildren(ref);
-    substituteChildrem(ref);
-}
-
-void efd::GateInlineVisitor::visit(NDIfStmt::Ref ref) {
-    // We only need to visit the qop.
-    ref->getQOp()->apply(this);
-}
-
-InlineArgMap efd::CreateInlineArgMap(NDGateDecl::Ref gateDecl, NDQOp::Ref call) {
-    InlineArgMap argMap;
-
-    Node::Ref gateQArgs = gateDecl->getQArgs();
-    Node::Ref callQArgs = call->getQArgs();
-    for (uint32_t i = 0, e = gateQArgs->getChildNumber(); i < e; ++i)
-        argMap[gateQArgs->getChild(i)->toString()] = callQArgs->getChild(i);
-    
-    Node::Ref gateArgs = gateDecl->getArgs();
-    Node::Ref callArgs = call->getArgs();
-    for (uint32_t i = 0, e = gateArgs->getChildNumber(); i < e; ++i)
-        argMap[gateArgs->getChild(i)->toString()] = callArgs->getChild(i);
-
-    return argMap;
-}
-
-void efd::ReplaceInlineArgMap(const InlineArgMap& argMap,
-                              std::vector<Node::uRef>& inlinedInstructions,
-                              NDIfStmt::Ref ifstmt) {
-    GateInlineVisitor visitor(argMap);
-
-    for (auto& qop : inlinedInstructions) {
-        // If its parent is an NDIfStmt, we wrap the the operation into
-        // a clone of the if.
-        if (ifstmt != nullptr) {
-            auto ifclone = uniqueCastForward<NDIfStmt>(ifstmt->clone());
-            ifclone->setQOp(uniqueCastForward<NDQOp>(std::move(qop)));
-            qop.reset(ifclone.release());
-        }
-
-        qop->apply(&visitor);
-    }
-}
-
-void efd::InlineGate(QModule::Ref qmod, NDQOp::Ref qop) {
+/// \brief Creates the statements that replace \p qop when inlining it.
+///
+/// Also sets \p stmt to the statement that should be replaced (\p qop itself,
+/// or its \em NDIfStmt parent).
+static std::vector<Node::uRef> CreateInlinedStatements(QModule::Ref qmod,
+                                                       NDQOp::Ref qop,
+                                                       Node::Ref& stmt) {
     std::string gateId = qop->getId()->getVal();
     
     auto gate = qmod->getQGate(gateId);
@@ -475,15 +405,22 @@ void efd::InlineGate(QModule::Ref qmod, NDQOp::Ref qop) {
     EfdAbortIf(gateDecl == nullptr, "No gate with such id found: `" << gateId << "`.");
 
     // Replace the arguments.
-    std::vector<Node::uRef> inlinedInstructions;
-    auto argMap = CreateInlineArgMap(gateDecl, qop);
+    std::vector<Node::uRef> body;
     auto ifstmt = dynCast<NDIfStmt>(qop->getParent());
 
     for (auto& innerOp : *(gateDecl->getGOpList())) {
-        inlinedInstructions.push_back(innerOp->clone());
+        body.push_back(innerOp->clone());
     }
 
-    auto stmt = (ifstmt == nullptr) ? (Node::Ref) qop : (Node::Ref) ifstmt;
-    ReplaceInlineArgMap(argMap, inlinedInstructions, ifstmt);
+    std::vector<Node::uRef> inlinedInstructions;
+    GateTemplate::Create(gateDecl, std::move(body))->expand(qop, inlinedInstructions, ifstmt);
+
+    stmt = (ifstmt == nullptr) ? (Node::Ref) qop : (Node::Ref) ifstmt;
+    return inlinedInstructions;
+}
+
+void efd::InlineGate(QModule::Ref qmod, NDQOp::Ref qop) {
+    Node::Ref stmt = nullptr;
+    auto inlinedInstructions = CreateInlinedStatements(qmod, qop, stmt);
     qmod->replaceStatement(stmt, std::move(inlinedInstructions));
 }
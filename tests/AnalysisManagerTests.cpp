@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/InlineAllPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/CircuitGraphBuilderPass.h"
+
+#include <thread>
+
+using namespace efd;
+
+static const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+cx q[0], q[1];\
+cx q[1], q[2];\
+measure q -> c;\
+";
+
+TEST(AnalysisManagerTests, AnalysesAreCached) {
+    auto qmod = QModule::ParseString(program);
+
+    auto xton = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    auto deps = PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+    ASSERT_EQ(PassCache::Get<XbitToNumberWrapperPass>(qmod.get()), xton);
+    ASSERT_EQ(PassCache::Get<DependencyBuilderWrapperPass>(qmod.get()), deps);
+
+    PassCache::Clear(qmod.get());
+    ASSERT_FALSE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+}
+
+TEST(AnalysisManagerTests, OnlyPreservedAnalysesSurvive) {
+    auto qmod = QModule::ParseString(program);
+
+    auto xton = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+
+    // FlattenPass only modifies the statements.
+    PassCache::Run<FlattenPass>(qmod.get());
+
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_FALSE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+    ASSERT_EQ(PassCache::Get<XbitToNumberWrapperPass>(qmod.get()), xton);
+}
+
+TEST(AnalysisManagerTests, InliningInvalidatesNodeAnalyses) {
+    auto qmod = QModule::ParseString(program);
+    PassCache::Run<FlattenPass>(qmod.get());
+
+    // Nothing to inline: the statements are kept.
+    auto nothing = InlineAllPass::Create({ "cx", "measure" });
+    PassCache::Get<GateStreamBuilderPass>(qmod.get());
+    PassCache::Run(qmod.get(), nothing.get());
+    ASSERT_TRUE(PassCache::Has<GateStreamBuilderPass>(qmod.get()));
+
+    // Inlining `cx` frees the nodes the stream points to.
+    auto inliner = InlineAllPass::Create();
+    PassCache::Run(qmod.get(), inliner.get());
+    ASSERT_FALSE(PassCache::Has<GateStreamBuilderPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+}
+
+TEST(AnalysisManagerTests, ModulesAreIndependent) {
+    auto qmod = QModule::ParseString(program);
+    auto other = qmod->clone();
+
+    PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_FALSE(PassCache::Has<XbitToNumberWrapperPass>(other.get()));
+}
+
+TEST(AnalysisManagerTests, ConcurrentQueries) {
+    const uint32_t threadsNumber = 8;
+
+    std::vector<QModule::uRef> qmods;
+    for (uint32_t i = 0; i < threadsNumber; ++i) {
+        qmods.push_back(QModule::ParseString(program));
+        PassCache::Run<FlattenPass>(qmods.back().get());
+    }
+
+    std::vector<CircuitGraphBuilderPass*> shared(threadsNumber, nullptr);
+    std::vector<CircuitGraphBuilderPass*> own(threadsNumber, nullptr);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < threadsNumber; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            shared[i] = PassCache::Get<CircuitGraphBuilderPass>(qmods[0].get());
+            own[i] = PassCache::Get<CircuitGraphBuilderPass>(qmods[i].get());
+        }));
+    }
+
+    for (auto& t : threads) t.join();
+
+    for (uint32_t i = 0; i < threadsNumber; ++i) {
+        ASSERT_EQ(shared[i], PassCache::Get<CircuitGraphBuilderPass>(qmods[0].get()));
+        ASSERT_EQ(own[i], PassCache::Get<CircuitGraphBuilderPass>(qmods[i].get()));
+        ASSERT_EQ(own[i]->getData().getQSize(), 3u);
+    }
+}
@@ -104,3 +104,40 @@ TEST(BFSCachedDistanceTests, DirectedDistanceTests) {
         ASSERT_EQ(bfsDistance->get(4, 0), (uint32_t) 4);
     }
 }
+
+TEST(BFSCachedDistanceTests, GraphsWithTheSameEdgesShareTheirDistances) {
+    const std::string lineStr =
+"{\
+    \"vertices\": 3,\
+    \"type\": \"Undirected\",\
+    \"adj\": [\
+        [ {\"v\": 1} ],\
+        [ {\"v\": 2} ],\
+        []\
+    ]\
+}";
+
+    const std::string triangleStr =
+"{\
+    \"vertices\": 3,\
+    \"type\": \"Undirected\",\
+    \"adj\": [\
+        [ {\"v\": 1}, {\"v\": 2} ],\
+        [ {\"v\": 2} ],\
+        []\
+    ]\
+}";
+
+    auto line = JsonParser<Graph>::ParseString(lineStr);
+    auto sameLine = JsonParser<Graph>::ParseString(lineStr);
+    auto triangle = JsonParser<Graph>::ParseString(triangleStr);
+
+    auto lineDistance = BFSCachedDistance::GetDistanceMatrix(line.get());
+    ASSERT_EQ(lineDistance, BFSCachedDistance::GetDistanceMatrix(sameLine.get()));
+    ASSERT_NE(lineDistance, BFSCachedDistance::GetDistanceMatrix(triangle.get()));
+
+    auto bfsDistance = BFSCachedDistance::Create();
+    bfsDistance->init(triangle.get());
+    ASSERT_EQ((*lineDistance)[0][2], (uint32_t) 2);
+    ASSERT_EQ(bfsDistance->get(0, 2), (uint32_t) 1);
+}
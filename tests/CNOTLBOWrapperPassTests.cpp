@@ -149,3 +149,31 @@ measure q[3] -> c[3];\
         CheckOrdering(program, { 0, 2, 4, 6, 1, 3, 5, 7 });
     }
 }
+
+TEST(CNOTLBOWrapperPassTests, ReorderTwice) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[5];\
+cx q[0], q[1];\
+h q[4];\
+cx q[0], q[1];\
+cx q[2], q[3];\
+h q[2];\
+cx q[0], q[1];\
+cx q[3], q[4];\
+";
+
+    // The ordering of the second run refers to the reordered statements.
+    auto qmod = QModule::ParseString(program);
+    PassCache::Run<CNOTLBOWrapperPass>(qmod.get());
+    PassCache::Run<CNOTLBOWrapperPass>(qmod.get());
+
+    auto expected = QModule::ParseString(program);
+    PassCache::Run<CNOTLBOWrapperPass>(expected.get());
+    expected = QModule::ParseString(expected->toString());
+    PassCache::Run<CNOTLBOWrapperPass>(expected.get());
+
+    ASSERT_EQ(expected->toString(), qmod->toString());
+}
@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/CircuitAnalysisPass.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/LayersBuilderPass.h"
+#include "enfield/Transform/PassCache.h"
+
+#include <string>
+
+using namespace efd;
+
+static std::vector<std::string> GetGates(QModule::Ref qmod) {
+    auto& stream = PassCache::Get<GateStreamBuilderPass>(qmod)->getData();
+    std::vector<std::string> gates;
+
+    for (uint32_t i = 0, e = stream.size(); i < e; ++i) {
+        std::string gate = stream.getNode(i)->toString(false);
+        for (auto q : stream.getQArgs(i)) gate += " q" + std::to_string(q);
+        for (auto c : stream.getCArgs(i)) gate += " c" + std::to_string(c);
+        gates.push_back(gate);
+    }
+
+    return gates;
+}
+
+static std::vector<std::string> GetDependencies(QModule::Ref qmod) {
+    auto& depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
+    std::vector<std::string> deps;
+
+    for (auto& parallel : depBuilder.getDependencies()) {
+        std::string str = parallel.mCallPoint->toString(false);
+        for (auto& dep : parallel) {
+            str += " (" + std::to_string(dep.mFrom) + ", " + std::to_string(dep.mTo) + ")";
+        }
+        deps.push_back(str);
+    }
+
+    return deps;
+}
+
+static std::vector<std::vector<std::string>> GetWires(QModule::Ref qmod) {
+    auto& graph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
+    auto it = graph.build_iterator();
+    std::vector<std::vector<std::string>> wires(graph.size());
+
+    for (uint32_t i = 0, e = graph.size(); i < e; ++i) {
+        for (it.next(i); !it[i].isOutputNode(); it.next(i)) {
+            wires[i].push_back(it[i].node()->toString(false));
+        }
+    }
+
+    return wires;
+}
+
+static std::vector<std::vector<std::string>> GetLayers(QModule::Ref qmod) {
+    auto& layers = PassCache::Get<LayersBuilderPass>(qmod)->getData();
+    std::vector<std::vector<std::string>> strLayers;
+
+    for (auto layer : layers) {
+        strLayers.push_back({});
+        for (auto node : layer) strLayers.back().push_back(node->toString(false));
+    }
+
+    return strLayers;
+}
+
+static void CheckSameAsSeparatePasses(const std::string& program) {
+    auto separate = QModule::ParseString(program);
+    PassCache::Run<FlattenPass>(separate.get());
+
+    auto fused = QModule::ParseString(program);
+    PassCache::Run<CircuitAnalysisPass>(fused.get());
+
+    // Every analysis was published, and survived the flattening.
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(fused.get()));
+    ASSERT_TRUE(PassCache::Has<GateStreamBuilderPass>(fused.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyBuilderWrapperPass>(fused.get()));
+    ASSERT_TRUE(PassCache::Has<CircuitGraphBuilderPass>(fused.get()));
+    ASSERT_TRUE(PassCache::Has<LayersBuilderPass>(fused.get()));
+
+    ASSERT_EQ(separate->toString(), fused->toString());
+    ASSERT_EQ(PassCache::Get<XbitToNumberWrapperPass>(separate.get())->getData().getQSize(),
+              PassCache::Get<XbitToNumberWrapperPass>(fused.get())->getData().getQSize());
+    ASSERT_EQ(GetGates(separate.get()), GetGates(fused.get()));
+    ASSERT_EQ(GetDependencies(separate.get()), GetDependencies(fused.get()));
+    ASSERT_EQ(GetWires(separate.get()), GetWires(fused.get()));
+    ASSERT_EQ(GetLayers(separate.get()), GetLayers(fused.get()));
+}
+
+TEST(CircuitAnalysisPassTests, FlatProgram) {
+    const std::string program =
+"\
+include \"qelib1.inc\";\
+qreg q[4];\
+creg c[4];\
+cx q[0], q[1];\
+h q[2];\
+cx q[2], q[3];\
+cx q[1], q[2];\
+measure q[0] -> c[0];\
+if (c == 1) cx q[3], q[0];\
+";
+
+    CheckSameAsSeparatePasses(program);
+}
+
+TEST(CircuitAnalysisPassTests, FlattensTheModule) {
+    const std::string program =
+"\
+include \"qelib1.inc\";\
+gate mygate a, b, c {\
+    cx a, b;\
+    cx b, c;\
+}\
+qreg q[3];\
+qreg r[3];\
+creg c[3];\
+h q;\
+cx q, r;\
+mygate q[0], r[1], q[2];\
+measure r -> c;\
+if (c == 2) cx r, q;\
+barrier q;\
+";
+
+    CheckSameAsSeparatePasses(program);
+}
+
+TEST(CircuitAnalysisPassTests, KeepsTheNodesOfTheModule) {
+    const std::string program =
+"\
+include \"qelib1.inc\";\
+qreg q[2];\
+qreg r[2];\
+cx q, r;\
+";
+
+    auto qmod = QModule::ParseString(program);
+    PassCache::Run<CircuitAnalysisPass>(qmod.get());
+
+    auto& stream = PassCache::Get<GateStreamBuilderPass>(qmod.get())->getData();
+    ASSERT_EQ(qmod->getNumberOfStmts(), stream.size());
+
+    uint32_t i = 0;
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it, ++i) {
+        ASSERT_EQ(it->get(), stream.getNode(i));
+    }
+}
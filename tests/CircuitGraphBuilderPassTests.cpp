@@ -23,8 +23,8 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
 
     for (uint32_t i = 0; i < xbits; ++i) {
         it.next(i);
-        if (checker.gused[i]) ASSERT_TRUE(it[i]->isGateNode());
-        else ASSERT_FALSE(it[i]->isGateNode());
+        if (checker.gused[i]) ASSERT_TRUE(it[i].isGateNode());
+        else ASSERT_FALSE(it[i].isGateNode());
     }
 
     bool stop;
@@ -33,29 +33,29 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
 
     do {
         stop = true;
-        std::set<CircuitGraph::CircuitNode::sRef> completed;
+        std::set<CircuitGraph::CircuitNode> completed;
 
         for (uint32_t i = 0; i < xbits; ++i) {
-            if (it[i]->isGateNode() && !marked[i]) {
-                auto node = it[i]->node();
+            if (it[i].isGateNode() && !marked[i]) {
+                auto node = it[i].node();
                 marked[i] = true;
 
                 if (reached.find(node) == reached.end())
-                    reached[node] = it[i]->numberOfXbits();
+                    reached[node] = it[i].numberOfXbits();
                 --reached[node];
             }
         }
 
         for (uint32_t i = 0; i < xbits; ++i) {
-            auto node = it[i]->node();
+            auto node = it[i].node();
 
-            if (it[i]->isGateNode() && !reached[node]) {
+            if (it[i].isGateNode() && !reached[node]) {
                 completed.insert(it[i]);
                 marked[i] = false;
                 it.next(i);
             }
 
-            if (!it[i]->isOutputNode()) stop = false;
+            if (!it[i].isOutputNode()) stop = false;
         }
 
         for (auto cnode : completed) {
@@ -65,7 +65,7 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
             for (uint32_t e = checker.used.size(); i < e; ++i) {
                 std::set<uint32_t> idSet;
 
-                for (uint32_t id: cnode->getXbitsId()) {
+                for (uint32_t id: cnode.getXbitsId()) {
                     idSet.insert(id);
                 }
 
@@ -330,3 +330,41 @@ measure q[3] -> c[3];\
                 });
     }
 }
+
+TEST(CircuitGraphBuilderPassTests, ReversedGraph) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+h q[2];\
+cx q[1], q[2];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto stream = GateStream();
+    auto xtonPass = XbitToNumberWrapperPass::Create();
+    xtonPass->run(qmod.get());
+
+    auto& xton = xtonPass->getData();
+    stream.init(xton);
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        stream.append(it->get(), xton);
+    }
+
+    auto cgraph = BuildCircuitGraph(stream, true);
+    auto it = cgraph.build_iterator();
+
+    // The first gate of every qubit is the last one in the original order.
+    for (uint32_t i = 0; i < 3; ++i) it.next(i);
+    ASSERT_EQ(it.get(0), qmod->getStatement(0));
+    ASSERT_EQ(it.get(1), qmod->getStatement(2));
+    ASSERT_EQ(it.get(2), qmod->getStatement(2));
+
+    it.next(1);
+    it.next(2);
+    ASSERT_EQ(it.get(1), qmod->getStatement(0));
+    ASSERT_EQ(it.get(2), qmod->getStatement(1));
+}
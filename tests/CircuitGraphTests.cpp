@@ -27,12 +27,12 @@ void FullTest(uint32_t qubits, uint32_t cbits, std::vector<std::vector<Xbit>> ga
 
     for (uint32_t i = 0; i < qubits; ++i) {
         ASSERT_TRUE(it.next(Xbit::Q(i)));
-        ASSERT_TRUE(it[Xbit::Q(i)]->isOutputNode());
+        ASSERT_TRUE(it[Xbit::Q(i)].isOutputNode());
     }
 
     for (uint32_t i = 0; i < cbits; ++i) {
         ASSERT_TRUE(it.next(Xbit::C(i)));
-        ASSERT_TRUE(it[Xbit::C(i)]->isOutputNode());
+        ASSERT_TRUE(it[Xbit::C(i)].isOutputNode());
     }
 }
 
@@ -132,9 +132,49 @@ TEST(CircuitGraphTests, ClassicalQuantumBits) {
             });
 }
 
+TEST(CircuitGraphTests, GateNodes) {
+    CircuitGraph ckt(2, 1);
+    ckt.append({ Xbit::Q(0), Xbit::Q(1) }, reinterpret_cast<Node::Ref>(1));
+    // Repeated bits (e.g.: the condition and the target of a measure) are
+    // only considered once.
+    ckt.append({ Xbit::C(0), Xbit::Q(1), Xbit::C(0) }, reinterpret_cast<Node::Ref>(2));
+
+    ASSERT_EQ(2u, ckt.getNumberOfGates());
+    ASSERT_EQ(2u, ckt.getGate(1).numberOfXbits());
+    ASSERT_EQ(2u, ckt.getGate(1).getXbitsId()[0]);
+    ASSERT_EQ(1u, ckt.getGate(1).getXbitsId()[1]);
+
+    auto it = ckt.build_iterator();
+    ASSERT_TRUE(it[1].isInputNode());
+    ASSERT_EQ(nullptr, it.get(1));
+    ASSERT_FALSE(it.back(1));
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_TRUE(it.next(0));
+    ASSERT_TRUE(it[0] == it[1]);
+    ASSERT_TRUE(it[0] == ckt.getGate(0));
+    ASSERT_EQ(0u, it[0].id());
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_TRUE(it.next(2));
+    ASSERT_TRUE(it[1] == it[2]);
+    ASSERT_TRUE(it[0] < it[1]);
+    ASSERT_EQ(reinterpret_cast<Node::Ref>(2), it.get(2));
+
+    ASSERT_TRUE(it.back(1));
+    ASSERT_EQ(reinterpret_cast<Node::Ref>(1), it.get(1));
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_TRUE(it.next(1));
+    ASSERT_TRUE(it[1].isOutputNode());
+    ASSERT_EQ(0u, it[1].numberOfXbits());
+    ASSERT_FALSE(it.next(1));
+}
+
 TEST(CircuitGraphTests, ErrorTests) {
     ASSERT_DEATH({ CircuitGraph ckt; ckt.append({}, nullptr); }, "");
     ASSERT_DEATH({ CircuitGraph ckt; ckt.build_iterator(); }, "");
+    ASSERT_DEATH({ CircuitGraph ckt(1, 0); ckt.getGate(0); }, "");
     ASSERT_DEATH({ FullTest(5, 5, { { Xbit::Q(0), Xbit::C(9) } }); }, ""); 
     ASSERT_DEATH({ FullTest(5, 5, { { Xbit::Q(1), Xbit::C(8) } }); }, "");
     ASSERT_DEATH({ FullTest(5, 5, { { Xbit::Q(2), Xbit::C(7) } }); }, "");
@@ -0,0 +1,148 @@
+
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/CompilationCache.h"
+#include "enfield/Arch/Architectures.h"
+
+#include <cstdlib>
+#include <dirent.h>
+
+using namespace efd;
+
+static const std::string Program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+cx q[1], q[2];\
+";
+
+static std::string CreateTmpDir() {
+    char dir[] = "/tmp/efd-cache-XXXXXX";
+    EXPECT_NE(mkdtemp(dir), nullptr);
+    return dir;
+}
+
+static uint32_t CountFiles(const std::string& path) {
+    uint32_t count = 0;
+
+    if (auto dir = opendir(path.c_str())) {
+        while (auto entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') ++count;
+        }
+
+        closedir(dir);
+    }
+
+    return count;
+}
+
+static CompilationSettings DefaultSettings() {
+    InitializeAllArchitectures();
+
+    CompilationSettings settings {
+        CreateArchitecture(Architecture::A_ibmqx2),
+        Allocator::Q_sabre,
+        { {"U", 1}, {"CX", 10} },
+        false,
+        true,
+        false
+    };
+
+    settings.allocatorOptions.seed = 1;
+    return settings;
+}
+
+static std::string Key(const std::string& program, const CompilationSettings& settings) {
+    auto qmod = QModule::ParseString(program);
+    return CompilationCache::ComputeKey(qmod.get(), settings);
+}
+
+TEST(CompilationCacheTests, KeyDependsOnEverySetting) {
+    auto settings = DefaultSettings();
+    auto key = Key(Program, settings);
+
+    EXPECT_EQ(key.size(), 32u);
+    EXPECT_EQ(key, Key(Program, settings));
+
+    // Formatting does not change the flattened module.
+    std::string spaced = Program;
+    spaced.replace(spaced.find("cx q[0], q[1];"), 14, "cx  q[0],q[1] ;");
+    EXPECT_EQ(key, Key(spaced, settings));
+
+    std::string other = Program;
+    other.replace(other.find("cx q[0], q[1];"), 14, "cx q[1], q[0];");
+    EXPECT_NE(key, Key(other, settings));
+
+    auto changed = settings;
+    changed.allocatorOptions.seed = 2;
+    EXPECT_NE(key, Key(Program, changed));
+
+    changed = settings;
+    changed.allocator = Allocator::Q_bmt;
+    EXPECT_NE(key, Key(Program, changed));
+
+    changed = settings;
+    changed.gWeightMap["CX"] = 20;
+    EXPECT_NE(key, Key(Program, changed));
+
+    changed = settings;
+    changed.archGraph = CreateArchitecture(Architecture::A_ibmqx3);
+    EXPECT_NE(key, Key(Program, changed));
+}
+
+TEST(CompilationCacheTests, StoredEntriesAreFound) {
+    auto dir = CreateTmpDir();
+    auto cache = CompilationCache::Create(dir, 1 << 20);
+
+    CompilationCache::Entry entry;
+    EXPECT_FALSE(cache->lookup("0123", entry));
+
+    cache->store("0123", CompilationCache::Entry { "qreg q[5];\ncx q[0], q[1];\n", { 2, 3, 4 } });
+    ASSERT_TRUE(cache->lookup("0123", entry));
+    EXPECT_EQ(entry.output, "qreg q[5];\ncx q[0], q[1];\n");
+    EXPECT_EQ(entry.quality.mDepth, 2u);
+    EXPECT_EQ(entry.quality.mGates, 3u);
+    EXPECT_EQ(entry.quality.mWeightedCost, 4u);
+
+    // Another instance over the same directory.
+    auto other = CompilationCache::Create(dir, 1 << 20);
+    EXPECT_TRUE(other->lookup("0123", entry));
+}
+
+TEST(CompilationCacheTests, KeepsTheStats) {
+    auto dir = CreateTmpDir();
+    auto cache = CompilationCache::Create(dir, 1 << 20);
+
+    StatRecords stats {
+        { "Swaps", "Number of swaps found.", "7" },
+        { "AllocTime", "Time to allocate all qubits.", "0.250000" }
+    };
+
+    cache->store("0123", CompilationCache::Entry { "cx q[0], q[1];\n", { 1, 1, 10 }, stats });
+
+    CompilationCache::Entry entry;
+    ASSERT_TRUE(cache->lookup("0123", entry));
+    EXPECT_EQ(entry.output, "cx q[0], q[1];\n");
+    ASSERT_EQ(entry.stats.size(), 2u);
+    EXPECT_EQ(entry.stats[0].mName, "Swaps");
+    EXPECT_EQ(entry.stats[0].mValue, "7");
+    EXPECT_EQ(entry.stats[1].mName, "AllocTime");
+    EXPECT_EQ(entry.stats[1].mValue, "0.250000");
+}
+
+TEST(CompilationCacheTests, EvictsWhenFull) {
+    auto dir = CreateTmpDir();
+    auto cache = CompilationCache::Create(dir, 1000);
+    std::string output(300, 'x');
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        cache->store("key" + std::to_string(i), CompilationCache::Entry { output, { 0, 0, 0 } });
+        EXPECT_LE(CountFiles(dir), 3u);
+    }
+
+    // The last one stored is never evicted.
+    CompilationCache::Entry entry;
+    EXPECT_TRUE(cache->lookup("key9", entry));
+}
@@ -0,0 +1,202 @@
+
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/CompileServer.h"
+#include "enfield/Arch/Architectures.h"
+
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace efd;
+
+static const std::string Program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+cx q[1], q[2];\
+cx q[0], q[2];\
+";
+
+static std::string Request(const std::string& header, const std::string& body) {
+    return header + "length=" + std::to_string(body.size()) + "\n\n" + body;
+}
+
+static CompileServer::Header ReadHeader(std::istream& in) {
+    CompileServer::Header header;
+
+    for (std::string line; std::getline(in, line) && !line.empty();) {
+        auto eq = line.find('=');
+        header[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+
+    return header;
+}
+
+static CompilationSettings DefaultSettings() {
+    InitializeAllQbitAllocators();
+    InitializeAllArchitectures();
+
+    CompilationSettings settings {
+        CreateArchitecture(Architecture::A_ibmqx2),
+        Allocator::Q_sabre,
+        { {"U", 1}, {"CX", 10} },
+        false,
+        true,
+        false
+    };
+
+    return settings;
+}
+
+TEST(CompileServerTests, ServesManyRequests) {
+    auto server = CompileServer::Create(DefaultSettings());
+
+    std::istringstream in(
+            Request("", Program) +
+            Request("alloc=Q_bmt\narch=A_ibmqx3\npretty=0\n", Program));
+    std::ostringstream out;
+    server->serve(in, out);
+
+    std::istringstream responses(out.str());
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        auto header = ReadHeader(responses);
+        ASSERT_EQ(header["status"], "ok");
+        EXPECT_FALSE(header["Depth"].empty());
+        EXPECT_FALSE(header["Gates"].empty());
+        EXPECT_FALSE(header["WeightedCost"].empty());
+
+        std::string body(std::stoul(header["length"]), '\0');
+        responses.read(&body[0], body.size());
+        EXPECT_NE(body.find("qreg q[" + std::string(i == 0 ? "5" : "16") + "];"),
+                  std::string::npos);
+    }
+
+    EXPECT_EQ(responses.peek(), std::char_traits<char>::eof());
+}
+
+TEST(CompileServerTests, ReportsErrorsAndGoesOn) {
+    auto server = CompileServer::Create(DefaultSettings());
+
+    std::istringstream in(
+            Request("alloc=Q_none\n", Program) +
+            Request("seed=abc\n", Program) +
+            Request("", "qreg q[3]; cx q[0]") +
+            Request("seed=5\n", Program));
+    std::ostringstream out;
+    server->serve(in, out);
+
+    std::istringstream responses(out.str());
+    std::vector<std::string> status;
+
+    while (responses.peek() != std::char_traits<char>::eof()) {
+        auto header = ReadHeader(responses);
+        status.push_back(header["status"]);
+
+        std::string body(std::stoul(header["length"]), '\0');
+        responses.read(&body[0], body.size());
+    }
+
+    EXPECT_EQ(status, std::vector<std::string>({ "error", "error", "error", "ok" }));
+}
+
+TEST(CompileServerTests, ConsultsTheCache) {
+    char dir[] = "/tmp/efd-server-cache-XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    auto cache = CompilationCache::Create(dir, 1 << 20);
+    auto server = CompileServer::Create(DefaultSettings());
+    server->setCache(cache.get());
+
+    std::istringstream in(
+            Request("seed=3\nstats=1\n", Program) +
+            Request("seed=3\nstats=1\n", Program));
+    std::ostringstream out;
+    server->serve(in, out);
+
+    std::istringstream responses(out.str());
+    std::vector<CompileServer::Header> headers;
+    std::vector<std::string> bodies;
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        headers.push_back(ReadHeader(responses));
+        ASSERT_EQ(headers[i]["status"], "ok");
+
+        bodies.push_back(std::string(std::stoul(headers[i]["length"]), '\0'));
+        responses.read(&bodies[i][0], bodies[i].size());
+    }
+
+    EXPECT_EQ(bodies[0], bodies[1]);
+    EXPECT_EQ(headers[0]["WeightedCost"], headers[1]["WeightedCost"]);
+
+    EXPECT_NE(headers[0]["stats"].find("\"CacheMisses\": 1"), std::string::npos);
+    EXPECT_NE(headers[1]["stats"].find("\"CacheHits\": 1"), std::string::npos);
+
+    // The stats of the compilation come along with the cached result.
+    EXPECT_NE(headers[1]["stats"].find("\"AllocTime\""), std::string::npos);
+}
+
+TEST(CompileServerTests, RejectsOversizedBodies) {
+    auto server = CompileServer::Create(DefaultSettings());
+
+    std::istringstream in(
+            "length=" + std::to_string(CompileServer::MaxBodyLength + 1) + "\n\n" +
+            Request("", Program));
+    std::ostringstream out;
+    server->serve(in, out);
+
+    std::istringstream responses(out.str());
+    auto header = ReadHeader(responses);
+    EXPECT_EQ(header["status"], "error");
+    EXPECT_EQ(header["length"], "0");
+
+    // The connection is dropped, instead of reading the body.
+    EXPECT_EQ(responses.peek(), std::char_traits<char>::eof());
+}
+
+TEST(CompileServerTests, QuitStopsTheSocketServer) {
+    auto server = CompileServer::Create(DefaultSettings());
+    std::string path = "/tmp/efd-compile-server-test-" + std::to_string(::getpid());
+
+    bool served = false;
+    std::thread serving([&]() { served = server->serveUnixSocket(path, 2); });
+
+    int fd = -1;
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Waits for the server to listen.
+    for (uint32_t i = 0; i < 500 && fd < 0; ++i) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, (sockaddr*) &addr, sizeof(addr)) < 0) {
+            ::close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    ASSERT_GE(fd, 0);
+
+    std::string request = "quit=1\n\n";
+    ASSERT_EQ(::send(fd, request.data(), request.size(), 0), (ssize_t) request.size());
+
+    std::string response;
+    char buf[256];
+    for (ssize_t n; (n = ::recv(fd, buf, sizeof(buf), 0)) > 0;) response.append(buf, n);
+    ::close(fd);
+
+    serving.join();
+
+    EXPECT_TRUE(served);
+    EXPECT_EQ(response.find("status=ok\n"), (std::size_t) 0);
+}
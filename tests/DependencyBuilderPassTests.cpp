@@ -46,7 +46,7 @@ gate cnot x, y {\
         ASSERT_FALSE(deps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOpCX>(deps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -101,7 +101,7 @@ gate cnot x, y {\
         ASSERT_FALSE(cnotDeps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOp>(cnotDeps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
 
@@ -133,7 +133,7 @@ CX q[0], q[1];\
         ASSERT_FALSE(deps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOpCX>(deps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -211,6 +211,6 @@ measure carry[0] -> carryout[0];\
             ASSERT_EQ(sum, pair.second.second);
         }
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
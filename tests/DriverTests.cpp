@@ -346,6 +346,31 @@ generic((((1 + 3) * 5) + (pi * sin(pi)))) r0;\
     }
 }
 
+TEST(DriverTests, LiteralTest) {
+    {
+        std::string literals =
+"\
+U(0.5e3, .5, 1E-2, 12, 0) q;// comment\n\
+\r\n\
+CX a, b;\
+";
+        std::string literalsPrt =
+"\
+U(0.5e3, .5, 1E-2, 12, 0) q;\
+CX a, b;\
+";
+        auto root = ParseString(literals, false);
+        ASSERT_FALSE(root.get() == nullptr);
+        ASSERT_EQ(root->toString(), literalsPrt);
+    }
+
+    {
+        // An integer is either `0`, or has no leading zeros.
+        auto root = ParseString("generic(007) r0;", false);
+        ASSERT_TRUE(root.get() == nullptr);
+    }
+}
+
 TEST(DriverTests, IfStmtTest) {
     {
         std::string ifStmt = 
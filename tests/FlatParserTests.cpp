@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/FlatParser.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Analysis/Driver.h"
+
+#include <string>
+
+using namespace efd;
+
+static QModule::uRef ParseFlat(const std::string& program) {
+    return ParseFlatProgram(program.data(), program.data() + program.size());
+}
+
+static void CheckSameAsFullParser(const std::string& program) {
+    auto flat = ParseFlat(program);
+    ASSERT_FALSE(flat.get() == nullptr) << program;
+
+    auto full = QModule::GetFromAST(efd::ParseString(program));
+    ASSERT_FALSE(full.get() == nullptr) << program;
+
+    ASSERT_EQ(full->toString(false, true), flat->toString(false, true));
+    ASSERT_EQ(full->getNumberOfStmts(), flat->getNumberOfStmts());
+}
+
+TEST(FlatParserTests, SameAsFullParser) {
+    CheckSameAsFullParser("");
+    CheckSameAsFullParser("OPENQASM 2.0;");
+
+    CheckSameAsFullParser(
+"\
+OPENQASM 2.0;\n\
+include \"qelib1.inc\";\n\
+// Comment.\n\
+qreg q[5];\n\
+creg c[5];\n\
+cx q[0], q[1]; // Trailing comment.\n\
+CX q[1],q[2];\n\
+U(pi, 0, pi) q[3];\n\
+u1(-pi / 2) q[0];\n\
+u2(0, pi) q[1];\n\
+u3(2 * -3, 1.5e-3 + 2 ^ 2 ^ 3, sin(pi) - sqrt(2) * 0.5) q[2];\n\
+h q[4];\n\
+barrier q[0], q[1], q[2];\n\
+reset q[3];\n\
+measure q[0] -> c[0];\n\
+");
+
+    CheckSameAsFullParser(
+"\
+qreg q[2];\n\
+u1(-(pi - 1) / -2 ^ 2) q[0];\n\
+u1(((pi))) q[1];\n\
+u3(-pi + 1, -pi - -1, 2 * -3 * 4) q[0];\n\
+u2(2 ^ -3 ^ 4, -ln(2) / exp(1) - tan(.5)) q[1];\n\
+U() q[0];\n\
+");
+}
+
+TEST(FlatParserTests, FallsBackOutsideTheSubset) {
+    const std::vector<std::string> programs = {
+        // Gate declarations.
+        "qreg q[2]; gate mygate a, b { cx a, b; } mygate q[0], q[1];",
+        "qreg q[2]; opaque mygate a, b;",
+        // Conditional statements.
+        "qreg q[2]; creg c[2]; if (c == 1) cx q[0], q[1];",
+        // Whole registers as operands.
+        "qreg q[2]; qreg r[2]; cx q, r;",
+        "qreg q[2]; creg c[2]; measure q -> c;",
+        // Calls to gates that were not declared.
+        "qreg q[2]; mygate q[0], q[1];",
+        // Includes of files other than the standard library.
+        "include \"other.inc\"; qreg q[2];",
+        // Syntax errors.
+        "qreg q[2]; cx q[0], q[1]",
+        "qreg q[2]; cx q[0] q[1];",
+        "qreg q[007];"
+    };
+
+    for (auto& program : programs) {
+        ASSERT_TRUE(ParseFlat(program).get() == nullptr) << program;
+    }
+}
+
+TEST(FlatParserTests, QModuleParseStringFallsBack) {
+    const std::string program =
+"\
+qreg q[2];\
+gate mygate a, b { cx a, b; }\
+mygate q[0], q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    ASSERT_FALSE(qmod.get() == nullptr);
+    ASSERT_FALSE(qmod->getQGate("mygate") == nullptr);
+    ASSERT_EQ(1u, qmod->getNumberOfStmts());
+}
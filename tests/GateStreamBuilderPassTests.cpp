@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "enfield/Transform/GateStreamBuilderPass.h"
+
+using namespace efd;
+
+typedef GateStream::Kind Kind;
+
+static std::vector<uint32_t> ToVector(GateStream::IdSlice slice) {
+    return std::vector<uint32_t>(slice.begin(), slice.end());
+}
+
+TEST(GateStreamBuilderPassTests, OperandsAreResolved) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+qreg r[2];\
+creg c[2];\
+CX q[0], r[1];\
+U(pi, 0, pi/2) q[2];\
+h r[0];\
+measure q[1] -> c[1];\
+if (c == 2) cx r[0], q[2];\
+barrier q[0], r[0];\
+reset q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto pass = GateStreamBuilderPass::Create();
+    pass->run(qmod.get());
+    auto& stream = pass->getData();
+
+    ASSERT_EQ(stream.size(), 7u);
+    ASSERT_EQ(stream.getQSize(), 5u);
+    ASSERT_EQ(stream.getCSize(), 2u);
+    ASSERT_TRUE(stream.isFlat());
+
+    std::vector<Kind> kinds {
+        Kind::CX, Kind::U, Kind::GEN, Kind::MEASURE, Kind::GEN, Kind::BARRIER, Kind::RESET
+    };
+
+    std::vector<std::vector<uint32_t>> qargs {
+        { 0, 4 }, { 2 }, { 3 }, { 1 }, { 3, 2 }, { 0, 3 }, { 1 }
+    };
+
+    std::vector<std::vector<uint32_t>> cargs {
+        {}, {}, {}, { 1 }, { 0, 1 }, {}, {}
+    };
+
+    for (uint32_t i = 0; i < stream.size(); ++i) {
+        EXPECT_TRUE(stream.getKind(i) == kinds[i]);
+        EXPECT_EQ(ToVector(stream.getQArgs(i)), qargs[i]);
+        EXPECT_EQ(ToVector(stream.getCArgs(i)), cargs[i]);
+        EXPECT_EQ(stream.getGateId(stream.getNode(i)), i);
+        EXPECT_EQ(stream.getNode(i), qmod->getStatement(i));
+    }
+
+    EXPECT_EQ(stream.getGateName(2), "h");
+    EXPECT_EQ(stream.getArgs(1).size(), 3u);
+    EXPECT_TRUE(stream.isConditional(4));
+    EXPECT_FALSE(stream.isConditional(3));
+    EXPECT_EQ(stream.getCondRegName(4), "c");
+    EXPECT_EQ(stream.getCondVal(4), 2);
+    EXPECT_EQ(stream.getXbits(4), std::vector<uint32_t>({ 3, 2, 5, 6 }));
+}
+
+TEST(GateStreamBuilderPassTests, LoweringIsEquivalent) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+cx q[0], q[1];\
+U(pi, 0, pi/2) q[2];\
+u1(pi/4) q[1];\
+measure q[1] -> c[1];\
+if (c == 2) cx q[1], q[2];\
+barrier q[0], q[2];\
+reset q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto pass = GateStreamBuilderPass::Create();
+    pass->run(qmod.get());
+    auto& stream = pass->getData();
+
+    auto stmts = stream.lower();
+    ASSERT_EQ(stmts.size(), qmod->getNumberOfStmts());
+
+    for (uint32_t i = 0; i < stmts.size(); ++i) {
+        EXPECT_EQ(stmts[i]->toString(false), qmod->getStatement(i)->toString(false));
+    }
+}
+
+TEST(GateStreamBuilderPassTests, IntrinsicGates) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+qreg q[3];\
+intrinsic_swap__ q[0], q[1];\
+intrinsic_rev_cx__ q[1], q[2];\
+intrinsic_lcx__ q[0], q[1], q[2];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto pass = GateStreamBuilderPass::Create();
+    pass->run(qmod.get());
+    auto& stream = pass->getData();
+
+    ASSERT_EQ(stream.size(), 3u);
+    EXPECT_TRUE(stream.getKind(0) == Kind::INTRINSIC_SWAP);
+    EXPECT_TRUE(stream.getKind(1) == Kind::INTRINSIC_REV_CX);
+    EXPECT_TRUE(stream.getKind(2) == Kind::INTRINSIC_LCX);
+    EXPECT_EQ(ToVector(stream.getQArgs(2)), std::vector<uint32_t>({ 0, 1, 2 }));
+
+    for (uint32_t i = 0; i < stream.size(); ++i) {
+        EXPECT_EQ(stream.lower(i)->toString(false), qmod->getStatement(i)->toString(false));
+    }
+}
+
+TEST(GateStreamBuilderPassTests, RegisterOperandsAreExpanded) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+qreg q[3];\
+creg c[3];\
+measure q -> c;\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto pass = GateStreamBuilderPass::Create();
+    pass->run(qmod.get());
+    auto& stream = pass->getData();
+
+    ASSERT_EQ(stream.size(), 1u);
+    EXPECT_FALSE(stream.isFlat());
+    EXPECT_EQ(ToVector(stream.getQArgs(0)), std::vector<uint32_t>({ 0, 1, 2 }));
+    EXPECT_EQ(ToVector(stream.getCArgs(0)), std::vector<uint32_t>({ 0, 1, 2 }));
+}
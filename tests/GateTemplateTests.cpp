@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/GateTemplate.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Support/RTTI.h"
+
+#include <string>
+
+using namespace efd;
+
+static std::string ToString(const std::vector<Node::uRef>& stmts) {
+    std::string str;
+    for (auto& stmt : stmts) str += stmt->toString(false);
+    return str;
+}
+
+static GateTemplate::uRef CreateGateTemplate(QModule::Ref qmod, const std::string& name) {
+    auto gate = dynCast<NDGateDecl>(qmod->getQGate(name));
+
+    std::vector<Node::uRef> body;
+    for (auto& op : *gate->getGOpList()) body.push_back(op->clone());
+
+    return GateTemplate::Create(gate, std::move(body));
+}
+
+TEST(GateTemplateTests, GateBody) {
+    const std::string program =
+"\
+qreg q[5];\
+gate mygate(theta, phi) a, b {\
+    U(theta, (phi / 2), -theta) a;\
+    CX a, b;\
+    u1(sin(phi)) b;\
+}\
+mygate(pi, 0.5) q[0], q[3];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto tmpl = CreateGateTemplate(qmod.get(), "mygate");
+
+    ASSERT_EQ(4u, tmpl->getNumberOfSlots());
+    ASSERT_EQ(3u, tmpl->getNumberOfStmts());
+
+    auto call = dynCast<NDQOp>(qmod->stmt_begin()->get());
+
+    // Each expansion is independent of the others.
+    for (uint32_t i = 0; i < 2; ++i) {
+        std::vector<Node::uRef> stmts;
+        tmpl->expand(call, stmts);
+
+        ASSERT_EQ("U(pi, (0.5 / 2), (-pi)) q[0];CX q[0], q[3];u1(sin(0.5)) q[3];",
+                  ToString(stmts));
+    }
+}
+
+TEST(GateTemplateTests, ParameterHidesQArg) {
+    const std::string program =
+"\
+qreg q[5];\
+gate mygate(a) a, b {\
+    u1(a) b;\
+}\
+mygate(pi) q[0], q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto tmpl = CreateGateTemplate(qmod.get(), "mygate");
+
+    std::vector<Node::uRef> stmts;
+    tmpl->expand(dynCast<NDQOp>(qmod->stmt_begin()->get()), stmts);
+    ASSERT_EQ("u1(pi) q[1];", ToString(stmts));
+}
+
+TEST(GateTemplateTests, ConditionalCall) {
+    const std::string program =
+"\
+qreg q[5];\
+creg c[5];\
+gate mygate a, b {\
+    CX a, b;\
+    CX b, a;\
+}\
+if (c == 2) mygate q[0], q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto tmpl = CreateGateTemplate(qmod.get(), "mygate");
+
+    auto ifstmt = dynCast<NDIfStmt>(qmod->stmt_begin()->get());
+    ASSERT_FALSE(ifstmt == nullptr);
+
+    std::vector<Node::uRef> stmts;
+    tmpl->expand(ifstmt->getQOp(), stmts, ifstmt);
+    ASSERT_EQ("if (c == 2) CX q[0], q[1];if (c == 2) CX q[1], q[0];", ToString(stmts));
+}
+
+TEST(GateTemplateTests, StatementHoles) {
+    auto measure = NDQOpMeasure::Create(NDId::Create("q"), NDId::Create("c"));
+    auto tmpl = GateTemplate::Create(measure.get(), { measure->getCBit(), measure->getQBit() });
+
+    ASSERT_EQ(2u, tmpl->getNumberOfSlots());
+    ASSERT_EQ(1u, tmpl->getNumberOfStmts());
+
+    auto cbit = NDIdRef::Create(NDId::Create("c"), NDInt::Create(std::string("1")));
+    auto qbit = NDIdRef::Create(NDId::Create("q"), NDInt::Create(std::string("2")));
+
+    std::vector<Node::uRef> stmts;
+    tmpl->expand({ cbit.get(), qbit.get() }, stmts);
+    ASSERT_EQ("measure q[2] -> c[1];", ToString(stmts));
+}
@@ -205,3 +205,36 @@ measure q[3] -> c[3];\
                 });
     }
 }
+
+TEST(LayersBuilderPassTests, LayersStorage) {
+    auto a = reinterpret_cast<Node::Ref>(1);
+    auto b = reinterpret_cast<Node::Ref>(2);
+    auto c = reinterpret_cast<Node::Ref>(3);
+    auto d = reinterpret_cast<Node::Ref>(4);
+
+    Layers empty;
+    ASSERT_TRUE(empty.empty());
+    ASSERT_TRUE(empty.begin() == empty.end());
+
+    // Nodes keep their relative order inside each layer.
+    Layers layers({ a, b, c, d }, { 1, 0, 1, 0 });
+    ASSERT_EQ(2u, layers.size());
+    ASSERT_EQ(4u, layers.getNumberOfNodes());
+    ASSERT_EQ(std::vector<Node::Ref>({ b, d }),
+              std::vector<Node::Ref>(layers[0].begin(), layers[0].end()));
+    ASSERT_EQ(std::vector<Node::Ref>({ a, c }),
+              std::vector<Node::Ref>(layers[1].begin(), layers[1].end()));
+
+    layers.append({ d });
+    ASSERT_EQ(3u, layers.size());
+
+    uint32_t i = 0;
+    for (auto layer : layers) {
+        ASSERT_EQ(layers[i].size(), layer.size());
+        ++i;
+    }
+
+    ASSERT_EQ(3u, i);
+    ASSERT_EQ(d, layers[2][0]);
+    ASSERT_DEATH({ layers[3]; }, "");
+}
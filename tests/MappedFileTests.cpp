@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/MappedFile.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace efd;
+
+static std::string CreateTmpFile(const std::string& contents) {
+    char path[] = "/tmp/efd-mapped-XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    close(fd);
+
+    std::ofstream out(path, std::ios::binary);
+    out << contents;
+    return path;
+}
+
+TEST(MappedFileTests, MapsTheWholeFile) {
+    std::string contents = "qreg q[5];\ncx q[0], q[1];\n";
+    auto path = CreateTmpFile(contents);
+
+    auto mapped = MappedFile::Open(path);
+    ASSERT_TRUE(mapped.get() != nullptr);
+    EXPECT_EQ(mapped->size(), contents.size());
+    EXPECT_EQ(std::string(mapped->begin(), mapped->end()), contents);
+
+    unlink(path.c_str());
+}
+
+TEST(MappedFileTests, EmptyAndMissingFiles) {
+    auto path = CreateTmpFile("");
+
+    auto mapped = MappedFile::Open(path);
+    ASSERT_TRUE(mapped.get() != nullptr);
+    EXPECT_EQ(mapped->size(), 0u);
+    EXPECT_EQ(mapped->begin(), mapped->end());
+
+    unlink(path.c_str());
+
+    EXPECT_TRUE(MappedFile::Open(path).get() == nullptr);
+    EXPECT_EQ(errno, ENOENT);
+}
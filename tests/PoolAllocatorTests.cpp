@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/PoolAllocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace efd;
+
+TEST(PoolAllocatorTests, FreedChunksAreReused) {
+    void* first = PoolAllocator::Allocate(40);
+    PoolAllocator::Deallocate(first, 40);
+
+    // Same size class.
+    void* second = PoolAllocator::Allocate(48);
+    EXPECT_EQ(first, second);
+    PoolAllocator::Deallocate(second, 48);
+}
+
+TEST(PoolAllocatorTests, ChunksDoNotOverlap) {
+    std::vector<std::pair<char*, std::size_t>> chunks;
+
+    for (std::size_t i = 0; i < 4096; ++i) {
+        std::size_t size = 1 + (i * 7) % PoolAllocator::MaxObjectSize;
+        auto ptr = static_cast<char*>(PoolAllocator::Allocate(size));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+        std::memset(ptr, (int) (i % 256), size);
+        chunks.push_back(std::make_pair(ptr, size));
+    }
+
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        auto ptr = chunks[i].first;
+        for (std::size_t j = 0; j < chunks[i].second; ++j) {
+            ASSERT_EQ((unsigned char) ptr[j], i % 256);
+        }
+    }
+
+    for (auto& chunk : chunks) {
+        PoolAllocator::Deallocate(chunk.first, chunk.second);
+    }
+
+    EXPECT_GT(PoolAllocator::GetReservedBytes(), 0u);
+}
+
+TEST(PoolAllocatorTests, BigObjectsGoToTheSystem) {
+    std::size_t size = PoolAllocator::MaxObjectSize + 1;
+    auto reserved = PoolAllocator::GetReservedBytes();
+
+    void* ptr = PoolAllocator::Allocate(size);
+    std::memset(ptr, 0, size);
+    PoolAllocator::Deallocate(ptr, size);
+
+    EXPECT_EQ(PoolAllocator::GetReservedBytes(), reserved);
+}
+
+TEST(PoolAllocatorTests, ExitedThreadsGiveTheirMemoryBack) {
+    auto work = [] {
+        std::vector<void*> chunks;
+        for (uint32_t i = 0; i < 1000; ++i) chunks.push_back(PoolAllocator::Allocate(64));
+        for (auto ptr : chunks) PoolAllocator::Deallocate(ptr, 64);
+    };
+
+    std::thread(work).join();
+    auto reserved = PoolAllocator::GetReservedBytes();
+
+    for (uint32_t i = 0; i < 20; ++i) {
+        std::thread(work).join();
+    }
+
+    EXPECT_EQ(PoolAllocator::GetReservedBytes(), reserved);
+}
@@ -0,0 +1,181 @@
+
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Transform/Allocators/PortfolioQAllocator.h"
+#include "enfield/Transform/QModuleQualityEvalPass.h"
+#include "enfield/Transform/InlineAllPass.h"
+#include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/SemanticVerifierPass.h"
+#include "enfield/Transform/ArchVerifierPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/Stats.h"
+
+#include <string>
+
+using namespace efd;
+
+static ArchGraph::sRef createGraph() {
+    const std::string gStr =
+"{\n\
+    \"qubits\": 5,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 5} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"q[1]\"}, {\"v\": \"q[2]\"} ],\n\
+        [ {\"v\": \"q[2]\"} ],\n\
+        [],\n\
+        [ {\"v\": \"q[2]\"}, {\"v\": \"q[4]\"} ],\n\
+        [ {\"v\": \"q[2]\"} ]\n\
+    ]\n\
+}";
+
+    return JsonParser<ArchGraph>::ParseString(gStr);
+}
+
+static const std::string Program =
+"\
+qreg q[5];\
+gate test a, b, c {CX a, b;CX a, c;CX b, c;}\
+test q[0], q[1], q[2];\
+test q[4], q[1], q[0];\
+CX q[3], q[0];\
+CX q[1], q[4];\
+";
+
+static uint32_t WeightedCost(QModule::Ref qmod) {
+    GateWeightMap weights { {"U", 1}, {"CX", 10} };
+    auto inlinePass = InlineAllPass::Create(ExtractGateNames(weights));
+    auto qualityPass = QModuleQualityEvalPass::Create(weights);
+    PassCache::Run(qmod, inlinePass.get());
+    PassCache::Run(qmod, qualityPass.get());
+    return qualityPass->getData().mWeightedCost;
+}
+
+static QModule::uRef Allocate(const std::string& name,
+                              const AllocatorOptions& options,
+                              ArchGraph::sRef g,
+                              Mapping& mapping) {
+    auto qmod = QModule::ParseString(Program);
+    auto allocator = CreateQbitAllocator(EnumAllocator(name), g);
+    allocator->setOptions(options);
+    allocator->run(qmod.get());
+    mapping = allocator->getData();
+
+    auto reverse = ReverseEdgesPass::Create(g);
+    reverse->run(qmod.get());
+    return qmod;
+}
+
+TEST(PortfolioQAllocatorTests, KeepsTheCheapestResult) {
+    InitializeAllQbitAllocators();
+    auto g = createGraph();
+
+    AllocatorOptions options;
+    options.seed = 7;
+    options.portfolio = { "Q_sabre", "Q_jku", "Q_bmt" };
+    // Never cancels.
+    options.portfolioThreshold = 0.0;
+
+    Mapping mapping;
+    auto qmod = Allocate("Q_portfolio", options, g, mapping);
+    auto qmodCopy = QModule::ParseString(Program);
+    auto cost = WeightedCost(qmod->clone().get());
+
+    auto aVerifierPass = ArchVerifierPass::Create(g);
+    PassCache::Run(qmod.get(), aVerifierPass.get());
+    EXPECT_TRUE(aVerifierPass->getData());
+
+    auto sVerifierPass = SemanticVerifierPass::Create(std::move(qmodCopy), mapping);
+    sVerifierPass->setInlineAll({ "cx" });
+    PassCache::Run(qmod.get(), sVerifierPass.get());
+    EXPECT_TRUE(sVerifierPass->getData().isSuccess());
+
+    for (auto& name : options.portfolio) {
+        Mapping m;
+        auto single = Allocate(name, options, g, m);
+        EXPECT_LE(cost, WeightedCost(single.get())) << name;
+    }
+}
+
+TEST(PortfolioQAllocatorTests, StopsOnceGoodEnough) {
+    InitializeAllQbitAllocators();
+    auto g = createGraph();
+
+    AllocatorOptions options;
+    options.portfolio = { "Q_sabre", "Q_sabre", "Q_jku" };
+    options.sabreIterations = 1000;
+    // Any result is good enough, so the other candidates are cancelled.
+    options.portfolioThreshold = 1000.0;
+    options.portfolioDeadline = 10000;
+
+    Mapping mapping;
+    auto qmod = Allocate("Q_portfolio", options, g, mapping);
+
+    auto aVerifierPass = ArchVerifierPass::Create(g);
+    PassCache::Run(qmod.get(), aVerifierPass.get());
+    EXPECT_TRUE(aVerifierPass->getData());
+}
+
+TEST(PortfolioQAllocatorTests, CancelledAllocatorsStillFinish) {
+    InitializeAllQbitAllocators();
+    auto g = createGraph();
+
+    for (auto name : { "Q_jku", "Q_bmt", "Q_opt_bmt", "Q_layered_bmt" }) {
+        auto qmod = QModule::ParseString(Program);
+        auto allocator = CreateQbitAllocator(EnumAllocator(name), g);
+        allocator->cancel();
+        allocator->run(qmod.get());
+
+        auto reverse = ReverseEdgesPass::Create(g);
+        reverse->run(qmod.get());
+
+        auto aVerifierPass = ArchVerifierPass::Create(g);
+        PassCache::Run(qmod.get(), aVerifierPass.get());
+        EXPECT_TRUE(aVerifierPass->getData()) << name;
+
+        auto sVerifierPass = SemanticVerifierPass::Create(QModule::ParseString(Program),
+                                                          allocator->getData());
+        sVerifierPass->setInlineAll({ "cx" });
+        PassCache::Run(qmod.get(), sVerifierPass.get());
+        EXPECT_TRUE(sVerifierPass->getData().isSuccess()) << name;
+    }
+}
+
+static std::string GetStat(const StatRecords& records, const std::string& name) {
+    for (auto& record : records) {
+        if (record.mName == name) return record.mValue;
+    }
+
+    return "";
+}
+
+TEST(PortfolioQAllocatorTests, ReportsTheWinnerStatsOnly) {
+    InitializeAllQbitAllocators();
+    auto g = createGraph();
+
+    AllocatorOptions options;
+    options.portfolio = { "Q_jku", "Q_jku" };
+    options.portfolioThreshold = 0.0;
+
+    std::string single, portfolio;
+
+    {
+        StatScope scope;
+        StatScope::Binding binding(&scope);
+        Mapping mapping;
+        Allocate("Q_jku", options, g, mapping);
+        single = GetStat(CollectStats(), "JKUNodesExpanded");
+    }
+
+    {
+        StatScope scope;
+        StatScope::Binding binding(&scope);
+        Mapping mapping;
+        Allocate("Q_portfolio", options, g, mapping);
+        portfolio = GetStat(CollectStats(), "JKUNodesExpanded");
+    }
+
+    ASSERT_NE(single, "");
+    EXPECT_EQ(single, portfolio);
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Analysis/Driver.h"
+#include "enfield/Analysis/QASMEmitter.h"
+
+#include <sstream>
+#include <string>
+
+using namespace efd;
+
+static const std::string dir = "files/";
+static const std::vector<std::string> files = {
+    "adder.qasm",
+    "bigadder.qasm",
+    "inverseqft1.qasm",
+    "qec.qasm",
+    "qelib1.inc",
+    "qpt.qasm",
+    "rb.qasm",
+    "teleport.qasm"
+};
+
+static std::string Emit(Node::Ref ref, bool pretty, uint32_t times = 1) {
+    std::ostringstream out;
+    QASMEmitter emitter(out, pretty);
+
+    for (uint32_t i = 0; i < times; ++i) {
+        emitter.emit(ref);
+    }
+
+    emitter.flush();
+    return out.str();
+}
+
+TEST(QASMEmitterTests, SameAsToString) {
+    for (const std::string& file : files) {
+        auto root = efd::ParseFile(file, dir);
+        ASSERT_FALSE(root == nullptr);
+
+        EXPECT_EQ(Emit(root.get(), false), root->toString(false));
+        EXPECT_EQ(Emit(root.get(), true), root->toString(true));
+    }
+}
+
+TEST(QASMEmitterTests, ExpressionsAndConditionals) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+qreg q[2];\
+creg c[2];\
+opaque ogate(x, y) a, b;\
+gate g(x) a, b { U(-x, sin(x / 2), x ^ 2) a; CX a, b; barrier a, b; }\
+g(-pi + 3.5e-2 * ln(2)) q[0], q[1];\
+if (c == 3) g(sqrt(2)) q[1], q[0];\
+measure q -> c;\
+reset q[1];\
+";
+
+    auto root = efd::ParseString(program);
+    ASSERT_FALSE(root == nullptr);
+
+    EXPECT_EQ(Emit(root.get(), false), root->toString(false));
+    EXPECT_EQ(Emit(root.get(), true), root->toString(true));
+}
+
+TEST(QASMEmitterTests, LargeOutputIsFlushed) {
+    auto root = efd::ParseFile("bigadder.qasm", dir);
+    ASSERT_FALSE(root == nullptr);
+
+    auto str = root->toString(true);
+    uint32_t times = QASMEmitter::BufferSize / str.size() + 2;
+
+    std::string expected;
+    for (uint32_t i = 0; i < times; ++i) expected += str;
+
+    EXPECT_EQ(Emit(root.get(), true, times), expected);
+}
@@ -7,6 +7,7 @@
 #include "enfield/Support/RTTI.h"
 
 #include <string>
+#include <thread>
 
 using namespace efd;
 
@@ -55,8 +56,9 @@ namespace {
                     (*it)->apply(this);
                 }
 
+                // Shared gates are not cloned (see `SharesLibraryGates`).
                 for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
-                    (*it)->apply(this);
+                    if (!qmod->isSharedGate(*it)) (*it)->apply(this);
                 }
 
                 for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
@@ -118,3 +120,89 @@ reset q0[0];\
 barrier q0, q1;\
 notid(pi + 3 / 8) q0[0], q[1];\
 ");
+
+TEST(QModuleSharedCloneTests, StatementsAreShared) {
+    const std::string program = "qreg q[2]; CX q[0], q[1]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+    auto clone = qmod->cloneShared();
+
+    ASSERT_EQ(qmod->toString(), clone->toString());
+    ASSERT_TRUE(qmod->hasSharedStatements());
+    ASSERT_TRUE(clone->hasSharedStatements());
+
+    for (uint32_t i = 0, e = qmod->getNumberOfStmts(); i < e; ++i)
+        ASSERT_EQ(qmod->getStatement(i), clone->getStatement(i));
+
+    clone.reset();
+    ASSERT_FALSE(qmod->hasSharedStatements());
+}
+
+TEST(QModuleSharedCloneTests, ModifiedModuleKeepsItsNodes) {
+    const std::string program = "qreg q[2]; CX q[0], q[1]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+    auto clone = qmod->cloneShared();
+
+    auto first = qmod->getStatement(0);
+    auto last = qmod->getStatement(1);
+    qmod->removeStatement(qmod->findStatement(first));
+
+    ASSERT_FALSE(qmod->hasSharedStatements());
+    ASSERT_FALSE(clone->hasSharedStatements());
+    ASSERT_EQ(qmod->getNumberOfStmts(), 1u);
+    ASSERT_EQ(qmod->getStatement(0), last);
+
+    ASSERT_EQ(clone->getNumberOfStmts(), 2u);
+    ASSERT_EQ(clone->getStatement(0)->toString(), "CX q[0], q[1];");
+    ASSERT_FALSE(clone->getStatement(1) == last);
+    ASSERT_EQ(clone->getStatement(1)->toString(), last->toString());
+}
+
+TEST(QModuleSharedCloneTests, ClearDoesNotAffectClone) {
+    const std::string program = "qreg q[2]; CX q[0], q[1]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+    auto clone = qmod->cloneShared();
+    auto first = qmod->getStatement(0);
+
+    qmod->clearStatements();
+    qmod->insertStatementLast(first->clone());
+
+    ASSERT_EQ(qmod->getNumberOfStmts(), 1u);
+    ASSERT_EQ(clone->getNumberOfStmts(), 2u);
+    ASSERT_EQ(clone->getStatement(0), first);
+}
+
+TEST(QModuleSharedCloneTests, ClonesMayBeDetachedConcurrently) {
+    const std::string program = "qreg q[2]; CX q[0], q[1]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+
+    std::vector<QModule::uRef> clones;
+    for (uint32_t i = 0; i < 16; ++i) clones.push_back(qmod->cloneShared());
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < clones.size(); ++i) {
+        threads.push_back(std::thread([&clones, i] {
+            if (i % 2 == 0) clones[i]->detachStatements();
+            clones[i].reset();
+        }));
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    ASSERT_FALSE(qmod->hasSharedStatements());
+    ASSERT_EQ(qmod->getNumberOfStmts(), 2u);
+}
+
+TEST(NodeCloneTests, SharesLibraryGates) {
+    auto qmod = QModule::ParseString("include \"qelib1.inc\"; gate notid a {} qreg q[1]; h q[0];");
+    auto clone = qmod->clone();
+    auto other = QModule::ParseString("qreg q[1];");
+
+    ASSERT_TRUE(qmod->isSharedGate(qmod->getQGate("h")));
+    ASSERT_FALSE(qmod->isSharedGate(qmod->getQGate("notid")));
+
+    // Parsed only once, for every module.
+    EXPECT_EQ(qmod->getQGate("h"), clone->getQGate("h"));
+    EXPECT_EQ(qmod->getQGate("h"), other->getQGate("h"));
+    EXPECT_EQ(qmod->getQGate("intrinsic_swap__"), other->getQGate("intrinsic_swap__"));
+    EXPECT_NE(qmod->getQGate("notid"), clone->getQGate("notid"));
+}
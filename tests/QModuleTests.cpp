@@ -32,3 +32,73 @@ TEST(QModuleTests, TransformationTest) {
         ASSERT_FALSE(qmod.get() == nullptr);
     }
 }
+
+TEST(QModuleTests, FindAfterModificationTest) {
+    const std::string program = "qreg q[3]; CX q[0], q[1]; CX q[1], q[2]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+
+    auto first = qmod->getStatement(0);
+    auto last = qmod->getStatement(2);
+    ASSERT_EQ(qmod->findStatement(last), qmod->stmt_begin() + 2);
+
+    qmod->insertStatementFront(first->clone());
+    ASSERT_EQ(qmod->findStatement(last), qmod->stmt_begin() + 3);
+
+    auto appended = qmod->insertStatementLast(last->clone())->get();
+    ASSERT_EQ(qmod->findStatement(appended), qmod->stmt_begin() + 4);
+
+    qmod->removeStatement(qmod->findStatement(first));
+    ASSERT_EQ(qmod->findStatement(last), qmod->stmt_begin() + 2);
+}
+
+TEST(QModuleTests, FindAfterManyModificationsTest) {
+    const std::string program = "qreg q[2]; CX q[0], q[1]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+    auto cx = qmod->getStatement(0);
+    auto u = qmod->getStatement(1);
+
+    // More edits than the index logs before being rebuilt.
+    for (uint32_t i = 0; i < 200; ++i) {
+        std::vector<Node::uRef> stmts;
+        stmts.push_back(cx->clone());
+        stmts.push_back(u->clone());
+
+        auto it = qmod->replaceStatement(u, std::move(stmts));
+        u = (it + 1)->get();
+        if (i % 3 == 0) qmod->insertStatementFront(cx->clone());
+        if (i % 5 == 0) qmod->removeStatement(qmod->findStatement(cx));
+        cx = qmod->getStatement(0);
+
+        ASSERT_EQ(qmod->findStatement(u)->get(), u);
+        ASSERT_EQ(qmod->findStatement(cx), qmod->stmt_begin());
+    }
+
+    for (uint32_t i = 0, e = qmod->getNumberOfStmts(); i < e; ++i) {
+        auto stmt = qmod->getStatement(i);
+        ASSERT_EQ(qmod->findStatement(stmt), qmod->stmt_begin() + i);
+    }
+}
+
+TEST(QModuleTests, ReplaceStatementsTest) {
+    const std::string program = "qreg q[3]; CX q[0], q[1]; CX q[1], q[2]; U(pi) q[0];";
+    auto qmod = QModule::ParseString(program);
+
+    auto first = qmod->getStatement(0);
+    auto second = qmod->getStatement(1);
+    auto last = qmod->getStatement(2);
+
+    QModule::ReplacementMap repMap;
+    repMap[first].push_back(second->clone());
+    repMap[first].push_back(last->clone());
+    repMap[second];
+
+    qmod->replaceStatements(std::move(repMap));
+
+    ASSERT_EQ(qmod->getNumberOfStmts(), 3u);
+    ASSERT_EQ(qmod->toString(),
+              "include \"qelib1.inc\";qreg q[3];CX q[1], q[2];U(pi) q[0];U(pi) q[0];");
+    ASSERT_EQ(qmod->findStatement(last), qmod->stmt_begin() + 2);
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it)
+        ASSERT_EQ((*it)->getParent(), qmod->getStatement(0)->getParent());
+}
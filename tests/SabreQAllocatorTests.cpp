@@ -120,3 +120,60 @@ test q[4], q[1], q[0];\
         TestAllocation(program);
     }
 }
+
+TEST(SabreQAllocatorTests, OptionsAreUsedPerAllocator) {
+    ArchGraph::sRef g = createGraph();
+    const std::string program =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+CX q[1], q[2];\
+CX q[2], q[3];\
+CX q[3], q[4];\
+CX q[0], q[4];\
+CX q[1], q[3];\
+";
+
+    AllocatorOptions options;
+    options.seed = 42;
+    options.sabreIterations = 2;
+    options.sabreLookAhead = 3;
+
+    std::vector<std::string> outputs;
+    std::vector<Mapping> mappings;
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        auto qmod = QModule::ParseString(program);
+        auto allocator = SabreQAllocator::Create(g);
+        allocator->setOptions(options);
+        allocator->run(qmod.get());
+
+        outputs.push_back(qmod->toString());
+        mappings.push_back(allocator->getData());
+    }
+
+    EXPECT_EQ(outputs[0], outputs[1]);
+    EXPECT_EQ(mappings[0], mappings[1]);
+
+    // Two allocators with different options, interleaved in the same
+    // process, must not see each other's options.
+    AllocatorOptions otherOptions = options;
+    otherOptions.seed = 1;
+    otherOptions.sabreIterations = 1;
+
+    auto first = SabreQAllocator::Create(g);
+    auto second = SabreQAllocator::Create(g);
+    first->setOptions(options);
+    second->setOptions(otherOptions);
+
+    auto secondQMod = QModule::ParseString(program);
+    second->run(secondQMod.get());
+
+    auto firstQMod = QModule::ParseString(program);
+    first->run(firstQMod.get());
+
+    EXPECT_NE(second->getData(), mappings[0]);
+    EXPECT_NE(secondQMod->toString(), outputs[0]);
+    EXPECT_EQ(first->getData(), mappings[0]);
+    EXPECT_EQ(firstQMod->toString(), outputs[0]);
+}
@@ -985,3 +985,66 @@ measure q[4] -> c[4];\
         EXPECT_TRUE(areSemanticalyEqual);
     }
 }
+
+TEST(SemanticVerifierPassTests, BrokenSingleQubitGatesTest) {
+    const std::string progBefore =
+"\
+qreg q[2];\
+creg c[2];\
+U(pi, 0, pi) q[0];\
+measure q[0] -> c[0];\
+if (c == 1) U(0, 0, pi) q[1];\
+";
+
+    {
+        const std::string progAfter =
+"\
+qreg q[2];\
+creg c[2];\
+U(pi, 0, pi) q[1];\
+measure q[1] -> c[0];\
+if (c == 1) U(0, 0, pi) q[0];\
+";
+
+        EXPECT_TRUE(CheckSemanticVerifier(progBefore, progAfter, { 1, 0 }));
+    }
+    {
+        // Other arguments.
+        const std::string progAfter =
+"\
+qreg q[2];\
+creg c[2];\
+U(0, 0, pi) q[1];\
+measure q[1] -> c[0];\
+if (c == 1) U(0, 0, pi) q[0];\
+";
+
+        EXPECT_FALSE(CheckSemanticVerifier(progBefore, progAfter, { 1, 0 }));
+    }
+    {
+        // Other classical bit.
+        const std::string progAfter =
+"\
+qreg q[2];\
+creg c[2];\
+U(pi, 0, pi) q[1];\
+measure q[1] -> c[1];\
+if (c == 1) U(0, 0, pi) q[0];\
+";
+
+        EXPECT_FALSE(CheckSemanticVerifier(progBefore, progAfter, { 1, 0 }));
+    }
+    {
+        // Other condition.
+        const std::string progAfter =
+"\
+qreg q[2];\
+creg c[2];\
+U(pi, 0, pi) q[1];\
+measure q[1] -> c[0];\
+if (c == 2) U(0, 0, pi) q[0];\
+";
+
+        EXPECT_FALSE(CheckSemanticVerifier(progBefore, progAfter, { 1, 0 }));
+    }
+}
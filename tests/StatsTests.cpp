@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/Stats.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace efd;
+
+static Stat<uint32_t> Counter
+("StatsTestsCounter", "Counter used by the stats tests.");
+static Stat<double> Ratio
+("StatsTestsRatio", "Ratio used by the stats tests.");
+
+static std::string FindValue(const StatRecords& records, const std::string& name) {
+    for (auto& record : records) {
+        if (record.mName == name) return record.mValue;
+    }
+
+    return "";
+}
+
+TEST(StatsTests, ConcurrentUpdatesAreNotLost) {
+    Counter = 0;
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 8; ++i) {
+        threads.push_back(std::thread([]() {
+            for (uint32_t j = 0; j < 1000; ++j) Counter += 1;
+        }));
+    }
+
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(Counter.getVal(), 8000u);
+}
+
+TEST(StatsTests, ScopesAreIsolated) {
+    Counter = 5;
+
+    StatScope first, second;
+
+    std::thread t1([&first]() {
+        StatScope::Binding binding(&first);
+        for (uint32_t j = 0; j < 100; ++j) Counter += 1;
+    });
+
+    std::thread t2([&second]() {
+        StatScope::Binding binding(&second);
+        for (uint32_t j = 0; j < 30; ++j) Counter += 1;
+    });
+
+    t1.join();
+    t2.join();
+
+    EXPECT_EQ(Counter.getVal(), 5u);
+
+    {
+        StatScope::Binding binding(&first);
+        EXPECT_EQ(StatScope::Current(), &first);
+        EXPECT_EQ(Counter.getVal(), 100u);
+
+        {
+            StatScope::Binding nested(&second);
+            EXPECT_EQ(Counter.getVal(), 30u);
+        }
+
+        EXPECT_EQ(Counter.getVal(), 100u);
+    }
+
+    EXPECT_TRUE(StatScope::Current() == nullptr);
+}
+
+TEST(StatsTests, RecordsAreExported) {
+    StatScope scope;
+    StatScope::Binding binding(&scope);
+
+    Counter += 42;
+    Ratio = 0.5;
+
+    auto records = CollectStats();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(FindValue(records, "StatsTestsCounter"), "42");
+    EXPECT_EQ(FindValue(records, "StatsTestsRatio"), std::to_string(0.5));
+
+    std::ostringstream json;
+    PrintStatsJson(records, json);
+    EXPECT_EQ(json.str(), "{\"StatsTestsCounter\": 42, \"StatsTestsRatio\": "
+                          + std::to_string(0.5) + "}");
+
+    std::ostringstream csv;
+    PrintStatsCsv(records, csv, "a,b.qasm");
+    EXPECT_EQ(csv.str(), "label,name,value\n"
+                         "\"a,b.qasm\",StatsTestsCounter,42\n"
+                         "\"a,b.qasm\",StatsTestsRatio," + std::to_string(0.5) + "\n");
+}
+
+TEST(StatsTests, RecordsAreRestored) {
+    StatRecords records;
+
+    {
+        StatScope scope;
+        StatScope::Binding binding(&scope);
+
+        Counter += 7;
+        Ratio = 0.25;
+        records = CollectStats();
+    }
+
+    records.push_back(StatRecord { "StatsTestsUnknown", "Not a stat.", "3" });
+
+    StatScope scope;
+    StatScope::Binding binding(&scope);
+
+    Counter += 1;
+    RestoreStats(records);
+
+    EXPECT_EQ(Counter.getVal(), 8u);
+    EXPECT_EQ(Ratio.getVal(), 0.25);
+}
@@ -0,0 +1,40 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/SymbolTable.h"
+
+#include <string>
+#include <vector>
+
+using namespace efd;
+
+TEST(SymbolTableTests, EqualStringsHaveEqualSymbols) {
+    SymbolTable table;
+    std::string text = "cx q0 cx";
+
+    auto first = table.intern(text.data(), text.data() + 2);
+    auto second = table.intern(text.data() + 6, text.data() + 8);
+    auto other = table.intern(text.data() + 3, text.data() + 5);
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(*first, "cx");
+    EXPECT_EQ(*other, "q0");
+    EXPECT_EQ(table.intern(std::string("q0")), other);
+    EXPECT_EQ(table.size(), 2u);
+}
+
+TEST(SymbolTableTests, SymbolsSurviveGrowing) {
+    SymbolTable table;
+    std::vector<SymbolTable::Symbol> symbols;
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        symbols.push_back(table.intern("q" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(table.size(), 1000u);
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(table.intern("q" + std::to_string(i)), symbols[i]);
+        EXPECT_EQ(*symbols[i], "q" + std::to_string(i));
+    }
+}
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace efd;
+
+TEST(ThreadPoolTests, RunsEveryTask) {
+    std::atomic<uint32_t> counter(0);
+    std::vector<uint32_t> results(1000, 0);
+
+    {
+        auto pool = ThreadPool::Create(4);
+        ASSERT_EQ(pool->size(), 4u);
+
+        for (uint32_t i = 0; i < results.size(); ++i) {
+            pool->enqueue([i, &counter, &results] {
+                results[i] = i * 2;
+                ++counter;
+            });
+        }
+
+        pool->wait();
+        EXPECT_EQ(counter.load(), 1000u);
+    }
+
+    for (uint32_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i], i * 2);
+    }
+}
+
+TEST(ThreadPoolTests, CanBeReusedAfterWait) {
+    std::atomic<uint32_t> counter(0);
+    auto pool = ThreadPool::Create(2);
+
+    for (uint32_t round = 1; round <= 3; ++round) {
+        for (uint32_t i = 0; i < 10; ++i) {
+            pool->enqueue([&counter] { ++counter; });
+        }
+
+        pool->wait();
+        EXPECT_EQ(counter.load(), round * 10);
+    }
+}
+
+TEST(ThreadPoolTests, DestructorFinishesPendingTasks) {
+    std::atomic<uint32_t> counter(0);
+
+    {
+        ThreadPool pool(1);
+        for (uint32_t i = 0; i < 50; ++i) {
+            pool.enqueue([&counter] { ++counter; });
+        }
+    }
+
+    EXPECT_EQ(counter.load(), 50u);
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/TimingReport.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/PassCache.h"
+
+#include <sstream>
+
+using namespace efd;
+
+typedef TimingReport::Entry Entry;
+
+static const Entry* FindChild(const std::vector<Entry>& entries,
+                              uint32_t parent, const std::string& name) {
+    for (auto child : entries[parent].mChildren) {
+        if (entries[child].mName == name) return &entries[child];
+    }
+
+    return nullptr;
+}
+
+TEST(TimingReportTests, NothingIsRecordedWhenDisabled) {
+    TimingReport::Enable(false);
+    TimingReport::Clear();
+
+    {
+        TimingScope scope("Region");
+    }
+
+    EXPECT_EQ(TimingReport::GetEntries().size(), 1u);
+}
+
+TEST(TimingReportTests, RegionsAreNestedAndMerged) {
+    TimingReport::Enable();
+    TimingReport::Clear();
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        TimingScope outer("Outer");
+        TimingScope inner("Inner");
+    }
+
+    {
+        TimingScope other("Other");
+    }
+
+    TimingReport::Enable(false);
+
+    auto entries = TimingReport::GetEntries();
+    ASSERT_EQ(entries.size(), 4u);
+    ASSERT_EQ(entries[0].mChildren.size(), 2u);
+
+    auto outer = FindChild(entries, 0, "Outer");
+    ASSERT_TRUE(outer != nullptr);
+    EXPECT_EQ(outer->mCalls, 3u);
+    ASSERT_EQ(outer->mChildren.size(), 1u);
+
+    auto& inner = entries[outer->mChildren[0]];
+    EXPECT_EQ(inner.mName, "Inner");
+    EXPECT_EQ(inner.mCalls, 3u);
+    EXPECT_LE(inner.mNanoseconds, outer->mNanoseconds);
+
+    auto other = FindChild(entries, 0, "Other");
+    ASSERT_TRUE(other != nullptr);
+    EXPECT_EQ(other->mCalls, 1u);
+    EXPECT_TRUE(other->mChildren.empty());
+
+    std::ostringstream json;
+    TimingReport::PrintJson(json);
+    EXPECT_NE(json.str().find("\"name\": \"Inner\", \"calls\": 3"), std::string::npos);
+}
+
+TEST(TimingReportTests, PassesAreRecorded) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+qreg q[2];\
+CX q[0], q[1];\
+";
+
+    auto qmod = QModule::ParseString(program);
+
+    TimingReport::Enable();
+    TimingReport::Clear();
+
+    {
+        TimingScope scope("Compile");
+        PassCache::Run<FlattenPass>(qmod.get());
+    }
+
+    TimingReport::Enable(false);
+
+    auto entries = TimingReport::GetEntries();
+    auto compile = FindChild(entries, 0, "Compile");
+    ASSERT_TRUE(compile != nullptr);
+
+    auto flatten = FindChild(entries, entries[0].mChildren[0], "FlattenPass");
+    ASSERT_TRUE(flatten != nullptr);
+    EXPECT_EQ(flatten->mCalls, 1u);
+}
@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/Trace.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace efd;
+
+TEST(TraceTests, NothingIsRecordedWhenDisabled) {
+    Trace::Enable(false);
+    Trace::Clear();
+
+    {
+        TraceScope scope("Event", "test");
+        scope.arg("arg", 1);
+    }
+
+    EXPECT_TRUE(Trace::GetEvents().empty());
+}
+
+TEST(TraceTests, ScopesAreRecorded) {
+    Trace::Enable();
+    Trace::Clear();
+
+    {
+        TraceScope outer("Outer", "test");
+        outer.arg("value", 42);
+
+        TraceScope inner("Inner", "test");
+        inner.arg("round", 0);
+        inner.restart();
+        inner.arg("round", 1);
+    }
+
+    std::thread([]() { TraceScope other("Other", "test"); }).join();
+
+    Trace::Enable(false);
+
+    auto events = Trace::GetEvents();
+    ASSERT_EQ(events.size(), 4u);
+
+    EXPECT_EQ(events[0].mName, "Inner");
+    EXPECT_EQ(events[1].mName, "Inner");
+    EXPECT_EQ(events[2].mName, "Outer");
+    EXPECT_EQ(events[3].mName, "Other");
+
+    ASSERT_EQ(events[0].mArgs.size(), 1u);
+    EXPECT_EQ(events[0].mArgs[0].second, 0);
+    ASSERT_EQ(events[1].mArgs.size(), 1u);
+    EXPECT_EQ(events[1].mArgs[0].second, 1);
+    EXPECT_LE(events[0].mBegin + events[0].mDuration, events[1].mBegin);
+
+    // The outer event encloses the inner ones.
+    EXPECT_LE(events[2].mBegin, events[0].mBegin);
+    EXPECT_GE(events[2].mBegin + events[2].mDuration,
+              events[1].mBegin + events[1].mDuration);
+
+    EXPECT_EQ(events[0].mThread, events[2].mThread);
+    EXPECT_NE(events[3].mThread, events[2].mThread);
+
+    std::ostringstream out;
+    Trace::Write(out);
+    auto json = out.str();
+
+    EXPECT_EQ(json.find("{\"traceEvents\": ["), 0u);
+    EXPECT_NE(json.find("\"name\": \"Outer\", \"cat\": \"test\", \"ph\": \"X\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"value\": 42}"), std::string::npos);
+}
@@ -85,3 +85,47 @@ cx q[0], q[1];\
 
     ASSERT_EQ(qmod->toString(), inlined);
 }
+
+TEST(GateInlineTests, RepeatedInline) {
+    const std::string program =
+"\
+include \"qelib1.inc\";\
+gate my_gate a, b {\
+h a;\
+cx a, b;\
+}\
+qreg q[3];\
+creg c[3];\
+my_gate q[0], q[1];\
+U(pi) q[2];\
+if (c == 1) my_gate q[1], q[2];\
+my_gate q[2], q[0];\
+";
+
+    const std::string inlined =
+"\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+h q[0];\
+cx q[0], q[1];\
+U(pi) q[2];\
+if (c == 1) h q[1];\
+if (c == 1) cx q[1], q[2];\
+h q[2];\
+cx q[2], q[0];\
+";
+
+    std::unique_ptr<QModule> qmod = QModule::ParseString(program);
+    std::vector<NDQOp::Ref> qops;
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        NDQOp::Ref qop = dynCast<NDQOp>(it->get());
+        if (auto ifstmt = dynCast<NDIfStmt>(it->get())) qop = ifstmt->getQOp();
+        if (qop != nullptr && qop->isGeneric()) qops.push_back(qop);
+    }
+
+    // Every call moves the statements after it.
+    for (auto qop : qops) InlineGate(qmod.get(), qop);
+    ASSERT_EQ(qmod->toString(), inlined);
+}
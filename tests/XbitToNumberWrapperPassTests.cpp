@@ -33,7 +33,7 @@ qreg q[5];\
         ASSERT_TRUE(data.getQUId("q[3]") == 3);
         ASSERT_TRUE(data.getQUId("q[4]") == 4);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -63,7 +63,7 @@ gate mygate(a, b, c) x, y, z {\
         ASSERT_TRUE(data.getQUId("y", gate) == 1);
         ASSERT_TRUE(data.getQUId("z", gate) == 2);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -123,6 +123,6 @@ measure q[4] -> c[4];\
         ASSERT_TRUE(data.getQUId("q[3]") == 3);
         ASSERT_TRUE(data.getQUId("q[4]") == 4);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
@@ -1,6 +1,8 @@
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Transform/QModule.h"
 #include "enfield/Transform/Driver.h"
+#include "enfield/Transform/CompileServer.h"
+#include "enfield/Transform/CompilationCache.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/QModuleQualityEvalPass.h"
 #include "enfield/Transform/InlineAllPass.h"
@@ -9,14 +11,25 @@
 #include "enfield/Transform/Utils.h"
 #include "enfield/Arch/Architectures.h"
 #include "enfield/Support/JsonParser.h"
+#include "enfield/Support/BFSCachedDistance.h"
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/Timer.h"
+#include "enfield/Support/TimingReport.h"
+#include "enfield/Support/Trace.h"
 
 #include <fstream>
 #include <cassert>
 #include <cctype>
 #include <sstream>
 #include <map>
+#include <limits>
+#include <mutex>
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
 
 using namespace efd;
 
@@ -58,7 +71,7 @@ Should be specified as <gate>:<w> between quotes.",
 {{"U", 1}, {"CX", 10}}, false);
 
 static Opt<std::string> InFilepath
-("i", "The input file.", "", true);
+("i", "The input file.", "", false);
 static Opt<std::string> OutFilepath
 ("o", "The output file.", "", false);
 static Opt<std::string> ArchFilepath
@@ -68,6 +81,8 @@ static Opt<bool> NoPretty
 ("-no-pretty", "Print in a pretty format (negation).", false, false);
 static Opt<bool> ShowStats
 ("stats", "Print statistical data collected.", false, false);
+static Opt<std::string> StatsFormat
+("-stats-format", "Format of the statistical data: text, json or csv.", "text", false);
 static Opt<bool> Reorder
 ("ord", "Order the program input.", false, false);
 static Opt<bool> NoVerify
@@ -83,6 +98,61 @@ static efd::Opt<EnumArchitecture> Arch
 ("arch", "Name of the architechture, or a file with the connectivity graph.",
 Architecture::A_ibmqx2, false);
 
+static Opt<uint32_t> Seed
+("seed", "Seed to be used in random algorithms.", AllocatorOptions().seed, false);
+static Opt<uint32_t> Trials
+("trials", "Number of times that IBMQAllocator should try.", 20, false);
+static Opt<uint32_t> BMTMaxChildren
+("-bmt-max-children", "Limits the max number of children per partial solution.",
+ std::numeric_limits<uint32_t>::max(), false);
+static Opt<uint32_t> BMTMaxPartial
+("-bmt-max-partial", "Limits the max number of partial solutions per step.",
+ std::numeric_limits<uint32_t>::max(), false);
+static Opt<uint32_t> BMTMaxMapSeq
+("-bmt-max-mapseq", "Select the best N mapping sequences from phase 2.", 1, false);
+static Opt<uint32_t> SabreLookAhead
+("-sabre-lookahead", "Sets the number of instructions to peek.", 20, false);
+static Opt<uint32_t> SabreIterations
+("-sabre-iterations", "Sets the number of times to run SABRE.", 5, false);
+
+static Opt<std::vector<std::string>> Portfolio
+("-portfolio", "Adds an allocator to the ones raced by Q_portfolio.", {}, false);
+static Opt<double> PortfolioThreshold
+("-portfolio-threshold", "Stops the portfolio once a result costs at most this \
+many times the lower bound.", 1.0, false);
+static Opt<uint32_t> PortfolioDeadline
+("-portfolio-deadline", "Stops the portfolio after this many milliseconds \
+(0 for no deadline).", 0, false);
+
+static Opt<std::string> BatchInput
+("-batch", "A directory, or a manifest file with one path per line, of the files \
+to be compiled.", "", false);
+static Opt<std::string> BatchOutDir
+("-batch-out", "The directory where the compiled files are written in batch mode.",
+ "", false);
+static Opt<uint32_t> Jobs
+("j", "Number of files (or server connections) handled concurrently (0 uses \
+every hardware thread).", 0, false);
+
+static Opt<bool> Server
+("-server", "Serves compilation requests from the standard input (or a socket).",
+ false, false);
+static Opt<std::string> ServerSocket
+("-socket", "The Unix domain socket the server listens on.", "", false);
+
+static Opt<std::string> CacheDir
+("-cache-dir", "Caches the compilation results in this directory.", "", false);
+static Opt<uint32_t> CacheSize
+("-cache-size", "Max size of the cache directory, in megabytes.", 512, false);
+
+static Opt<bool> TimePasses
+("-time-passes", "Print the time spent by each pass and allocator phase.", false, false);
+static Opt<std::string> TimePassesJson
+("-time-passes-json", "Write the timing report, as JSON, to this file.", "", false);
+
+static Opt<std::string> TraceFile
+("-trace", "Write the trace events (Chrome trace format) to this file.", "", false);
+
 static Opt<std::string> PrintDepGraphFile
 ("-print-depgraph", "Choose a file to print the dependency graph.", "", false);
 static Opt<std::string> PrintArchGraphFile
@@ -95,42 +165,365 @@ static efd::Stat<uint32_t> Gates
 static efd::Stat<uint32_t> WeightedCost
 ("WeightedCost", "Total weighted cost after allocating the qubits.");
 
-static void DumpToOutFile(QModule::Ref qmod) {
+static CompilationCache::uRef Cache;
+
+static void DumpToOutFile(const std::string& output) {
     std::ofstream cmdOut(OutFilepath.getVal());
     std::ostream& out = (OutFilepath.getVal() != "") ? cmdOut : std::cout;
-    PrintToStream(qmod, out, !NoPretty.getVal());
+    out << output;
     cmdOut.close();
 }
 
-static void ComputeStats(QModule::Ref qmod, ArchGraph::sRef archGraph) {
-    auto inlinePass = InlineAllPass::Create(ExtractGateNames(GateWeights.getVal()));
-    auto reversePass = ReverseEdgesPass::Create(archGraph);
-    auto qualityPass = QModuleQualityEvalPass::Create(GateWeights.getVal());
-    PassCache::Run(qmod, inlinePass.get());
-    PassCache::Run(qmod, reversePass.get());
-    PassCache::Run(qmod, inlinePass.get());
-    PassCache::Run(qmod, qualityPass.get());
-    auto &quality = qualityPass->getData();
-
-    Depth = quality.mDepth;
-    Gates = quality.mGates;
-    WeightedCost = quality.mWeightedCost;
+static CompilationSettings CreateSettings(ArchGraph::sRef archGraph) {
+    CompilationSettings settings {
+        archGraph,
+        Alloc.getVal(),
+        GateWeights.getVal(),
+        Reorder.getVal(),
+        !NoVerify.getVal(),
+        Force.getVal()
+    };
+
+    settings.allocatorOptions.seed = Seed.getVal();
+    settings.allocatorOptions.trials = Trials.getVal();
+    settings.allocatorOptions.bmtMaxChildren = BMTMaxChildren.getVal();
+    settings.allocatorOptions.bmtMaxPartial = BMTMaxPartial.getVal();
+    settings.allocatorOptions.bmtMaxMapSeq = BMTMaxMapSeq.getVal();
+    settings.allocatorOptions.sabreLookAhead = SabreLookAhead.getVal();
+    settings.allocatorOptions.sabreIterations = SabreIterations.getVal();
+    settings.allocatorOptions.portfolioThreshold = PortfolioThreshold.getVal();
+    settings.allocatorOptions.portfolioDeadline = PortfolioDeadline.getVal();
+
+    if (Portfolio.isParsed()) {
+        settings.allocatorOptions.portfolio = Portfolio.getVal();
+    }
+
+    return settings;
 }
 
-int main(int argc, char** argv) {
-    Init(argc, argv);
+/// \brief Compiles \p qmod, and fills \p output with the printed result and
+/// \p quality with its metrics.
+///
+/// The result is taken from (and stored in) the cache, if enabled.
+/// Returns false if the compilation failed.
+static bool CompileToString(QModule::uRef qmod,
+                            const CompilationSettings& settings,
+                            std::string& output,
+                            QModuleQuality& quality) {
+    std::string key;
+
+    if (Cache.get() != nullptr) {
+        TimingScope scope("CacheLookup");
+
+        std::string format = std::to_string(NoPretty.getVal()) +
+                             std::to_string(InlineOutput.getVal());
+        key = CompilationCache::ComputeKey(qmod.get(), settings, format);
+
+        CompilationCache::Entry entry;
+        if (Cache->lookup(key, entry)) {
+            output = entry.output;
+            quality = entry.quality;
+            RestoreStats(entry.stats);
+            return true;
+        }
+    }
+
+    // Collects the stats of this compilation only, so that they can be cached.
+    StatScope scope;
+    StatRecords stats;
+
+    {
+        StatScope::Binding binding(&scope);
+
+        qmod = Compile(std::move(qmod), settings);
+        if (qmod.get() == nullptr) {
+            scope.mergeIntoCurrent();
+            return false;
+        }
+
+        std::ostringstream out;
+
+        if (!InlineOutput.getVal()) {
+            PrintToStream(qmod.get(), out, !NoPretty.getVal());
+        }
+
+        quality = EvaluateQuality(qmod.get(), settings.archGraph, settings.gWeightMap);
+
+        if (InlineOutput.getVal()) {
+            PrintToStream(qmod.get(), out, !NoPretty.getVal());
+        }
+
+        output = out.str();
+        if (Cache.get() != nullptr) stats = CollectStats();
+    }
+
+    scope.mergeIntoCurrent();
+
+    if (Cache.get() != nullptr) {
+        Cache->store(key, CompilationCache::Entry { output, quality, stats });
+    }
+
+    return true;
+}
+
+static bool IsDirectory(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static std::string GetFilename(const std::string& path) {
+    auto lastslash = path.find_last_of('/');
+    return (lastslash == std::string::npos) ? path : path.substr(lastslash + 1);
+}
+
+/// \brief Lists the \em .qasm files inside the directory \p path, or the
+/// paths listed (one per line) in the manifest file \p path.
+static std::vector<std::string> ListBatchFiles(const std::string& path) {
+    std::vector<std::string> files;
+
+    if (IsDirectory(path)) {
+        std::string dirpath = path;
+        if (dirpath.back() != '/') dirpath += '/';
+
+        if (auto dir = opendir(dirpath.c_str())) {
+            while (auto entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.size() > 5 && name.compare(name.size() - 5, 5, ".qasm") == 0) {
+                    files.push_back(dirpath + name);
+                }
+            }
+
+            closedir(dir);
+        }
+
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream manifest(path);
+        EfdAbortIf(!manifest.is_open(), "Could not open the batch manifest: `" << path << "`.");
+
+        for (std::string line; std::getline(manifest, line);) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') continue;
+            auto last = line.find_last_not_of(" \t\r");
+            files.push_back(line.substr(first, last - first + 1));
+        }
+    }
+
+    return files;
+}
+
+/// \brief Prints the stats \p records in the format chosen by \p StatsFormat.
+///
+/// In the json and csv formats, \p label identifies the records (e.g.: the
+/// input file), and \p first tells whether this is the first of a sequence.
+static void PrintStatRecords(const StatRecords& records,
+                             const std::string& label, bool first) {
+    auto& format = StatsFormat.getVal();
+
+    if (format == "json") {
+        std::cout << "{\"label\": \"" << label << "\", \"stats\": ";
+        PrintStatsJson(records, std::cout);
+        std::cout << "}" << std::endl;
+    } else if (format == "csv") {
+        PrintStatsCsv(records, std::cout, label, first);
+    } else {
+        if (format != "text") WAR << "Unknown stats format: `" << format << "`." << std::endl;
+
+        std::cout << label << std::endl;
+        for (auto& record : records) {
+            std::cout << record.mValue << "::" << record.mName << "::"
+                      << record.mDescription << std::endl;
+        }
+    }
+}
+
+/// \brief Result of compiling one of the files of the batch.
+struct BatchResult {
+    std::string input;
+    std::string output;
+    bool success;
+    QModuleQuality quality;
+    uint64_t milliseconds;
+    StatRecords stats;
+};
+
+static BatchResult CompileBatchFile(const std::string& input,
+                                    const CompilationSettings& settings) {
+    BatchResult result { input, "", false, { 0, 0, 0 }, 0, {} };
+
+    // Concurrent compilations must not share their stats.
+    StatScope scope;
+    StatScope::Binding binding(&scope);
+
+    std::string outdir = BatchOutDir.getVal();
+    if (outdir == "") {
+        result.output = input + ".out";
+    } else {
+        if (outdir.back() != '/') outdir += '/';
+        result.output = outdir + GetFilename(input);
+    }
+
+    Timer timer;
+    timer.start();
+
+    auto qmod = ParseFile(input);
+    std::string output;
+
+    if (qmod.get() != nullptr &&
+        CompileToString(std::move(qmod), settings, output, result.quality)) {
+        std::ofstream out(result.output);
+        out << output;
+        result.success = true;
+
+        Depth = result.quality.mDepth;
+        Gates = result.quality.mGates;
+        WeightedCost = result.quality.mWeightedCost;
+    }
+
+    timer.stop();
+    result.milliseconds = timer.getMilliseconds();
+
+    if (ShowStats.getVal()) result.stats = CollectStats();
+    return result;
+}
+
+/// \brief Compiles every file listed by \p BatchInput, sharing the
+/// architecture \p archGraph and a pool of worker threads.
+///
+/// Returns the number of files that failed to compile.
+static uint32_t RunBatch(ArchGraph::sRef archGraph) {
+    auto files = ListBatchFiles(BatchInput.getVal());
+    auto settings = CreateSettings(archGraph);
+
+    std::vector<BatchResult> results(files.size());
+
+    // The allocators of every file share the distances of the architecture.
+    // Computing them before the workers start keeps them from waiting on
+    // each other for it.
+    BFSCachedDistance::GetDistanceMatrix(archGraph.get());
+
+    Timer timer;
+    timer.start();
+
+    {
+        ThreadPool pool(Jobs.getVal());
+        for (uint32_t i = 0, e = files.size(); i < e; ++i) {
+            pool.enqueue([i, &files, &results, &settings] {
+                results[i] = CompileBatchFile(files[i], settings);
+            });
+        }
+        pool.wait();
+    }
+
+    timer.stop();
+
+    uint32_t failed = 0;
+    uint64_t totalDepth = 0, totalGates = 0, totalCost = 0;
+    bool first = true;
+
+    for (auto& result : results) {
+        if (!result.success) {
+            ERR << "Failed to compile: `" << result.input << "`." << std::endl;
+            ++failed;
+            continue;
+        }
+
+        totalDepth += result.quality.mDepth;
+        totalGates += result.quality.mGates;
+        totalCost += result.quality.mWeightedCost;
+
+        if (ShowStats.getVal() && StatsFormat.getVal() == "text") {
+            std::cout << result.input << "::" << result.quality.mDepth << "::"
+                      << result.quality.mGates << "::" << result.quality.mWeightedCost << "::"
+                      << result.milliseconds << "ms" << std::endl;
+        } else if (ShowStats.getVal()) {
+            PrintStatRecords(result.stats, result.input, first);
+            first = false;
+        }
+    }
+
+    std::cout << "Compiled " << files.size() - failed << " of " << files.size()
+              << " files (Depth: " << totalDepth
+              << ", Gates: " << totalGates
+              << ", WeightedCost: " << totalCost
+              << ", Time: " << timer.getMilliseconds() << "ms)." << std::endl;
+
+    return failed;
+}
+
+static ArchGraph::sRef LoadArchitecture() {
+    ArchGraph::sRef archGraph;
+
+    if (!ArchFilepath.isParsed() && HasArchitecture(Arch.getVal())) {
+        archGraph = CreateArchitecture(Arch.getVal());
+    } else if (ArchFilepath.isParsed()) {
+        archGraph = JsonParser<ArchGraph>::ParseFile(ArchFilepath.getVal());
+    } else {
+        ERR << "Architecture: " << Arch.getVal().getStringValue()
+            << " not found." << std::endl;
+    }
+
+    return archGraph;
+}
+
+/// \brief Prints the \em TimingReport and the \em Trace, if requested.
+static void EmitTimingReport() {
+    if (TimePasses.getVal()) {
+        TimingReport::Print(std::cerr);
+    }
+
+    if (TimePassesJson.isParsed()) {
+        std::ofstream out(TimePassesJson.getVal());
+        TimingReport::PrintJson(out);
+    }
+
+    if (TraceFile.isParsed()) {
+        std::ofstream out(TraceFile.getVal());
+        Trace::Write(out);
+    }
+}
+
+/// \brief Runs the tool (except for the reports).
+static int Run() {
+    if (CacheDir.isParsed()) {
+        Cache = CompilationCache::Create(CacheDir.getVal(),
+                                         (uint64_t) CacheSize.getVal() << 20);
+
+        if (!Seed.isParsed()) {
+            WAR << "The seed is part of the cache key, and it changes on every run. "
+                << "Set `-seed` in order to reuse the cached results." << std::endl;
+        }
+    }
+
+    if (Server.getVal()) {
+        auto server = CompileServer::Create(CreateSettings(LoadArchitecture()));
+        server->setCache(Cache.get());
+
+        if (ServerSocket.isParsed()) {
+            return server->serveUnixSocket(ServerSocket.getVal(), Jobs.getVal()) ? 0 : 1;
+        }
+
+        server->serveStdio();
+        return 0;
+    }
+
+    if (BatchInput.isParsed()) {
+        auto archGraph = LoadArchitecture();
+        if (archGraph.get() == nullptr) return 1;
+        return (RunBatch(archGraph) == 0) ? 0 : 1;
+    }
+
+    if (!InFilepath.isParsed()) {
+        ERR << "No input file given (use either `-i` or `--batch`)." << std::endl;
+        return 1;
+    }
+
     QModule::uRef qmod = ParseFile(InFilepath.getVal());
+    bool success = false;
 
     if (qmod.get() != nullptr) {
-        ArchGraph::sRef archGraph;
-        if (!ArchFilepath.isParsed() && HasArchitecture(Arch.getVal())) {
-            archGraph = CreateArchitecture(Arch.getVal());
-        } else if (ArchFilepath.isParsed()) {
-            archGraph = JsonParser<ArchGraph>::ParseFile(ArchFilepath.getVal());
-        } else {
-            ERR << "Architecture: " << Arch.getVal().getStringValue()
-                << " not found." << std::endl;
-        }
+        ArchGraph::sRef archGraph = LoadArchitecture();
+        if (archGraph.get() == nullptr) return 1;
 
         if (PrintArchGraphFile.isParsed()) {
             std::ofstream ofs(PrintArchGraphFile.getVal());
@@ -144,33 +537,43 @@ int main(int argc, char** argv) {
             ofs.close();
         }
 
-        CompilationSettings settings {
-            archGraph,
-            Alloc.getVal(),
-            GateWeights.getVal(),
-            Reorder.getVal(),
-            !NoVerify.getVal(),
-            Force.getVal()
-        };
+        std::string output;
+        QModuleQuality quality;
 
-        qmod.reset(Compile(std::move(qmod), settings).release());
+        success = CompileToString(std::move(qmod), CreateSettings(archGraph), output, quality);
 
-        if (qmod.get() != nullptr) {
-            if (!InlineOutput.getVal()) {
-                DumpToOutFile(qmod.get());
-            }
+        if (success) {
+            DumpToOutFile(output);
 
-            ComputeStats(qmod.get(), archGraph);
+            Depth = quality.mDepth;
+            Gates = quality.mGates;
+            WeightedCost = quality.mWeightedCost;
+        }
+    }
 
-            if (InlineOutput.getVal()) {
-                DumpToOutFile(qmod.get());
-            }
+    if (ShowStats.getVal()) {
+        if (StatsFormat.getVal() == "text") efd::PrintStats();
+        else PrintStatRecords(CollectStats(), InFilepath.getVal(), true);
+    }
 
-        }
+    return success ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    Init(argc, argv);
+
+    if (TimePasses.getVal() || TimePassesJson.isParsed()) {
+        TimingReport::Enable();
     }
 
-    if (ShowStats.getVal())
-        efd::PrintStats();
+    if (TraceFile.isParsed()) {
+#ifndef EFD_ENABLE_TRACE
+        WAR << "Built without `ENABLE_TRACE`: no events will be recorded." << std::endl;
+#endif
+        Trace::Enable();
+    }
 
-    return 0;
+    int status = Run();
+    EmitTimingReport();
+    return status;
 }